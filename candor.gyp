@@ -20,6 +20,9 @@
       'src/zone.cc',
       'src/api.cc',
       'src/code-space.cc',
+      'src/compile-queue.cc',
+      'src/compile-stats.cc',
+      'src/code-cache.cc',
       'src/cpu.cc',
       'src/gc.cc',
       'src/heap.cc',
@@ -29,6 +32,7 @@
       'src/root.cc',
       'src/visitor.cc',
       'src/source-map.cc',
+      'src/string-ops.cc',
       'src/fullgen.cc',
       'src/fullgen-instructions.cc',
       'src/hir.cc',
@@ -36,6 +36,7 @@ namespace internal {
   class List;
   class EmptyClass;
   class HValueReference;
+  class CompileTask;
 }  // namespace internal
 
 class Value;
@@ -47,6 +48,8 @@ class String;
 class Object;
 class Array;
 class CData;
+class StringBuilder;
+class CompileJob;
 struct Error;
 
 class Isolate {
@@ -69,6 +72,25 @@ class Isolate {
   static void EnableLIRLogging();
   static void DisableLIRLogging();
 
+  // Time spent in every compiler phase (in seconds, e.g. `parse`, `prune_phis`,
+  // `register_allocation`) and counters of compiled code (e.g. `hir_blocks`,
+  // `spills`, `code_bytes`), accumulated while stats are enabled
+  static void EnableCompileStats();
+  static void DisableCompileStats();
+  static void ResetCompileStats();
+  static void PrintCompileStats();
+  Object* GetCompileStats();
+
+  // Save baseline code of compiled sources into the `dir` and reuse it when
+  // the same source is compiled again (by this or any other process)
+  static void EnableCodeCache(const char* dir);
+  static void DisableCodeCache();
+
+  // Number of compiled chunks and code pages, size of the mapped pages and
+  // of the code in them (`chunks`, `pages`, `size`, `used`). Code of
+  // unreachable functions is freed by the old space GC.
+  Object* GetCodeSpaceStats();
+
  protected:
   void SetError(Error* err);
 
@@ -86,6 +108,8 @@ class Isolate {
   friend class Object;
   friend class Array;
   friend class CData;
+  friend class StringBuilder;
+  friend class CompileJob;
 
   template <class T>
   friend class Handle;
@@ -157,6 +181,13 @@ class Function : public Value {
   static Function* New(const char* source);
   static Function* New(BindingCallback callback);
 
+  // Parses source on the compiler thread pool and returns immediately,
+  // function is created by CompileJob::Finish()
+  static CompileJob* NewAsync(const char* filename,
+                              const char* source,
+                              uint32_t length);
+  static CompileJob* NewAsync(const char* filename, const char* source);
+
   Object* GetContext();
   void SetContext(Object* context);
 
@@ -167,6 +198,30 @@ class Function : public Value {
   static const ValueType tag = kFunction;
 };
 
+// Source that is being parsed on the compiler thread (see Function::NewAsync)
+class CompileJob {
+ public:
+  // Returns true if Finish() won't wait for the compiler thread
+  bool IsDone();
+
+  // Generates code on the isolate's thread and returns function, or NULL on
+  // error (see Isolate::GetError()). Job is deleted afterwards.
+  Function* Finish();
+
+ protected:
+  CompileJob(internal::CompileTask* task, internal::CodeSpace* space)
+      : task(task),
+        space(space) {
+  }
+
+  internal::CompileTask* task;
+
+  // Space of the isolate that has started the job
+  internal::CodeSpace* space;
+
+  friend class Function;
+};
+
 class Nil : public Value {
  public:
   static Nil* New();
@@ -207,6 +262,12 @@ class String : public Value {
   const char* Value();
   uint32_t Length();
 
+  // Zero-copy substring [start, end)
+  String* Slice(uint32_t start, uint32_t end);
+
+  // Offset of the first occurence of needle or -1
+  int64_t IndexOf(String* needle);
+
   static const ValueType tag = kString;
 };
 
@@ -282,6 +343,34 @@ class Handle {
   internal::HValueReference* ref;
 };
 
+class StringBuilder {
+ public:
+  explicit StringBuilder(uint32_t capacity = kDefaultCapacity);
+  ~StringBuilder();
+
+  void Append(const char* value, uint32_t length);
+  void Append(const char* value);
+  void Append(Value* value);
+
+  uint32_t Length();
+
+  // Hands buffer to the resulting string (without copying) and resets builder
+  String* ToString();
+
+  // Script binding: returns object with `append`, `length` and `toString`
+  // methods, i.e. `b = stringBuilder()\nb:append("x")\nb:toString()`
+  static Value* Binding(uint32_t argc, Value* argv[]);
+
+  static const uint32_t kDefaultCapacity = 64;
+
+ protected:
+  void Grow(uint32_t length);
+
+  Handle<String> buffer;
+  uint32_t length;
+  uint32_t capacity;
+};
+
 class CWrapper {
  public:
   explicit CWrapper(const int* magic);
@@ -29,6 +29,9 @@
 #include "heap.h"
 #include "heap-inl.h"
 #include "code-space.h"
+#include "code-cache.h"
+#include "compile-queue.h"
+#include "compile-stats.h"
 #include "fullgen.h"
 #include "fullgen-inl.h"
 #include "hir.h"
@@ -36,6 +39,7 @@
 #include "lir.h"
 #include "lir-inl.h"
 #include "runtime.h"
+#include "string-ops.h"
 #include "utils.h"
 
 namespace candor {
@@ -132,6 +136,67 @@ Array* Isolate::StackTrace() {
 }
 
 
+void Isolate::EnableCompileStats() {
+  CompileStats::Enable();
+}
+
+
+void Isolate::DisableCompileStats() {
+  CompileStats::Disable();
+}
+
+
+void Isolate::ResetCompileStats() {
+  CompileStats::Reset();
+}
+
+
+void Isolate::PrintCompileStats() {
+  CompileStats::Print(stderr);
+}
+
+
+Object* Isolate::GetCompileStats() {
+  Object* result = Object::New();
+
+  for (int i = 0; i < CompileStats::kPhaseCount; i++) {
+    CompileStats::Phase phase = static_cast<CompileStats::Phase>(i);
+    result->Set(CompileStats::PhaseName(phase),
+                Number::NewDouble(CompileStats::PhaseTime(phase)));
+  }
+
+  for (int i = 0; i < CompileStats::kCounterCount; i++) {
+    CompileStats::Counter counter = static_cast<CompileStats::Counter>(i);
+    result->Set(CompileStats::CounterName(counter),
+                Number::NewIntegral(CompileStats::CounterValue(counter)));
+  }
+
+  return result;
+}
+
+
+void Isolate::EnableCodeCache(const char* dir) {
+  CodeCache::Enable(dir);
+}
+
+
+void Isolate::DisableCodeCache() {
+  CodeCache::Disable();
+}
+
+
+Object* Isolate::GetCodeSpaceStats() {
+  Object* result = Object::New();
+
+  result->Set("chunks", Number::NewIntegral(space->chunk_count()));
+  result->Set("pages", Number::NewIntegral(space->page_count()));
+  result->Set("size", Number::NewIntegral(space->size()));
+  result->Set("used", Number::NewIntegral(space->used()));
+
+  return result;
+}
+
+
 void Isolate::EnableFullgenLogging() {
   Fullgen::EnableLogging();
 }
@@ -357,6 +422,47 @@ Function* Function::New(const char* source) {
 }
 
 
+CompileJob* Function::NewAsync(const char* filename,
+                               const char* source,
+                               uint32_t length) {
+  CompileTask* task = ISOLATE->space->CompileAsync(filename,
+                                                    source,
+                                                    length);
+
+  return new CompileJob(task, task->space());
+}
+
+
+CompileJob* Function::NewAsync(const char* filename, const char* source) {
+  return NewAsync(filename, source, strlen(source));
+}
+
+
+bool CompileJob::IsDone() {
+  return space->compile_queue()->IsDone(task);
+}
+
+
+Function* CompileJob::Finish() {
+  char* root;
+  Error* error;
+  CodeSpace* space = this->space;
+  char* code = space->FinishCompile(task, &root, &error);
+  delete this;
+
+  // Set errors
+  if (code == NULL) {
+    ISOLATE->SetError(error);
+    return NULL;
+  } else {
+    ISOLATE->SetError(NULL);
+  }
+
+  return Value::Cast<Function>(
+      HFunction::New(space->heap(), NULL, code, root));
+}
+
+
 Function* Function::New(BindingCallback callback) {
   char* obj = HFunction::NewBinding(ISOLATE->heap,
                                     *reinterpret_cast<char**>(&callback),
@@ -466,6 +572,165 @@ uint32_t String::Length() {
 }
 
 
+String* String::Slice(uint32_t start, uint32_t end) {
+  uint32_t length = Length();
+  if (end > length) end = length;
+  if (start > end) start = end;
+
+  return Cast<String>(HString::NewSlice(
+        ISOLATE->heap, Heap::kTenureNew, addr(), start, end - start));
+}
+
+
+int64_t String::IndexOf(String* needle) {
+  return StringOps::IndexOf(Value(),
+                            Length(),
+                            needle->Value(),
+                            needle->Length());
+}
+
+
+StringBuilder::StringBuilder(uint32_t capacity) : length(0),
+                                                  capacity(capacity) {
+  if (this->capacity == 0) this->capacity = kDefaultCapacity;
+}
+
+
+StringBuilder::~StringBuilder() {
+}
+
+
+void StringBuilder::Grow(uint32_t length) {
+  // Amortize appends by doubling capacity
+  uint32_t size = capacity;
+  while (size < length) size <<= 1;
+
+  char* str = HString::New(ISOLATE->heap, Heap::kTenureNew, size);
+  if (!buffer.IsEmpty()) {
+    memcpy(HString::Value(ISOLATE->heap, str),
+           HString::Value(ISOLATE->heap, buffer->addr()),
+           this->length);
+  }
+
+  buffer.Wrap(Value::New(str));
+  capacity = size;
+}
+
+
+void StringBuilder::Append(const char* value, uint32_t length) {
+  if (buffer.IsEmpty() || this->length + length > capacity) {
+    Grow(this->length + length);
+  }
+
+  memcpy(HString::Value(ISOLATE->heap, buffer->addr()) + this->length,
+         value,
+         length);
+  this->length += length;
+}
+
+
+void StringBuilder::Append(const char* value) {
+  Append(value, strlen(value));
+}
+
+
+void StringBuilder::Append(Value* value) {
+  String* str = value->ToString();
+  Append(str->Value(), str->Length());
+}
+
+
+uint32_t StringBuilder::Length() {
+  return length;
+}
+
+
+String* StringBuilder::ToString() {
+  if (buffer.IsEmpty()) return String::New("", 0);
+
+  // Buffer's tail will be reclaimed by GC
+  HString::Truncate(buffer->addr(), length);
+  String* result = *buffer;
+
+  buffer.Unwrap();
+  length = 0;
+
+  return result;
+}
+
+
+static StringBuilder* UnwrapStringBuilder(Value* self) {
+  if (!self->Is<Object>()) return NULL;
+
+  Value* data = self->As<Object>()->Get("__$builder");
+  if (!data->Is<CData>()) return NULL;
+
+  return *reinterpret_cast<StringBuilder**>(
+      data->As<CData>()->GetContents());
+}
+
+
+static void StringBuilderWeakCallback(Value* data) {
+  delete *reinterpret_cast<StringBuilder**>(
+      data->As<CData>()->GetContents());
+}
+
+
+static Value* StringBuilderAppend(uint32_t argc, Value* argv[]) {
+  if (argc < 1) return Nil::New();
+
+  StringBuilder* b = UnwrapStringBuilder(argv[0]);
+  if (b == NULL) return Nil::New();
+
+  for (uint32_t i = 1; i < argc; i++) {
+    b->Append(argv[i]);
+  }
+
+  return argv[0];
+}
+
+
+static Value* StringBuilderLength(uint32_t argc, Value* argv[]) {
+  if (argc < 1) return Nil::New();
+
+  StringBuilder* b = UnwrapStringBuilder(argv[0]);
+  if (b == NULL) return Nil::New();
+
+  return Number::NewIntegral(b->Length());
+}
+
+
+static Value* StringBuilderToString(uint32_t argc, Value* argv[]) {
+  if (argc < 1) return Nil::New();
+
+  StringBuilder* b = UnwrapStringBuilder(argv[0]);
+  if (b == NULL) return Nil::New();
+
+  return b->ToString();
+}
+
+
+Value* StringBuilder::Binding(uint32_t argc, Value* argv[]) {
+  uint32_t capacity = kDefaultCapacity;
+  if (argc >= 1 && argv[0]->Is<Number>()) {
+    capacity = argv[0]->As<Number>()->IntegralValue();
+  }
+
+  CData* data = CData::New(sizeof(StringBuilder*));
+  *reinterpret_cast<StringBuilder**>(data->GetContents()) =
+      new StringBuilder(capacity);
+  data->SetWeakCallback(StringBuilderWeakCallback);
+
+  Object* obj = Object::New();
+  obj->Set("__$builder", data);
+  obj->Set("append", Function::New(StringBuilderAppend));
+  obj->Set("length", Function::New(StringBuilderLength));
+  obj->Set("toString", Function::New(StringBuilderToString));
+
+  return obj;
+}
+
+
 Object* Object::New() {
   return Cast<Object>(HObject::NewEmpty(ISOLATE->heap));
 }
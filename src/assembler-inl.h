@@ -27,6 +27,14 @@ namespace candor {
 namespace internal {
 
 inline void Label::AddUse(Assembler* a, RelocationInfo* use) {
+  // Code outside of the buffer - just put its address in place
+  if (addr_ != NULL) {
+    assert(use->type_ == RelocationInfo::kAbsolute);
+    assert(use->size_ == RelocationInfo::kPointer);
+    *reinterpret_cast<char**>(a->buffer() + use->offset_) = addr_;
+    return;
+  }
+
   // If we already know target position - set it
   if (pos_ != 0) use->target(pos_);
   uses_.Push(use);
@@ -36,7 +44,7 @@ inline void Label::AddUse(Assembler* a, RelocationInfo* use) {
 
 inline void Label::relocate(uint32_t offset) {
   // Label should be relocated only once
-  assert(pos_ == 0);
+  assert(pos_ == 0 && addr_ == NULL);
   pos_ = offset;
 
   // Iterate through all label's uses and insert correct relocation info
@@ -38,16 +38,24 @@ namespace internal {
 
 class Label : public ZoneObject {
  public:
-  Label() : pos_(0) {
+  Label() : pos_(0), addr_(NULL) {
+  }
+
+  // Label bound to the code that was already placed in the code space
+  explicit Label(char* addr) : pos_(0), addr_(addr) {
   }
 
   inline void AddUse(Assembler* a, RelocationInfo* use);
 
+  inline uint32_t pos() { return pos_; }
+  inline char* addr() { return addr_; }
+
  private:
   inline void relocate(uint32_t offset);
   inline void use(Assembler* a, uint32_t offset);
 
   uint32_t pos_;
+  char* addr_;
   ZoneList<RelocationInfo*> uses_;
 
   friend class Assembler;
@@ -132,6 +132,8 @@ candor::Object* CreateGlobal() {
   obj->Set("assert", candor::Function::New(APIAssert));
   obj->Set("print", candor::Function::New(APIPrint));
   obj->Set("getValue", candor::Function::New(APIToString));
+  obj->Set("stringBuilder",
+           candor::Function::New(candor::StringBuilder::Binding));
 
   return obj;
 }
@@ -223,6 +225,23 @@ void StartRepl() {
 
 
 int main(int argc, char** argv) {
+  bool compile_stats = false;
+  while (argc >= 2 && strncmp(argv[1], "--", 2) == 0) {
+    if (strcmp(argv[1], "--compile-stats") == 0) {
+      // Print time spent in the compiler and sizes of the code on exit
+      compile_stats = true;
+      candor::Isolate::EnableCompileStats();
+    } else if (strncmp(argv[1], "--code-cache=", 13) == 0) {
+      // Reuse baseline code of the previous runs
+      candor::Isolate::EnableCodeCache(argv[1] + 13);
+    } else {
+      fprintf(stderr, "Unknown option: %s\n", argv[1]);
+      exit(1);
+    }
+    argc--;
+    argv++;
+  }
+
   if (argc < 2) {
     // Start repl
     StartRepl();
@@ -245,6 +264,8 @@ int main(int argc, char** argv) {
 
     int ret = code->Call(0, NULL)->ToNumber()->IntegralValue();
     fflush(stdout);
+
+    if (compile_stats) candor::Isolate::PrintCompileStats();
     return ret;
   }
 }
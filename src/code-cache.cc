@@ -0,0 +1,627 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "code-cache.h"
+
+#include <fcntl.h>  // open
+#include <stdio.h>  // snprintf, rename
+#include <stdlib.h>  // NULL
+#include <string.h>  // memcpy, memcmp, strlen
+#include <sys/mman.h>  // mmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>  // close, write, getpid
+
+#include "code-space.h"  // CodeSpace, CodeChunk, CodeProfile
+#include "compile-stats.h"  // CompileStats
+#include "cpu.h"  // CPU
+#include "heap.h"  // Heap
+#include "heap-inl.h"
+#include "macroassembler.h"  // Masm, ExternalReference
+#include "source-map.h"  // SourceMap
+#include "stubs.h"  // Stubs
+#include "zone.h"  // ZoneList
+
+namespace candor {
+namespace internal {
+
+char* CodeCache::dir_ = NULL;
+
+struct CodeCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t features;
+  uint32_t pointer_size;
+  uint32_t source_len;
+  uint32_t code_len;
+  uint32_t reloc_count;
+  uint32_t external_count;
+  uint32_t profile_count;
+  uint32_t root_count;
+  uint32_t source_map_count;
+};
+
+struct CodeCacheExternal {
+  uint32_t offset;
+  uint32_t type;
+  uint32_t index;
+  uint32_t id;
+};
+
+struct CodeCacheValue {
+  uint32_t tag;
+  uint32_t length;
+};
+
+struct CodeCacheSourceInfo {
+  uint32_t jit_offset;
+  uint32_t offset;
+};
+
+// Sequential writer into the growing buffer
+class CodeCacheWriter {
+ public:
+  CodeCacheWriter() : data_(new char[256]), size_(256), offset_(0) {
+  }
+
+  ~CodeCacheWriter() {
+    delete[] data_;
+  }
+
+  void Write(const void* data, uint32_t size) {
+    if (offset_ + size > size_) {
+      while (offset_ + size > size_) size_ <<= 1;
+
+      char* data = new char[size_];
+      memcpy(data, data_, offset_);
+      delete[] data_;
+      data_ = data;
+    }
+
+    memcpy(data_ + offset_, data, size);
+    offset_ += size;
+  }
+
+  inline char* data() { return data_; }
+  inline uint32_t offset() { return offset_; }
+
+ private:
+  char* data_;
+  uint32_t size_;
+  uint32_t offset_;
+};
+
+// Sequential reader of the mapped file, every read is bounds-checked
+class CodeCacheReader {
+ public:
+  CodeCacheReader(const char* data, uint32_t size) : pos_(data),
+                                                     end_(data + size) {
+  }
+
+  // Returns pointer to the next `size` bytes or NULL if file is too short
+  const char* Skip(uint32_t size) {
+    if (static_cast<uint32_t>(end_ - pos_) < size) return NULL;
+
+    const char* res = pos_;
+    pos_ += size;
+    return res;
+  }
+
+  bool Read(void* out, uint32_t size) {
+    const char* data = Skip(size);
+    if (data == NULL) return false;
+
+    memcpy(out, data, size);
+    return true;
+  }
+
+  inline bool IsEnded() { return pos_ == end_; }
+
+ private:
+  const char* pos_;
+  const char* end_;
+};
+
+
+void CodeCache::Enable(const char* dir) {
+  Disable();
+
+  int len = strlen(dir) + 1;
+  dir_ = new char[len];
+  memcpy(dir_, dir, len);
+}
+
+
+void CodeCache::Disable() {
+  delete[] dir_;
+  dir_ = NULL;
+}
+
+
+char* CodeCache::GetPath(CodeChunk* chunk) {
+  // 64-bit FNV-1a, source is compared with the stored one on load anyway
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (uint32_t i = 0; i < chunk->source_len(); i++) {
+    hash ^= static_cast<uint8_t>(chunk->source()[i]);
+    hash *= 0x100000001b3ULL;
+  }
+
+  int len = strlen(dir_) + 32;
+  char* path = new char[len];
+  snprintf(path,
+           len,
+           "%s/%016llx.ccache",
+           dir_,
+           static_cast<unsigned long long>(hash));
+
+  return path;
+}
+
+
+uint32_t CodeCache::GetFeatures() {
+  return (CPU::HasSSE4_1() ? 1 : 0) | (CPU::HasAVX2() ? 2 : 0);
+}
+
+
+char* CodeCache::Load(CodeSpace* space, CodeChunk* chunk, char** root) {
+  CompileStats::Timer timer(CompileStats::kCodeCache);
+
+  char* path = GetPath(chunk);
+  int fd = open(path, O_RDONLY);
+  delete[] path;
+  if (fd == -1) return NULL;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return NULL;
+  }
+
+  uint32_t size = st.st_size;
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) return NULL;
+
+  char* code = Read(space,
+                    chunk,
+                    root,
+                    reinterpret_cast<const char*>(data),
+                    size);
+  munmap(data, size);
+
+  if (code != NULL) CompileStats::Count(CompileStats::kCodeCacheHits, 1);
+
+  return code;
+}
+
+
+char* CodeCache::Read(CodeSpace* space,
+                      CodeChunk* chunk,
+                      char** root,
+                      const char* data,
+                      uint32_t size) {
+  Heap* heap = space->heap();
+  CodeCacheReader r(data, size);
+
+  CodeCacheHeader h;
+  if (!r.Read(&h, sizeof(h))) return NULL;
+  if (h.magic != kMagic ||
+      h.version != kVersion ||
+      h.features != GetFeatures() ||
+      h.pointer_size != sizeof(char*) ||
+      h.source_len != chunk->source_len()) {
+    return NULL;
+  }
+
+  // Hash collision
+  const char* source = r.Skip(h.source_len);
+  if (source == NULL ||
+      memcmp(source, chunk->source(), h.source_len) != 0) {
+    return NULL;
+  }
+
+  // Validate everything before touching the heap and the code space
+  const char* code = r.Skip(h.code_len);
+  const char* relocs = r.Skip(h.reloc_count * sizeof(uint32_t));
+  const char* externals = r.Skip(h.external_count *
+                                 sizeof(CodeCacheExternal));
+  const char* entries = r.Skip(h.profile_count * sizeof(uint32_t));
+  if (code == NULL ||
+      relocs == NULL ||
+      externals == NULL ||
+      entries == NULL ||
+      h.code_len < sizeof(char*)) {
+    return NULL;
+  }
+  uint32_t max_offset = h.code_len - sizeof(char*);
+
+  for (uint32_t i = 0; i < h.reloc_count; i++) {
+    uint32_t offset;
+    memcpy(&offset, relocs + i * sizeof(offset), sizeof(offset));
+    if (offset > max_offset) return NULL;
+  }
+
+  for (uint32_t i = 0; i < h.external_count; i++) {
+    CodeCacheExternal ext;
+    memcpy(&ext, externals + i * sizeof(ext), sizeof(ext));
+    if (ext.offset > max_offset) return NULL;
+
+    switch (ext.type) {
+      case ExternalReference::kStub:
+        if (ext.index >= BaseStub::kNone) return NULL;
+        break;
+      case ExternalReference::kHeapAddress:
+        if (ext.index > kNeedsGC) return NULL;
+        break;
+      case ExternalReference::kProfile:
+      case ExternalReference::kFeedback:
+        if (ext.index >= h.profile_count) return NULL;
+        break;
+      default:
+        return NULL;
+    }
+  }
+
+  for (uint32_t i = 0; i < h.profile_count; i++) {
+    uint32_t offset;
+    memcpy(&offset, entries + i * sizeof(offset), sizeof(offset));
+    if (offset >= h.code_len) return NULL;
+  }
+
+  const char* values = r.Skip(0);
+  for (uint32_t i = 0; i < h.root_count; i++) {
+    CodeCacheValue value;
+    if (!r.Read(&value, sizeof(value)) || r.Skip(value.length) == NULL) {
+      return NULL;
+    }
+
+    switch (value.tag) {
+      case Heap::kTagNil:
+      case Heap::kTagObject:
+      case Heap::kTagBoolean:
+      case Heap::kTagNumber:
+      case Heap::kTagString:
+        break;
+      default:
+        return NULL;
+    }
+  }
+
+  const char* source_map = r.Skip(h.source_map_count *
+                                  sizeof(CodeCacheSourceInfo));
+  if (source_map == NULL || !r.IsEnded()) return NULL;
+
+  // Functions' profiles
+  CodeProfile** profiles = new CodeProfile*[h.profile_count];
+  for (uint32_t i = 0; i < h.profile_count; i++) {
+    profiles[i] = new CodeProfile(chunk);
+    chunk->profiles()->Push(profiles[i]);
+  }
+
+  // Root context
+  ZoneList<char*> root_values;
+  CodeCacheReader vr(values, size - (values - data));
+  for (uint32_t i = 0; i < h.root_count; i++) {
+    CodeCacheValue value;
+    vr.Read(&value, sizeof(value));
+    const char* bytes = vr.Skip(value.length);
+
+    switch (value.tag) {
+      case Heap::kTagObject:
+        root_values.Push(HObject::NewEmpty(heap));
+        break;
+      case Heap::kTagBoolean:
+        root_values.Push(heap->CreateBoolean(value.length != 0 &&
+                                             bytes[0] != 0));
+        break;
+      case Heap::kTagNumber:
+        {
+          double num = 0;
+          if (value.length == sizeof(num)) memcpy(&num, bytes, sizeof(num));
+          root_values.Push(heap->CreateNumber(num));
+        }
+        break;
+      case Heap::kTagString:
+        root_values.Push(heap->CreateString(bytes, value.length));
+        break;
+      default:
+        root_values.Push(HNil::New());
+        break;
+    }
+  }
+  *root = HContext::New(heap, &root_values);
+
+  // Resolve external references before putting code, stubs may be
+  // generated on the first use
+  char** targets = new char*[h.external_count];
+  for (uint32_t i = 0; i < h.external_count; i++) {
+    CodeCacheExternal ext;
+    memcpy(&ext, externals + i * sizeof(ext), sizeof(ext));
+
+    switch (ext.type) {
+      case ExternalReference::kStub:
+        targets[i] = space->stubs()->Get(
+            static_cast<BaseStub::StubType>(ext.index));
+        break;
+      case ExternalReference::kHeapAddress:
+        if (ext.index == kLastStack) {
+          targets[i] = reinterpret_cast<char*>(heap->last_stack());
+        } else if (ext.index == kLastFrame) {
+          targets[i] = reinterpret_cast<char*>(heap->last_frame());
+        } else {
+          targets[i] = reinterpret_cast<char*>(heap->needs_gc_addr());
+        }
+        break;
+      case ExternalReference::kProfile:
+        targets[i] = reinterpret_cast<char*>(profiles[ext.index]);
+        break;
+      case ExternalReference::kFeedback:
+        targets[i] = reinterpret_cast<char*>(
+            profiles[ext.index]->GetFeedback(ext.id));
+        break;
+      default:
+        UNEXPECTED
+        break;
+    }
+  }
+
+  // Code is patched below, keep its page writable till the end of the scope
+  CodeSpace::WriteScope scope(space);
+  char* addr = space->Put(code, h.code_len, chunk);
+  chunk->addr_ = addr;
+
+  for (uint32_t i = 0; i < h.reloc_count; i++) {
+    uint32_t offset;
+    memcpy(&offset, relocs + i * sizeof(offset), sizeof(offset));
+
+    char** slot = reinterpret_cast<char**>(addr + offset);
+    *slot = addr + reinterpret_cast<intptr_t>(*slot);
+  }
+
+  for (uint32_t i = 0; i < h.external_count; i++) {
+    CodeCacheExternal ext;
+    memcpy(&ext, externals + i * sizeof(ext), sizeof(ext));
+
+    *reinterpret_cast<char**>(addr + ext.offset) = targets[i];
+  }
+
+  for (uint32_t i = 0; i < h.profile_count; i++) {
+    uint32_t offset;
+    memcpy(&offset, entries + i * sizeof(offset), sizeof(offset));
+
+    profiles[i]->entry_ = addr + offset;
+  }
+
+  SourceMap* map = heap->source_map();
+  for (uint32_t i = 0; i < h.source_map_count; i++) {
+    CodeCacheSourceInfo info;
+    memcpy(&info, source_map + i * sizeof(info), sizeof(info));
+
+    map->Push(info.jit_offset, info.offset);
+  }
+  map->Commit(chunk->filename(), chunk->source(), chunk->source_len(), addr);
+
+  delete[] targets;
+  delete[] profiles;
+
+  return addr;
+}
+
+
+void CodeCache::Save(CodeSpace* space,
+                     CodeChunk* chunk,
+                     Masm* masm,
+                     char* root) {
+  CompileStats::Timer timer(CompileStats::kCodeCache);
+
+  Heap* heap = space->heap();
+  CodeCacheHeader h;
+  CodeCacheWriter w;
+
+  h.magic = kMagic;
+  h.version = kVersion;
+  h.features = GetFeatures();
+  h.pointer_size = sizeof(char*);
+  h.source_len = chunk->source_len();
+  h.code_len = masm->offset();
+  h.reloc_count = 0;
+  h.external_count = masm->externals()->length();
+  h.profile_count = chunk->profiles()->length();
+  HContext* context = HValue::As<HContext>(root);
+  h.root_count = context->slots();
+  h.source_map_count = heap->source_map()->queue()->length();
+
+  CodeProfile** profiles = new CodeProfile*[h.profile_count];
+  CodeProfileList::Item* phead = chunk->profiles()->head();
+  for (uint32_t i = 0; phead != NULL; phead = phead->next(), i++) {
+    profiles[i] = phead->value();
+  }
+
+  // Copy of the code without any process-specific addresses
+  char* code = new char[h.code_len];
+  memcpy(code, chunk->addr(), h.code_len);
+
+  CodeCacheWriter relocs;
+  bool ok = true;
+  ZoneList<RelocationInfo*>::Item* rhead = masm->relocation_info_.head();
+  for (; rhead != NULL; rhead = rhead->next()) {
+    RelocationInfo* info = rhead->value();
+    if (info->type_ != RelocationInfo::kAbsolute) continue;
+
+    // Weak references to the heap values can't be restored
+    if (info->notify_gc_ || info->size_ != RelocationInfo::kPointer) {
+      ok = false;
+      break;
+    }
+
+    intptr_t target = info->target_;
+    memcpy(code + info->offset_, &target, sizeof(target));
+    relocs.Write(&info->offset_, sizeof(info->offset_));
+    h.reloc_count++;
+  }
+
+  CodeCacheWriter externals;
+  ExternalReferenceList::Item* ehead = masm->externals()->head();
+  for (; ok && ehead != NULL; ehead = ehead->next()) {
+    ExternalReference* ref = ehead->value();
+    CodeCacheExternal ext;
+    ext.offset = ref->offset();
+    ext.type = ref->type();
+    ext.index = h.profile_count;
+    ext.id = 0;
+
+    switch (ref->type()) {
+      case ExternalReference::kStub:
+        ext.index = space->stubs()->TypeOf(ref->value());
+        ok = ext.index != BaseStub::kNone;
+        break;
+      case ExternalReference::kHeapAddress:
+        if (ref->value() == reinterpret_cast<char*>(heap->last_stack())) {
+          ext.index = kLastStack;
+        } else if (ref->value() ==
+                   reinterpret_cast<char*>(heap->last_frame())) {
+          ext.index = kLastFrame;
+        } else if (ref->value() ==
+                   reinterpret_cast<char*>(heap->needs_gc_addr())) {
+          ext.index = kNeedsGC;
+        } else {
+          ok = false;
+        }
+        break;
+      case ExternalReference::kProfile:
+        for (uint32_t i = 0; i < h.profile_count; i++) {
+          if (reinterpret_cast<char*>(profiles[i]) == ref->value()) {
+            ext.index = i;
+          }
+        }
+        ok = ext.index != h.profile_count;
+        break;
+      case ExternalReference::kFeedback:
+        {
+          TypeFeedback* feedback =
+              reinterpret_cast<TypeFeedback*>(ref->value());
+          ext.id = feedback->id();
+          for (uint32_t i = 0; i < h.profile_count; i++) {
+            if (profiles[i]->feedback_.Get(NumberKey::New(ext.id)) ==
+                feedback) {
+              ext.index = i;
+            }
+          }
+          ok = ext.index != h.profile_count;
+        }
+        break;
+      default:
+        ok = false;
+        break;
+    }
+
+    memset(code + ext.offset, 0, sizeof(intptr_t));
+    externals.Write(&ext, sizeof(ext));
+  }
+
+  CodeCacheWriter values;
+  for (uint32_t i = 0; ok && i < h.root_count; i++) {
+    char* value = *context->GetSlotAddress(i);
+    CodeCacheValue v;
+    v.tag = HValue::GetTag(value);
+    v.length = 0;
+
+    switch (v.tag) {
+      case Heap::kTagNil:
+      case Heap::kTagObject:
+        // Nothing but the `global` object (see Root::Root)
+        values.Write(&v, sizeof(v));
+        break;
+      case Heap::kTagBoolean:
+        {
+          uint8_t b = HBoolean::Value(value) ? 1 : 0;
+          v.length = sizeof(b);
+          values.Write(&v, sizeof(v));
+          values.Write(&b, sizeof(b));
+        }
+        break;
+      case Heap::kTagNumber:
+        {
+          double num = HNumber::DoubleValue(value);
+          v.length = sizeof(num);
+          values.Write(&v, sizeof(v));
+          values.Write(&num, sizeof(num));
+        }
+        break;
+      case Heap::kTagString:
+        v.length = HString::Length(value);
+        values.Write(&v, sizeof(v));
+        values.Write(HString::Value(heap, value), v.length);
+        break;
+      default:
+        ok = false;
+        break;
+    }
+  }
+
+  if (ok) {
+    w.Write(&h, sizeof(h));
+    w.Write(chunk->source(), h.source_len);
+    w.Write(code, h.code_len);
+    w.Write(relocs.data(), relocs.offset());
+    w.Write(externals.data(), externals.offset());
+    for (uint32_t i = 0; i < h.profile_count; i++) {
+      uint32_t offset = profiles[i]->entry() - chunk->addr();
+      w.Write(&offset, sizeof(offset));
+    }
+    w.Write(values.data(), values.offset());
+
+    SourceMap::SourceQueue::Item* shead = heap->source_map()->queue()->head();
+    for (; shead != NULL; shead = shead->next()) {
+      CodeCacheSourceInfo info;
+      info.jit_offset = shead->value()->jit_offset();
+      info.offset = shead->value()->offset();
+      w.Write(&info, sizeof(info));
+    }
+  }
+
+  delete[] code;
+  delete[] profiles;
+
+  if (!ok) return;
+
+  // Write into the temporary file and rename it, so other processes will
+  // never see partially written one
+  char* path = GetPath(chunk);
+  int tmp_len = strlen(path) + 32;
+  char* tmp = new char[tmp_len];
+  snprintf(tmp, tmp_len, "%s.%d.tmp", path, static_cast<int>(getpid()));
+
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd != -1) {
+    bool written =
+        write(fd, w.data(), w.offset()) == static_cast<ssize_t>(w.offset());
+    close(fd);
+
+    if (!written || rename(tmp, path) != 0) unlink(tmp);
+  }
+
+  delete[] tmp;
+  delete[] path;
+}
+
+}  // namespace internal
+}  // namespace candor
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_CODE_CACHE_H_
+#define _SRC_CODE_CACHE_H_
+
+#include <stdint.h>  // uint32_t
+#include <stdlib.h>  // NULL
+
+namespace candor {
+namespace internal {
+
+// Forward declarations
+class CodeSpace;
+class CodeChunk;
+class Masm;
+
+// Baseline code of compiled sources saved on disk, so other processes
+// running the same source can skip parsing and code generation.
+//
+// Files are named after the source's hash and contain the source itself,
+// code with internal absolute addresses made chunk-relative, types of
+// external references (stubs, heap fields, profiles and type feedback) to
+// resolve when loading, root context's values, entries of the functions and
+// the source map. Files of other versions, CPUs or sources are ignored.
+class CodeCache {
+ public:
+  static void Enable(const char* dir);
+  static void Disable();
+  static inline bool enabled() { return dir_ != NULL; }
+
+  // Puts cached code of chunk's source into code space, returns NULL if
+  // it isn't cached
+  static char* Load(CodeSpace* space, CodeChunk* chunk, char** root);
+
+  // Saves code that has just been put into the chunk, `root` is the context
+  // allocated for it. Should be called before committing the source map.
+  // Code with unknown external references is silently skipped.
+  static void Save(CodeSpace* space, CodeChunk* chunk, Masm* masm, char* root);
+
+  // Bump on every change of the generated code or of the file's format
+  static const uint32_t kVersion = 1;
+  static const uint32_t kMagic = 0x43414e43;  // 'CNAC'
+
+  enum HeapAddress {
+    kLastStack,
+    kLastFrame,
+    kNeedsGC
+  };
+
+ private:
+  // Validates mapped file and puts its code, returns NULL on mismatch
+  static char* Read(CodeSpace* space,
+                    CodeChunk* chunk,
+                    char** root,
+                    const char* data,
+                    uint32_t size);
+
+  static char* GetPath(CodeChunk* chunk);
+  static uint32_t GetFeatures();
+
+  static char* dir_;
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_CODE_CACHE_H_
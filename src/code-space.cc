@@ -24,7 +24,7 @@
 
 #include <stdlib.h>  // NULL
 #include <string.h>  // memcpy, memset
-#include <sys/mman.h>  // mmap
+#include <sys/mman.h>  // mmap, mprotect
 
 #include "candor.h"  // Error
 #include "heap.h"  // Heap
@@ -42,12 +42,19 @@
 #include "source-map.h"  // SourceMap
 #include "stubs.h"  // EntryStub
 #include "pic.h"  // PIC
+#include "compile-queue.h"  // CompileQueue
+#include "code-cache.h"  // CodeCache
+#include "compile-stats.h"  // CompileStats
 #include "utils.h"  // GetPageSize
 
 namespace candor {
 namespace internal {
 
-CodeSpace::CodeSpace(Heap* heap) : heap_(heap) {
+int CodeSpace::tier_up_threshold_ = CodeSpace::kDefaultTierUpThreshold;
+
+CodeSpace::CodeSpace(Heap* heap) : heap_(heap),
+                                   compile_queue_(NULL),
+                                   write_depth_(0) {
   stubs_ = new Stubs(this);
   entry_ = stubs()->GetEntryStub();
   heap->code_space(this);
@@ -55,33 +62,134 @@ CodeSpace::CodeSpace(Heap* heap) : heap_(heap) {
 
 
 CodeSpace::~CodeSpace() {
+  delete compile_queue_;
   delete stubs_;
 }
 
 
+CodeSpace::WriteScope::WriteScope(CodeSpace* space) : space_(space) {
+  space_->write_depth_++;
+}
+
+
+CodeSpace::WriteScope::~WriteScope() {
+  if (--space_->write_depth_ == 0) space_->Protect();
+}
+
+
+void CodeSpace::Unprotect(char* addr, uint32_t size) {
+  assert(write_depth_ > 0);
+
+  CodePageList::Item* phead = pages_.head();
+  for (; phead != NULL; phead = phead->next()) {
+    CodePage* page = phead->value();
+    if (page->Contains(addr) || page->Contains(addr + size - 1)) {
+      page->Unprotect();
+    }
+  }
+}
+
+
+void CodeSpace::Protect() {
+  CodePageList::Item* phead = pages_.head();
+  for (; phead != NULL; phead = phead->next()) {
+    if (phead->value()->writable()) phead->value()->Protect();
+  }
+}
+
+
+void CodeSpace::Mark(char* addr) {
+  CodeBlockTree::Item* item = blocks_.FindFloor(NumberKey::New(addr));
+  if (item == NULL || !item->value->Contains(addr)) return;
+
+  item->value->chunk()->marked_ = true;
+}
+
+
 void CodeSpace::CollectGarbage() {
-  // Remove unused chunks
-  CodeChunkList::Item* chead = chunks_.head();
-  CodeChunkList::Item* cnext;
-  for (; chead != NULL; chead = cnext) {
-    CodeChunk* chunk = chead->value();
-    cnext = chead->next();
+  WriteScope scope(this);
+
+  // Freeing chunk releases PICs called by it, collect their chunks too
+  bool collected;
+  do {
+    collected = false;
+
+    CodeChunkList::Item* chead = chunks_.head();
+    CodeChunkList::Item* cnext;
+    for (; chead != NULL; chead = cnext) {
+      CodeChunk* chunk = chead->value();
+      cnext = chead->next();
+
+      if (chunk->ref_ != 0 || chunk->marked_) continue;
 
-    if (chunk->ref_ == 0) chunks_.Remove(chead);
+      Free(chunk);
+      chunks_.Remove(chead);
+      collected = true;
+    }
+  } while (collected);
+
+  // Reset marks for the next collection
+  CodeChunkList::Item* chead = chunks_.head();
+  for (; chead != NULL; chead = chead->next()) {
+    chead->value()->marked_ = false;
   }
 
-  // Remove unused pages
+  // Unmap empty pages
   CodePageList::Item* phead = pages_.head();
   CodePageList::Item* pnext;
   for (; phead != NULL; phead = pnext) {
     CodePage* page = phead->value();
     pnext = phead->next();
 
-    if (page->ref_ == 0) pages_.Remove(phead);
+    if (page->used() == 0) pages_.Remove(phead);
   }
 }
 
 
+void CodeSpace::Free(CodeChunk* chunk) {
+  CodeProfileList::Item* phead = chunk->profiles()->head();
+  for (; phead != NULL; phead = phead->next()) {
+    PICList::Item* pic = phead->value()->pics_.head();
+    for (; pic != NULL; pic = pic->next()) pic->value()->Release();
+  }
+
+  CodeBlockList::Item* bhead = chunk->blocks_.head();
+  for (; bhead != NULL; bhead = bhead->next()) {
+    CodeBlock* block = bhead->value();
+
+    blocks_.Remove(NumberKey::New(block->addr()));
+    heap()->source_map()->Remove(block->addr(),
+                                 block->addr() + block->size());
+    block->page()->Unprotect();
+    block->page()->Free(block->addr(), block->size());
+  }
+}
+
+
+uint32_t CodeSpace::size() {
+  uint32_t result = 0;
+
+  CodePageList::Item* phead = pages_.head();
+  for (; phead != NULL; phead = phead->next()) {
+    result += phead->value()->size();
+  }
+
+  return result;
+}
+
+
+uint32_t CodeSpace::used() {
+  uint32_t result = 0;
+
+  CodePageList::Item* phead = pages_.head();
+  for (; phead != NULL; phead = phead->next()) {
+    result += phead->value()->used();
+  }
+
+  return result;
+}
+
+
 Error* CodeSpace::CreateError(CodeChunk* chunk,
                               const char* message,
                               uint32_t offset) {
@@ -101,9 +209,6 @@ Error* CodeSpace::CreateError(CodeChunk* chunk,
 CodeChunk* CodeSpace::CreateChunk(const char* filename,
                                   const char* source,
                                   uint32_t length) {
-  // Remove unused code data first
-  CollectGarbage();
-
   CodeChunk* c = new CodeChunk(filename, source, length);
   chunks_.Push(c);
 
@@ -112,17 +217,37 @@ CodeChunk* CodeSpace::CreateChunk(const char* filename,
 
 
 void CodeSpace::Put(CodeChunk* chunk, Masm* masm) {
+  chunk->addr_ = Put(masm, chunk);
+}
+
+
+void CodeSpace::PutStub(CodeChunk* chunk, Masm* masm) {
+  chunk->stub_ = true;
+  Put(chunk, masm);
+}
+
+
+char* CodeSpace::Put(Masm* masm, CodeChunk* owner) {
+  WriteScope scope(this);
+
   // Align code in chunk
   masm->AlignCode();
 
-  char* code = masm->buffer();
-  uint32_t length = masm->offset();
+  char* addr = Put(masm->buffer(), masm->offset(), owner);
+
+  // Relocate references
+  masm->Relocate(heap(), addr);
+
+  return addr;
+}
+
 
+char* CodeSpace::Put(const char* code, uint32_t length, CodeChunk* owner) {
   // Go through pages to find one with enough space
   CodePage* p = NULL;
   List<CodePage*, EmptyClass>::Item* item = pages_.head();
   while (item != NULL) {
-    if (item->value()->Has(length)) {
+    if (item->value()->stubs() == owner->stub_ && item->value()->Has(length)) {
       p = item->value();
       break;
     }
@@ -132,19 +257,24 @@ void CodeSpace::Put(CodeChunk* chunk, Masm* masm) {
   // If failed - allocate new page
   if (p == NULL) {
     p = new CodePage(length);
+    p->stubs_ = owner->stub_;
     pages_.Push(p);
   }
 
+  CompileStats::Count(CompileStats::kCodeBytes, length);
+
   // Copy code into executable memory
-  chunk->page_ = p;
-  chunk->addr_ = p->Allocate(length);
-  memcpy(chunk->addr_, code, length);
+  WriteScope scope(this);
+  p->Unprotect();
 
-  // Chunk now references page
-  p->Ref();
+  char* addr = p->Allocate(length);
+  memcpy(addr, code, length);
 
-  // Relocate references
-  masm->Relocate(heap(), chunk->addr_);
+  CodeBlock* block = new CodeBlock(p, owner, addr, length);
+  owner->blocks_.Push(block);
+  blocks_.Insert(NumberKey::New(addr), block);
+
+  return addr;
 }
 
 
@@ -157,6 +287,83 @@ char* CodeSpace::Compile(const char* filename,
 
   CodeChunk* chunk = CreateChunk(filename, source, length);
 
+  char* code = NULL;
+  if (CodeCache::enabled()) code = CodeCache::Load(this, chunk, root);
+  if (code == NULL) {
+    // AST is kept for the lazy compilation of chunk's functions
+    chunk->zone_ = new Zone();
+    AstNode* ast = Parse(chunk, error);
+    chunk->zone_->Leave();
+
+    // Error references chunk's source, so it is never collected
+    if (ast == NULL) {
+      chunk->FreeAst();
+      return NULL;
+    }
+
+    code = Install(chunk, ast, root);
+  }
+
+  // Chunk lives while its code is reachable from now on
+  chunk->Unref();
+
+  return code;
+}
+
+
+CompileTask* CodeSpace::CompileAsync(const char* filename,
+                                     const char* source,
+                                     uint32_t length) {
+  CompileTask* task = new CompileTask(this,
+                                      CreateChunk(filename, source, length));
+
+  compile_queue()->Push(task);
+
+  return task;
+}
+
+
+char* CodeSpace::FinishCompile(CompileTask* task, char** root, Error** error) {
+  compile_queue()->Wait(task);
+
+  Zone zone;
+
+  CodeChunk* chunk = task->chunk();
+  char* code = NULL;
+  if (task->ast() == NULL) {
+    *error = task->error();
+  } else {
+    // Functions of the chunk are compiled lazily from the task's AST
+    chunk->zone_ = task->ReleaseZone();
+
+    // Source was already parsed, but code generation may still be skipped
+    if (CodeCache::enabled()) code = CodeCache::Load(this, chunk, root);
+    if (code == NULL) {
+      code = Install(chunk, task->ast(), root);
+    } else {
+      Attach(chunk, task->ast(), *root);
+    }
+    chunk->Unref();
+  }
+
+  delete task;
+
+  return code;
+}
+
+
+CompileQueue* CodeSpace::compile_queue() {
+  // Threads are started only if the embedder has asked for them
+  if (compile_queue_ == NULL) {
+    compile_queue_ = new CompileQueue(CompileQueue::DefaultThreadCount());
+  }
+
+  return compile_queue_;
+}
+
+
+AstNode* CodeSpace::Parse(CodeChunk* chunk, Error** error) {
+  CompileStats::Timer timer(CompileStats::kParse);
   Parser p(chunk->source(), chunk->source_len());
 
   AstNode* ast = p.Execute();
@@ -167,49 +374,73 @@ char* CodeSpace::Compile(const char* filename,
   }
 
   // Add scope chunkrmation to variables (i.e. stack vs context, and indexes)
+  timer.Switch(CompileStats::kScopeAnalyze);
   Scope::Analyze(ast);
 
+  return ast;
+}
+
+
+char* CodeSpace::Install(CodeChunk* chunk, AstNode* ast, char** root) {
+  // Stubs used by the code are generated lazily, write them with the code
+  WriteScope scope(this);
+
+  // Only the AST and root slots of its literals outlive the code generation
+  Zone zone;
+
+  CompileStats::Timer timer(CompileStats::kFullgen);
   Root r(heap());
   Masm masm(this);
 
+  // Inner functions will be compiled later, but with the same root context
+  chunk->zone_->Enter();
+  chunk->literals_ = new Root::SlotMap();
+  r.literals(chunk->literals_);
+  r.Prefill(ast);
+  chunk->zone_->Leave();
+
   for (FunctionIterator it(ast); !it.IsEnded(); it.Advance()) {
     FunctionLiteral* current = it.Value();
+    CodeProfile* profile = new CodeProfile(chunk);
+    chunk->profiles()->Push(profile);
 
-    int len = current->own_length();
-    if (len < HIRGen::kMaxOptimizableSize) {
-      // Generate CFG with SSA
-      HIRGen hir(heap(), &r, chunk->filename());
+    Fullgen f(heap(), &r, chunk->filename());
+    f.profile(profile);
 
-      hir.Build(current);
-
-      // Generate low-level representation:
-      //   For each root in reverse order generate lir
-      //   (Generate children first, parents later)
-      HIRBlockList::Item* head = hir.roots()->head();
-      for (; head != NULL; head = head->next()) {
-        // Generate LIR
-        LGen lir(&hir, chunk->filename(), head->value());
-
-        // Generate Masm code
-        lir.Generate(&masm, heap()->source_map());
+    if (current == ast) {
+      // Generate baseline code, hot functions will be recompiled by HIR/LIR
+      // (see Optimize() below)
+      if (current->own_length() >= HIRGen::kMaxOptimizableSize) {
+        f.profile(NULL);
       }
-    } else {
-      Fullgen f(heap(), &r, chunk->filename());
-
-      // Create instruction list
       f.Build(current);
-
-      // Generate instructions
-      f.Generate(&masm);
+      CompileStats::Count(CompileStats::kBaselineFunctions, 1);
+    } else {
+      // Inner functions are compiled on the first call (see CompileLazy())
+      f.BuildLazy(current);
     }
+
+    // Generate instructions
+    f.Generate(&masm);
   }
 
   // Store root
   *root = r.Allocate()->addr();
+  timer.Switch(CompileStats::kRelocation);
 
   // Put code into code space
   Put(chunk, &masm);
 
+  // Store entries of the baseline code (or lazy trampolines)
+  CodeProfileList::Item* phead = chunk->profiles()->head();
+  for (FunctionIterator it(ast); !it.IsEnded(); it.Advance()) {
+    phead->value()->entry_ = chunk->addr() + it.Value()->label()->pos();
+    phead = phead->next();
+  }
+  Attach(chunk, ast, *root);
+
+  if (CodeCache::enabled()) CodeCache::Save(this, chunk, &masm, *root);
+
   // Relocate source map
   heap()->source_map()->Commit(chunk->filename(),
                                chunk->source(),
@@ -220,6 +451,260 @@ char* CodeSpace::Compile(const char* filename,
 }
 
 
+FunctionLiteral* CodeSpace::GetAst(CodeProfile* profile, char* root) {
+  CodeChunk* chunk = profile->chunk();
+  if (chunk->ast_ != NULL) return profile->fn_;
+
+  // Code was loaded from the cache, but source has been compiled once
+  Error* error = NULL;
+  chunk->zone_ = new Zone();
+  AstNode* ast = Parse(chunk, &error);
+  chunk->zone_->Leave();
+  assert(ast != NULL);
+
+  Attach(chunk, ast, root);
+
+  return profile->fn_;
+}
+
+
+void CodeSpace::Attach(CodeChunk* chunk, AstNode* ast, char* root) {
+  chunk->ast_ = ast;
+  chunk->zone_->Enter();
+
+  // Root context of the cached code has all literals already
+  if (chunk->literals_ == NULL) {
+    chunk->literals_ = new Root::SlotMap();
+    Root r(heap(), HValue::As<HContext>(root));
+    r.literals(chunk->literals_);
+    r.Prefill(ast);
+  }
+
+  // Functions are referenced by their existing code, compilers replace
+  // function's own label while generating its new code
+  CodeProfileList::Item* phead = chunk->profiles()->head();
+  for (FunctionIterator it(ast); !it.IsEnded(); it.Advance()) {
+    CodeProfile* profile = phead->value();
+
+    profile->fn_ = it.Value();
+    profile->fn_->label(new Label(profile->entry()));
+    phead = phead->next();
+  }
+  chunk->zone_->Leave();
+}
+
+
+int CodeSpace::Redirect(char* from, char* to, char* backup) {
+  // NOTE: Code at `from` should be long enough (see FProfile, FCompileLazy)
+  Masm patch(this);
+  patch.Jump(to);
+
+  WriteScope scope(this);
+  Unprotect(from, patch.offset());
+  if (backup != NULL) {
+    assert(patch.offset() <= CodeProfile::kMaxPrologueSize);
+    memcpy(backup, from, patch.offset());
+  }
+  memcpy(from, patch.buffer(), patch.offset());
+
+  return patch.offset();
+}
+
+
+bool CodeSpace::CompileLazy(CodeProfile* profile, char* root) {
+  // Code is put and trampoline is redirected with one permission flip
+  WriteScope scope(this);
+
+  CodeChunk* chunk = profile->chunk();
+  FunctionLiteral* fn = GetAst(profile, root);
+
+  Zone zone;
+
+  // Compile() has already put all function's literals into the root context
+  Root r(heap(), HValue::As<HContext>(root));
+  r.literals(chunk->literals_);
+
+  CompileStats::Timer timer(CompileStats::kFullgen);
+  Masm masm(this);
+  Fullgen f(heap(), &r, chunk->filename());
+
+  // Label of the trampoline is replaced by the one bound in the new code
+  Label* trampoline_label = fn->label();
+  fn->label(NULL);
+
+  if (fn->own_length() < HIRGen::kMaxOptimizableSize) f.profile(profile);
+  f.Build(fn);
+  f.Generate(&masm);
+  CompileStats::Count(CompileStats::kBaselineFunctions, 1);
+
+  // Root context can't be extended with new constants
+  if (r.is_extended()) {
+    fn->label(trampoline_label);
+    return false;
+  }
+  timer.Switch(CompileStats::kRelocation);
+
+  char* code = Put(&masm, chunk);
+  heap()->source_map()->Commit(chunk->filename(),
+                               chunk->source(),
+                               chunk->source_len(),
+                               code);
+
+  // Replace trampoline with a jump to the baseline code
+  char* trampoline = profile->entry();
+  profile->entry_ = code + fn->label()->pos();
+  Redirect(trampoline, profile->entry(), NULL);
+
+  chunk->zone_->Enter();
+  fn->label(new Label(profile->entry()));
+  chunk->zone_->Leave();
+
+  return true;
+}
+
+
+char* CodeSpace::Generate(CodeProfile* profile, int osr_loop, char* root) {
+  // PICs, the code and the redirect of the baseline code are written at once
+  WriteScope scope(this);
+
+  CodeChunk* chunk = profile->chunk();
+  FunctionLiteral* fn = GetAst(profile, root);
+
+  Zone zone;
+
+  // Deoptimization code embeds version of the code (see Deoptimize())
+  profile->version_++;
+
+  // Optimized code should use the same root context as the baseline one
+  Root r(heap(), HValue::As<HContext>(root));
+  r.literals(chunk->literals_);
+
+  // Label of the baseline entry is replaced by the one bound in the new code
+  Label* entry_label = fn->label();
+  fn->label(NULL);
+
+  HIRGen hir(heap(), &r, chunk->filename());
+
+  // Speculate on operand kinds seen by the baseline code
+  hir.profile(profile);
+
+  if (osr_loop != -1) {
+    AstList::Item* head = fn->children()->head();
+    for (; head != NULL; head = head->next()) {
+      if (head->value()->id == osr_loop) break;
+    }
+    assert(head != NULL);
+    hir.osr_loop(head->value());
+  }
+
+  hir.Build(fn);
+
+  // Root context can't be extended with new constants
+  if (r.is_extended()) {
+    fn->label(entry_label);
+    return NULL;
+  }
+
+  ZoneList<LGen*> lirs;
+  HIRBlockList::Item* head = hir.roots()->head();
+  for (; head != NULL; head = head->next()) {
+    LGen* lir = new LGen(&hir, chunk->filename(), head->value());
+
+    // Liveness sets of the huge function would take too much memory
+    if (lir->is_too_large()) {
+      fn->label(entry_label);
+      return NULL;
+    }
+    lirs.Push(lir);
+  }
+
+  Masm masm(this);
+  ZoneList<LGen*>::Item* lhead = lirs.head();
+  for (; lhead != NULL; lhead = lhead->next()) {
+    CompileStats::Timer timer(CompileStats::kCodegen);
+    lhead->value()->Generate(&masm, heap()->source_map());
+  }
+  CompileStats::Count(CompileStats::kOptimizedFunctions, 1);
+
+  CompileStats::Timer timer(CompileStats::kRelocation);
+  char* code = Put(&masm, chunk);
+
+  // PICs are released only with the code calling them
+  while (pics_.length() != 0) profile->pics_.Push(pics_.Shift());
+
+  heap()->source_map()->Commit(chunk->filename(),
+                               chunk->source(),
+                               chunk->source_len(),
+                               code);
+
+  code += fn->label()->pos();
+  fn->label(entry_label);
+
+  return code;
+}
+
+
+char* CodeSpace::Optimize(CodeProfile* profile, char* root) {
+  char* code = Generate(profile, -1, root);
+  if (code == NULL) return NULL;
+
+  profile->code_ = code;
+  profile->code_version_ = profile->version();
+
+  // Redirect baseline code to the optimized one, it's safe to overwrite
+  // profiling code in the function's prologue (see FProfile)
+  profile->prologue_size_ = Redirect(profile->entry(),
+                                     profile->code(),
+                                     profile->prologue_);
+
+  return profile->code();
+}
+
+
+char* CodeSpace::CompileOSR(CodeProfile* profile, int loop, char* root) {
+  // Other activation of the function could have compiled it already
+  if (profile->osr_code_ != NULL && profile->osr_loop_ == loop) {
+    return profile->osr_code_;
+  }
+
+  char* code = Generate(profile, loop, root);
+  if (code == NULL) return NULL;
+
+  profile->osr_code_ = code;
+  profile->osr_loop_ = loop;
+  profile->osr_version_ = profile->version();
+
+  return code;
+}
+
+
+void CodeSpace::Deoptimize(CodeProfile* profile, int version) {
+  // Function could be deoptimized already by other failed guard, or guard
+  // has failed in the replaced code that is still running in some frame
+  if (version != profile->code_version_ && version != profile->osr_version_) {
+    return;
+  }
+
+  // Put profiling prologue back, frames of the optimized code on the stack
+  // are still valid and will complete on the generic paths
+  if (profile->code() != NULL) {
+    WriteScope scope(this);
+    Unprotect(profile->entry(), profile->prologue_size_);
+    memcpy(profile->entry(), profile->prologue_, profile->prologue_size_);
+  }
+
+  profile->code_ = NULL;
+  profile->osr_code_ = NULL;
+  profile->code_version_ = 0;
+  profile->osr_version_ = 0;
+  if (++profile->deopts_ >= kMaxDeopts) {
+    profile->Disable();
+  } else {
+    profile->counter_ = tier_up_threshold();
+  }
+}
+
+
 char* CodeSpace::CreatePIC() {
   PIC* p = new PIC(this);
 
@@ -240,12 +725,14 @@ Value* CodeSpace::Run(char* fn, uint32_t argc, Value* argv[]) {
 }
 
 
-CodePage::CodePage(uint32_t size) : offset_(0), ref_(0) {
-  size_ = RoundUp(size, GetPageSize());
+CodePage::CodePage(uint32_t size) : used_(0),
+                                    writable_(true),
+                                    stubs_(false) {
+  size_ = RoundUp(size > kMinSize ? size : kMinSize, GetPageSize());
 
   page_ = reinterpret_cast<char*>(mmap(0,
                                        size_,
-                                       PROT_READ | PROT_WRITE| PROT_EXEC,
+                                       PROT_READ | PROT_WRITE,
                                        MAP_ANON | MAP_PRIVATE,
                                        -1,
                                        0));
@@ -261,6 +748,10 @@ CodePage::CodePage(uint32_t size) : offset_(0), ref_(0) {
                                         -1,
                                         0));
   if (guard_ == MAP_FAILED) abort();
+
+  gaps_.Push(new Gap(0, size_));
+
+  Protect();
 }
 
 
@@ -271,29 +762,90 @@ CodePage::~CodePage() {
 
 
 bool CodePage::Has(uint32_t size) {
-  return offset_ + size < size_;
+  GapList::Item* head = gaps_.head();
+  for (; head != NULL; head = head->next()) {
+    if (head->value()->size >= size) return true;
+  }
+
+  return false;
 }
 
 
 char* CodePage::Allocate(uint32_t size) {
-  offset_ += size;
-  return page_ + offset_ - size;
+  // First fit
+  GapList::Item* head = gaps_.head();
+  while (head->value()->size < size) head = head->next();
+
+  Gap* gap = head->value();
+  char* result = page_ + gap->offset;
+  gap->offset += size;
+  gap->size -= size;
+  if (gap->size == 0) gaps_.Remove(head);
+
+  used_ += size;
+
+  return result;
 }
 
 
-void CodePage::Ref() {
-  ref_++;
+void CodePage::Unprotect() {
+  if (writable_) return;
+  if (mprotect(page_, size_, PROT_READ | PROT_WRITE) != 0) abort();
+  writable_ = true;
 }
 
 
-void CodePage::Unref() {
-  ref_--;
-  assert(ref_ >= 0);
+void CodePage::Protect() {
+  if (!writable_) return;
+  if (mprotect(page_, size_, PROT_READ | PROT_EXEC) != 0) abort();
+  writable_ = false;
+}
+
+
+void CodePage::Free(char* addr, uint32_t size) {
+  uint32_t offset = addr - page_;
+  assert(offset + size <= size_);
+
+  // Trap on jumps into the freed code
+  memset(addr, 0xCC, size);
+  used_ -= size;
+
+  // Find first gap after the freed range
+  GapList::Item* next = gaps_.head();
+  while (next != NULL && next->value()->offset < offset) next = next->next();
+  GapList::Item* prev = next == NULL ? gaps_.tail() : next->prev();
+
+  bool merge_prev = prev != NULL &&
+                    prev->value()->offset + prev->value()->size == offset;
+  bool merge_next = next != NULL && offset + size == next->value()->offset;
+
+  if (merge_prev && merge_next) {
+    prev->value()->size += size + next->value()->size;
+    gaps_.Remove(next);
+  } else if (merge_prev) {
+    prev->value()->size += size;
+  } else if (merge_next) {
+    next->value()->offset = offset;
+    next->value()->size += size;
+  } else if (next == NULL) {
+    gaps_.Push(new Gap(offset, size));
+  } else if (prev == NULL) {
+    gaps_.Unshift(new Gap(offset, size));
+  } else {
+    gaps_.InsertBefore(next, new Gap(offset, size));
+  }
 }
 
 
 CodeChunk::CodeChunk(const char* filename, const char* source, uint32_t length)
-    : source_len_(length), page_(NULL), ref_(1) {
+    : source_len_(length),
+      addr_(NULL),
+      ref_(1),
+      marked_(false),
+      stub_(false),
+      zone_(NULL),
+      ast_(NULL),
+      literals_(NULL) {
   int filename_len = strlen(filename) + 1;
 
   filename_ = new char[filename_len];
@@ -305,9 +857,62 @@ CodeChunk::CodeChunk(const char* filename, const char* source, uint32_t length)
 
 
 CodeChunk::~CodeChunk() {
+  FreeAst();
   delete[] filename_;
   delete[] source_;
-  page_->Unref();
+}
+
+
+void CodeChunk::FreeAst() {
+  if (zone_ == NULL) return;
+
+  // Zone's objects need no destruction, zone itself should be current one
+  delete literals_;
+  zone_->Enter();
+  delete zone_;
+
+  zone_ = NULL;
+  ast_ = NULL;
+  literals_ = NULL;
+}
+
+
+CodeProfile::CodeProfile(CodeChunk* chunk)
+    : counter_(CodeSpace::tier_up_threshold()),
+      chunk_(chunk),
+      fn_(NULL),
+      entry_(NULL),
+      code_(NULL),
+      osr_code_(NULL),
+      osr_loop_(-1),
+      version_(0),
+      code_version_(0),
+      osr_version_(0),
+      prologue_size_(0),
+      deopts_(0) {
+}
+
+
+CodeProfile::~CodeProfile() {
+}
+
+
+TypeFeedback* CodeProfile::GetFeedback(int id) {
+  TypeFeedback* feedback = feedback_.Get(NumberKey::New(id));
+  if (feedback != NULL) return feedback;
+
+  feedback = new TypeFeedback(id);
+  feedback_.Set(NumberKey::New(id), feedback);
+
+  return feedback;
+}
+
+
+int CodeProfile::FeedbackKinds(int id) {
+  TypeFeedback* feedback = feedback_.Get(NumberKey::New(id));
+  if (feedback == NULL) return TypeFeedback::kNone;
+
+  return feedback->kinds();
 }
 
 
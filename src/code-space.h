@@ -24,6 +24,8 @@
 #define _SRC_CODE_SPACE_H_
 
 #include "utils.h"  // List
+#include "splay-tree.h"  // SplayTree
+#include "root.h"  // Root
 
 namespace candor {
 
@@ -38,12 +40,25 @@ class Heap;
 class Masm;
 class Stubs;
 class CodePage;
+class CodeBlock;
 class CodeChunk;
+class CodeProfile;
+class TypeFeedback;
 class Code;
+class FunctionLiteral;
+class AstNode;
 class PIC;
+class CompileQueue;
+class CompileTask;
+class Zone;
 
 typedef List<CodePage*, EmptyClass> CodePageList;
 typedef List<CodeChunk*, EmptyClass> CodeChunkList;
+typedef List<CodeProfile*, EmptyClass> CodeProfileList;
+typedef List<CodeBlock*, EmptyClass> CodeBlockList;
+typedef List<PIC*, EmptyClass> PICList;
+typedef SplayTree<NumberKey, CodeBlock, NopPolicy, EmptyClass> CodeBlockTree;
+typedef HashMap<NumberKey, TypeFeedback, EmptyClass> TypeFeedbackMap;
 
 class CodeSpace {
  public:
@@ -52,6 +67,29 @@ class CodeSpace {
   explicit CodeSpace(Heap* heap);
   ~CodeSpace();
 
+  // Pages are never writable and executable at the same time. Code may be
+  // written only within the scope, pages made writable by the nested scopes
+  // are flipped back to executable at once, when the outermost one ends
+  class WriteScope {
+   public:
+    explicit WriteScope(CodeSpace* space);
+    ~WriteScope();
+
+   private:
+    CodeSpace* space_;
+  };
+
+  // Makes pages with the code in [addr, addr + size) writable
+  void Unprotect(char* addr, uint32_t size);
+
+  // Marks chunk owning the code at `addr` as used, `addr` may point anywhere
+  // (or nowhere) in the code space, i.e. it may be a return address found
+  // in the frame (see GC)
+  void Mark(char* addr);
+
+  // Frees code of the chunks that weren't marked since the last collection
+  // and aren't referenced from C++ (see CodeChunk::Ref()), called by the GC
+  // after marking all reachable functions and frames
   void CollectGarbage();
 
   Error* CreateError(CodeChunk* chunk, const char* message, uint32_t offset);
@@ -61,25 +99,118 @@ class CodeSpace {
                          uint32_t length);
   char* CreatePIC();
 
+  // Code is put into the free space of existing pages and is owned by
+  // the `owner` chunk, until the chunk is collected
   void Put(CodeChunk* chunk, Masm* masm);
+
+  // Stubs are called from all code, they're kept together in their own pages
+  void PutStub(CodeChunk* chunk, Masm* masm);
+  char* Put(Masm* masm, CodeChunk* owner);
+
+  // Copies already relocated code into code space
+  char* Put(const char* code, uint32_t length, CodeChunk* owner);
   char* Compile(const char* filename,
                 const char* source,
                 uint32_t length,
                 char** root,
                 Error** error);
 
+  // Parses source on the compiler thread pool, the code is generated on the
+  // isolate's thread by FinishCompile() (that waits for the parser if needed)
+  CompileTask* CompileAsync(const char* filename,
+                            const char* source,
+                            uint32_t length);
+  char* FinishCompile(CompileTask* task, char** root, Error** error);
+
+  // Parses chunk's source and analyzes scopes. Doesn't touch the heap or the
+  // code space, so it may run on the compiler thread (see CompileTask).
+  AstNode* Parse(CodeChunk* chunk, Error** error);
+
+  // Generates baseline code of the parsed source
+  char* Install(CodeChunk* chunk, AstNode* ast, char** root);
+
+  // Generates baseline code for the function on its first call, returns
+  // false (leaving the trampoline in place) if the code would need constants
+  // that aren't in the root context
+  bool CompileLazy(CodeProfile* profile, char* root);
+
+  // Recompiles hot function with HIR/LIR and redirects its baseline
+  // code to the result, returns NULL if function can't be optimized
+  char* Optimize(CodeProfile* profile, char* root);
+
+  // Restores baseline code of the function after failed speculation in the
+  // optimized one, function will be reoptimized with updated type feedback.
+  // Failures in the older code (with other `version`) are ignored.
+  void Deoptimize(CodeProfile* profile, int version);
+
+  // Compiles function's code that is entered from the baseline frame at the
+  // head of the hot loop (on-stack replacement), returns NULL on failure
+  char* CompileOSR(CodeProfile* profile, int loop, char* root);
+
   Value* Run(char* fn, uint32_t argc, Value* argv[]);
 
   inline Heap* heap() { return heap_; }
   inline Stubs* stubs() { return stubs_; }
+  CompileQueue* compile_queue();
+
+  // Sizes of the mapped pages and of the code in them
+  inline int chunk_count() { return chunks_.length(); }
+  inline int page_count() { return pages_.length(); }
+  uint32_t size();
+  uint32_t used();
+
+  // Number of calls and loop iterations in baseline code of the function
+  // before it'll be optimized
+  static inline int tier_up_threshold() { return tier_up_threshold_; }
+  static inline void tier_up_threshold(int threshold) {
+    tier_up_threshold_ = threshold;
+  }
+
+  static const int kDefaultTierUpThreshold = 1000;
+
+  // Functions deoptimized that many times are left in the baseline code
+  static const int kMaxDeopts = 4;
 
  private:
+  static int tier_up_threshold_;
+
+  // Returns function's AST. Chunk's source is parsed only once (on the first
+  // lazy compilation of its functions if its code was loaded from the cache),
+  // then the AST is shared by all compilations of chunk's functions.
+  FunctionLiteral* GetAst(CodeProfile* profile, char* root);
+
+  // Keeps AST (allocated in chunk's zone) in the chunk, labels of its
+  // functions point to their entries from now on
+  void Attach(CodeChunk* chunk, AstNode* ast, char* root);
+
+  // Builds HIR/LIR code of the function (entered at the loop with AST id
+  // `osr_loop`, if it isn't -1)
+  char* Generate(CodeProfile* profile, int osr_loop, char* root);
+  // Overwrites code at `from` with a jump to `to`, saving the original
+  // bytes into `backup` (if not NULL). Returns size of the patch.
+  int Redirect(char* from, char* to, char* backup);
+
+  // Releases chunk's code and PICs called by it
+  void Free(CodeChunk* chunk);
+
+  // Makes all writable pages executable again
+  void Protect();
+
   Heap* heap_;
   Stubs* stubs_;
+  CompileQueue* compile_queue_;
   char* entry_;
   CodePageList pages_;
-  List<PIC*, EmptyClass> pics_;
   CodeChunkList chunks_;
+
+  // Code blocks by their addresses
+  CodeBlockTree blocks_;
+
+  // PICs created for the code that is being generated
+  PICList pics_;
+
+  // Depth of the nested WriteScopes
+  int write_depth_;
 };
 
 class CodePage {
@@ -89,26 +220,84 @@ class CodePage {
 
   bool Has(uint32_t size);
   char* Allocate(uint32_t size);
+  void Free(char* addr, uint32_t size);
 
-  void Ref();
-  void Unref();
+  // Switch page between writable and executable states, page is executable
+  // after creation
+  void Unprotect();
+  void Protect();
+
+  inline bool Contains(char* addr) {
+    return addr >= page_ && addr < page_ + size_;
+  }
+
+  inline bool writable() { return writable_; }
+  inline bool stubs() { return stubs_; }
+  inline uint32_t size() { return size_; }
+  inline uint32_t used() { return used_; }
+
+  // Pages are shared by the chunks, small ones would be hardly reused
+  static const uint32_t kMinSize = 64 * 1024;
 
  private:
-  uint32_t offset_;
+  // Unused range of the page
+  class Gap {
+   public:
+    Gap(uint32_t offset, uint32_t size) : offset(offset), size(size) {
+    }
+
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  typedef List<Gap*, EmptyClass> GapList;
+
   uint32_t size_;
+  uint32_t used_;
   uint32_t guard_size_;
-  int ref_;
   char* page_;
   char* guard_;
+  bool writable_;
+
+  // Page contains only stubs
+  bool stubs_;
+
+  // Sorted by offset, adjacent gaps are merged
+  GapList gaps_;
 
   friend class CodeSpace;
 };
 
+// Code put into the page
+class CodeBlock {
+ public:
+  CodeBlock(CodePage* page, CodeChunk* chunk, char* addr, uint32_t size)
+      : page_(page), chunk_(chunk), addr_(addr), size_(size) {
+  }
+
+  inline bool Contains(char* addr) {
+    return addr >= addr_ && addr < addr_ + size_;
+  }
+
+  inline CodePage* page() { return page_; }
+  inline CodeChunk* chunk() { return chunk_; }
+  inline char* addr() { return addr_; }
+  inline uint32_t size() { return size_; }
+
+ private:
+  CodePage* page_;
+  CodeChunk* chunk_;
+  char* addr_;
+  uint32_t size_;
+};
+
 class CodeChunk {
  public:
   CodeChunk(const char* filename, const char* source, uint32_t length);
   ~CodeChunk();
 
+  // Referenced chunks are never collected (i.e. stubs, PICs or sources
+  // that are being compiled), others live while their code is reachable
   void Ref();
   void Unref();
 
@@ -116,16 +305,131 @@ class CodeChunk {
   inline const char* source() { return source_; }
   inline uint32_t source_len() { return source_len_; }
   inline char* addr() { return addr_; }
+  inline CodeProfileList* profiles() { return &profiles_; }
+
+  // Releases parsed source (see CodeSpace::GetAst)
+  void FreeAst();
 
  private:
   char* filename_;
   char* source_;
   uint32_t source_len_;
-  CodePage* page_;
   char* addr_;
   int ref_;
 
+  // Set by the GC if chunk's code is reachable
+  bool marked_;
+
+  // Chunk contains stub (see CodeSpace::PutStub)
+  bool stub_;
+
+  // One for each function, in FunctionIterator's order
+  CodeProfileList profiles_;
+
+  // Top-level, lazily compiled and optimized code
+  CodeBlockList blocks_;
+
+  // Parsed source and root slots of its literals, allocated in chunk's own
+  // zone (see CodeSpace::GetAst)
+  Zone* zone_;
+  AstNode* ast_;
+  Root::SlotMap* literals_;
+
+  friend class CodeSpace;
+  friend class CodeCache;
+};
+
+// Kinds of operands seen by the baseline code at a single arithmetic site,
+// HIR speculates on them when optimizing function (see HIRBinOp::feedback())
+class TypeFeedback {
+ public:
+  enum Kind {
+    kNone = 0,
+    kSmi = 1,
+    kNumber = 2,
+    kAny = 4
+  };
+
+  explicit TypeFeedback(int id) : kinds_(kNone), id_(id) {
+  }
+
+  inline int kinds() { return static_cast<int>(kinds_); }
+  inline int id() { return id_; }
+
+  static const int kKindsOffset = 0;
+
+ private:
+  // Should be the first field (see kKindsOffset)
+  intptr_t kinds_;
+
+  // AST id of the site
+  int id_;
+};
+
+// Hotness counter of function's baseline (Fullgen) code, decremented on
+// every call and loop iteration. Once it drops below zero function is
+// recompiled by HIR/LIR.
+class CodeProfile {
+ public:
+  explicit CodeProfile(CodeChunk* chunk);
+  ~CodeProfile();
+
+  // Never try optimizing function again
+  inline void Disable() { counter_ = kDisabled; }
+
+  // Returns feedback of the site, creating it if needed
+  TypeFeedback* GetFeedback(int id);
+
+  // Kinds of operands seen at the site so far
+  int FeedbackKinds(int id);
+
+  inline CodeChunk* chunk() { return chunk_; }
+  inline char* entry() { return entry_; }
+  inline char* code() { return code_; }
+  inline int deopts() { return deopts_; }
+  inline int version() { return version_; }
+
+  static const int kCounterOffset = 0;
+  static const intptr_t kDisabled = 0x3fffffff;
+  static const int kMaxPrologueSize = 16;
+
+ private:
+  // Should be the first field (see kCounterOffset)
+  intptr_t counter_;
+
+  CodeChunk* chunk_;
+
+  // Function in chunk's AST (NULL until the chunk is parsed)
+  FunctionLiteral* fn_;
+
+  // Baseline (or lazy trampoline) and optimized code
+  char* entry_;
+  char* code_;
+
+  // Code entered from the baseline frame in the loop with AST id `osr_loop_`
+  char* osr_code_;
+  int osr_loop_;
+
+  // Every optimized code gets its own version, frames of the replaced code
+  // may still fail their guards (0 - no code)
+  int version_;
+  int code_version_;
+  int osr_version_;
+
+  // PICs called by the optimized code
+  PICList pics_;
+
+  // Baseline prologue overwritten by the jump to the optimized code
+  char prologue_[kMaxPrologueSize];
+  int prologue_size_;
+
+  int deopts_;
+
+  // Site's AST id => feedback
+  TypeFeedbackMap feedback_;
+
   friend class CodeSpace;
+  friend class CodeCache;
 };
 }  // internal
 }  // candor
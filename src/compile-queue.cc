@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "compile-queue.h"
+
+#include <assert.h>  // assert
+#include <stdlib.h>  // NULL
+#include <unistd.h>  // sysconf
+
+#include "code-space.h"  // CodeSpace
+#include "zone.h"  // Zone
+
+namespace candor {
+namespace internal {
+
+CompileTask::CompileTask(CodeSpace* space, CodeChunk* chunk)
+    : space_(space),
+      chunk_(chunk),
+      zone_(NULL),
+      ast_(NULL),
+      error_(NULL),
+      done_(false) {
+}
+
+
+CompileTask::~CompileTask() {
+  if (zone_ == NULL) return;
+
+  // Zone should be the current one on this thread
+  zone_->Enter();
+  delete zone_;
+}
+
+
+void CompileTask::Run() {
+  zone_ = new Zone();
+
+  ast_ = space_->Parse(chunk_, &error_);
+
+  // Keep AST, but let the thread run other tasks
+  zone_->Leave();
+}
+
+
+CompileQueue::CompileQueue(int threads) : thread_count_(0), stopped_(false) {
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&pending_cond_, NULL);
+  pthread_cond_init(&done_cond_, NULL);
+
+  if (threads > kMaxThreads) threads = kMaxThreads;
+  for (int i = 0; i < threads; i++) {
+    if (pthread_create(&threads_[thread_count_], NULL, Loop, this) != 0) {
+      break;
+    }
+    thread_count_++;
+  }
+  assert(thread_count_ > 0);
+}
+
+
+CompileQueue::~CompileQueue() {
+  pthread_mutex_lock(&mutex_);
+  stopped_ = true;
+  pthread_cond_broadcast(&pending_cond_);
+  pthread_mutex_unlock(&mutex_);
+
+  for (int i = 0; i < thread_count_; i++) {
+    pthread_join(threads_[i], NULL);
+  }
+
+  pthread_cond_destroy(&done_cond_);
+  pthread_cond_destroy(&pending_cond_);
+  pthread_mutex_destroy(&mutex_);
+}
+
+
+void CompileQueue::Push(CompileTask* task) {
+  pthread_mutex_lock(&mutex_);
+  tasks_.Push(task);
+  pthread_cond_signal(&pending_cond_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+
+void CompileQueue::Wait(CompileTask* task) {
+  pthread_mutex_lock(&mutex_);
+  while (!task->done_) pthread_cond_wait(&done_cond_, &mutex_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+
+bool CompileQueue::IsDone(CompileTask* task) {
+  pthread_mutex_lock(&mutex_);
+  bool done = task->done_;
+  pthread_mutex_unlock(&mutex_);
+
+  return done;
+}
+
+
+int CompileQueue::DefaultThreadCount() {
+  int cpus = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+  if (cpus < 1) return 1;
+  if (cpus > kMaxThreads) return kMaxThreads;
+
+  return cpus;
+}
+
+
+CompileTask* CompileQueue::Shift() {
+  pthread_mutex_lock(&mutex_);
+  while (!stopped_ && tasks_.length() == 0) {
+    pthread_cond_wait(&pending_cond_, &mutex_);
+  }
+  CompileTask* task = stopped_ ? NULL : tasks_.Shift();
+  pthread_mutex_unlock(&mutex_);
+
+  return task;
+}
+
+
+void* CompileQueue::Loop(void* arg) {
+  CompileQueue* queue = reinterpret_cast<CompileQueue*>(arg);
+
+  CompileTask* task;
+  while ((task = queue->Shift()) != NULL) {
+    task->Run();
+
+    pthread_mutex_lock(&queue->mutex_);
+    task->done_ = true;
+    pthread_cond_broadcast(&queue->done_cond_);
+    pthread_mutex_unlock(&queue->mutex_);
+  }
+
+  return NULL;
+}
+
+}  // namespace internal
+}  // namespace candor
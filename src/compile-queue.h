@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_COMPILE_QUEUE_H_
+#define _SRC_COMPILE_QUEUE_H_
+
+#include <pthread.h>  // pthread_t, pthread_mutex_t, pthread_cond_t
+
+#include "utils.h"  // GenericList
+
+namespace candor {
+
+// Forward declaration
+struct Error;
+
+namespace internal {
+
+// Forward declarations
+class CodeSpace;
+class CodeChunk;
+class AstNode;
+class Zone;
+
+// Source that is parsed on the compiler thread, its AST lives in task's own
+// zone until the code is generated on the isolate's thread
+// (see CodeSpace::FinishCompile)
+class CompileTask {
+ public:
+  CompileTask(CodeSpace* space, CodeChunk* chunk);
+  ~CompileTask();
+
+  // Runs on the compiler thread
+  void Run();
+
+  inline CodeSpace* space() { return space_; }
+  inline CodeChunk* chunk() { return chunk_; }
+  inline Zone* zone() { return zone_; }
+
+  // Chunk keeps AST after generating its code (see CodeSpace::FinishCompile)
+  inline Zone* ReleaseZone() {
+    Zone* zone = zone_;
+    zone_ = NULL;
+    return zone;
+  }
+  inline AstNode* ast() { return ast_; }
+  inline Error* error() { return error_; }
+
+ private:
+  CodeSpace* space_;
+  CodeChunk* chunk_;
+  Zone* zone_;
+  AstNode* ast_;
+  Error* error_;
+
+  // Guarded by queue's mutex
+  bool done_;
+
+  friend class CompileQueue;
+};
+
+typedef GenericList<CompileTask*, EmptyClass, NopPolicy> CompileTaskList;
+
+// Pool of compiler threads that run tasks in the order of pushing
+class CompileQueue {
+ public:
+  explicit CompileQueue(int threads);
+  ~CompileQueue();
+
+  void Push(CompileTask* task);
+
+  // Blocks until task is done
+  void Wait(CompileTask* task);
+  bool IsDone(CompileTask* task);
+
+  // One thread per spare CPU core
+  static int DefaultThreadCount();
+
+  static const int kMaxThreads = 4;
+
+ private:
+  static void* Loop(void* arg);
+
+  // Blocks until there's a task to run, returns NULL if queue was stopped
+  CompileTask* Shift();
+
+  pthread_t threads_[kMaxThreads];
+  int thread_count_;
+
+  pthread_mutex_t mutex_;
+  pthread_cond_t pending_cond_;
+  pthread_cond_t done_cond_;
+
+  CompileTaskList tasks_;
+  bool stopped_;
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_COMPILE_QUEUE_H_
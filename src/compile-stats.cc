@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "compile-stats.h"
+
+#include <pthread.h>  // pthread_mutex_t
+#include <string.h>  // memset
+#include <sys/time.h>  // gettimeofday
+
+namespace candor {
+namespace internal {
+
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+bool CompileStats::enabled_ = false;
+int64_t CompileStats::phases_[kPhaseCount];
+int64_t CompileStats::counters_[kCounterCount];
+
+CompileStats::Timer::Timer(Phase phase) : phase_(phase), start_(0) {
+  if (enabled()) start_ = Now();
+}
+
+
+CompileStats::Timer::~Timer() {
+  Switch(phase_);
+}
+
+
+void CompileStats::Timer::Switch(Phase phase) {
+  if (enabled()) {
+    int64_t now = Now();
+
+    pthread_mutex_lock(&stats_mutex);
+    // Stats could be enabled in the middle of the phase
+    if (start_ != 0) phases_[phase_] += now - start_;
+    pthread_mutex_unlock(&stats_mutex);
+
+    start_ = now;
+  }
+  phase_ = phase;
+}
+
+
+void CompileStats::Enable() {
+  enabled_ = true;
+}
+
+
+void CompileStats::Disable() {
+  enabled_ = false;
+}
+
+
+void CompileStats::Reset() {
+  pthread_mutex_lock(&stats_mutex);
+  memset(phases_, 0, sizeof(phases_));
+  memset(counters_, 0, sizeof(counters_));
+  pthread_mutex_unlock(&stats_mutex);
+}
+
+
+void CompileStats::Count(Counter counter, int64_t value) {
+  if (!enabled()) return;
+
+  pthread_mutex_lock(&stats_mutex);
+  counters_[counter] += value;
+  pthread_mutex_unlock(&stats_mutex);
+}
+
+
+double CompileStats::PhaseTime(Phase phase) {
+  pthread_mutex_lock(&stats_mutex);
+  int64_t value = phases_[phase];
+  pthread_mutex_unlock(&stats_mutex);
+
+  return value * 1e-6;
+}
+
+
+int64_t CompileStats::CounterValue(Counter counter) {
+  pthread_mutex_lock(&stats_mutex);
+  int64_t value = counters_[counter];
+  pthread_mutex_unlock(&stats_mutex);
+
+  return value;
+}
+
+
+const char* CompileStats::PhaseName(Phase phase) {
+  switch (phase) {
+#define COMPILE_STATS_NAME(name, key) case k##name: return #key;
+    COMPILE_PHASES_ENUM(COMPILE_STATS_NAME)
+#undef COMPILE_STATS_NAME
+    default: return NULL;
+  }
+}
+
+
+const char* CompileStats::CounterName(Counter counter) {
+  switch (counter) {
+#define COMPILE_STATS_NAME(name, key) case k##name: return #key;
+    COMPILE_COUNTERS_ENUM(COMPILE_STATS_NAME)
+#undef COMPILE_STATS_NAME
+    default: return NULL;
+  }
+}
+
+
+void CompileStats::Print(FILE* out) {
+  double total = 0;
+
+  fprintf(out, "## Compile stats ##\n");
+  for (int i = 0; i < kPhaseCount; i++) {
+    Phase phase = static_cast<Phase>(i);
+    total += PhaseTime(phase);
+    fprintf(out, "%-24s %10.3f ms\n", PhaseName(phase), PhaseTime(phase) * 1e3);
+  }
+  fprintf(out, "%-24s %10.3f ms\n", "total", total * 1e3);
+
+  for (int i = 0; i < kCounterCount; i++) {
+    Counter counter = static_cast<Counter>(i);
+    fprintf(out,
+            "%-24s %10lld\n",
+            CounterName(counter),
+            static_cast<long long>(CounterValue(counter)));
+  }
+}
+
+
+int64_t CompileStats::Now() {
+  timeval tv;
+  gettimeofday(&tv, NULL);
+
+  return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+}  // namespace internal
+}  // namespace candor
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_COMPILE_STATS_H_
+#define _SRC_COMPILE_STATS_H_
+
+#include <stdint.h>  // int64_t
+#include <stdio.h>  // FILE
+
+namespace candor {
+namespace internal {
+
+#define COMPILE_PHASES_ENUM(V) \
+    V(Parse, parse) \
+    V(ScopeAnalyze, scope_analyze) \
+    V(Fullgen, fullgen) \
+    V(HIRBuild, hir_build) \
+    V(PropagateConstants, propagate_constants) \
+    V(FindReachableBlocks, find_reachable_blocks) \
+    V(DeriveDominators, derive_dominators) \
+    V(PrunePhis, prune_phis) \
+    V(ScalarReplacement, scalar_replacement) \
+    V(FindEffects, find_effects) \
+    V(EliminateDeadCode, eliminate_dead_code) \
+    V(GlobalValueNumbering, global_value_numbering) \
+    V(FindRanges, find_ranges) \
+    V(UnpinContextLoads, unpin_context_loads) \
+    V(GlobalCodeMotion, global_code_motion) \
+    V(LIRBuild, lir_build) \
+    V(Liveness, liveness) \
+    V(BuildIntervals, build_intervals) \
+    V(RegisterAllocation, register_allocation) \
+    V(ResolveDataFlow, resolve_data_flow) \
+    V(AllocateSpills, allocate_spills) \
+    V(Codegen, codegen) \
+    V(Relocation, relocation) \
+    V(CodeCache, code_cache)
+
+#define COMPILE_COUNTERS_ENUM(V) \
+    V(BaselineFunctions, baseline_functions) \
+    V(OptimizedFunctions, optimized_functions) \
+    V(HIRBlocks, hir_blocks) \
+    V(HIRInstructions, hir_instructions) \
+    V(LIRInstructions, lir_instructions) \
+    V(Intervals, intervals) \
+    V(LivenessBytes, liveness_bytes) \
+    V(Spills, spills) \
+    V(CodeBytes, code_bytes) \
+    V(CodeCacheHits, code_cache_hits)
+
+// Time spent in the compiler's phases and sizes of the compiled code,
+// collected only while enabled (see Isolate::EnableCompileStats).
+// Parsing runs on the compiler threads too, so updates are serialized.
+class CompileStats {
+ public:
+#define COMPILE_STATS_KIND(name, key) k##name,
+  enum Phase {
+    COMPILE_PHASES_ENUM(COMPILE_STATS_KIND)
+    kPhaseCount
+  };
+
+  enum Counter {
+    COMPILE_COUNTERS_ENUM(COMPILE_STATS_KIND)
+    kCounterCount
+  };
+#undef COMPILE_STATS_KIND
+
+  // Accounts time between construction and destruction to the phase,
+  // Switch() moves accounting to the next phase of the same pipeline
+  class Timer {
+   public:
+    explicit Timer(Phase phase);
+    ~Timer();
+
+    void Switch(Phase phase);
+
+   private:
+    Phase phase_;
+    int64_t start_;
+  };
+
+  static inline bool enabled() { return enabled_; }
+  static void Enable();
+  static void Disable();
+  static void Reset();
+
+  static void Count(Counter counter, int64_t value);
+
+  // Time in seconds
+  static double PhaseTime(Phase phase);
+  static int64_t CounterValue(Counter counter);
+  static const char* PhaseName(Phase phase);
+  static const char* CounterName(Counter counter);
+
+  static void Print(FILE* out);
+
+ private:
+  static int64_t Now();
+
+  static bool enabled_;
+  static int64_t phases_[kPhaseCount];
+  static int64_t counters_[kCounterCount];
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_COMPILE_STATS_H_
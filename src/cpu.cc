@@ -49,13 +49,17 @@ void CPU::Probe() {
 
   CodePage page(a.length());
   char* code = page.Allocate(a.length());
+  page.Unprotect();
   memcpy(code, a.buffer(), a.length());
   a.Relocate(NULL, code);
+  page.Protect();
 
-  int32_t features = reinterpret_cast<intptr_t>(
+  // Lower half: CPUID(1).ecx, upper half: CPUID(7).ebx (x64 only)
+  uint64_t features = reinterpret_cast<intptr_t>(
       reinterpret_cast<CPUProbeCallback>(code)());
 
   cpu_features_.SSE4_1 = (features & (1 << 19)) != 0;
+  cpu_features_.AVX2 = ((features >> 32) & (1 << 5)) != 0;
   probed_ = true;
 }
 }  // internal
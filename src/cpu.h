@@ -30,6 +30,7 @@ class CPU {
  public:
   struct CPUFeatures {
     bool SSE4_1;
+    bool AVX2;
   };
 
   static CPUFeatures cpu_features_;
@@ -40,6 +41,11 @@ class CPU {
     if (!probed_) Probe();
     return cpu_features_.SSE4_1;
   }
+
+  static inline bool HasAVX2() {
+    if (!probed_) Probe();
+    return cpu_features_.AVX2;
+  }
 };
 
 }  // namespace internal
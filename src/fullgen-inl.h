@@ -143,6 +143,16 @@ inline SourceMap* Fullgen::source_map() {
 }
 
 
+inline CodeProfile* Fullgen::profile() {
+  return profile_;
+}
+
+
+inline void Fullgen::profile(CodeProfile* profile) {
+  profile_ = profile;
+}
+
+
 inline void Fullgen::Print(char* out, int32_t size) {
   PrintBuffer p(out, size);
   Print(&p);
@@ -34,6 +34,8 @@ namespace internal {
 // Forward declarations
 class Fullgen;
 class ScopeSlot;
+class CodeProfile;
+class TypeFeedback;
 class FInstruction;
 
 typedef ZoneList<FInstruction*> FInstructionList;
@@ -74,6 +76,8 @@ typedef ZoneList<FInstruction*> FInstructionList;
     V(AlignStack) \
     V(CollectGarbage) \
     V(GetStackTrace) \
+    V(Profile) \
+    V(CompileLazy) \
     V(Call)
 
 #define FULLGEN_INSTRUCTION_ENUM(V) \
@@ -137,15 +141,18 @@ class FNil : public FInstruction {
 
 class FLabel : public FInstruction {
  public:
-  FLabel() : FInstruction(kLabel), label(new Label()) {
+  FLabel() : FInstruction(kLabel), label(new Label()), loop(false) {
   }
 
-  explicit FLabel(Label* l) : FInstruction(kLabel), label(l) {
+  explicit FLabel(Label* l) : FInstruction(kLabel), label(l), loop(false) {
   }
 
   FULLGEN_DEFAULT_METHODS(Label)
 
   Label* label;
+
+  // Start of the loop's condition, target of its back edge
+  bool loop;
 };
 
 class FEntry : public FInstruction {
@@ -207,14 +214,18 @@ class FLiteral : public FInstruction {
 
 class FBinOp : public FInstruction {
  public:
-  explicit FBinOp(BinOp::BinOpType sub_type) : FInstruction(kBinOp),
-                                               sub_type_(sub_type) {
+  explicit FBinOp(BinOp::BinOpType sub_type,
+                  TypeFeedback* feedback = NULL)
+      : FInstruction(kBinOp),
+        sub_type_(sub_type),
+        feedback_(feedback) {
   }
 
   FULLGEN_DEFAULT_METHODS(BinOp)
 
  protected:
   BinOp::BinOpType sub_type_;
+  TypeFeedback* feedback_;
 };
 
 class FNot : public FInstruction {
@@ -460,12 +471,48 @@ class FGetStackTrace : public FInstruction {
   FULLGEN_DEFAULT_METHODS(GetStackTrace)
 };
 
+class FProfile : public FInstruction {
+ public:
+  FProfile(CodeProfile* profile, bool entry, int osr_loop = -1)
+      : FInstruction(kProfile),
+        profile_(profile),
+        entry_(entry),
+        osr_loop_(osr_loop) {
+  }
+
+  FULLGEN_DEFAULT_METHODS(Profile)
+
+ protected:
+  CodeProfile* profile_;
+
+  // Function's prologue (may tier up), otherwise loop's head (only counts)
+  bool entry_;
+
+  // AST id of the loop that may be replaced on stack, -1 if it can't be
+  int osr_loop_;
+};
+
+class FCompileLazy : public FInstruction {
+ public:
+  explicit FCompileLazy(CodeProfile* profile) : FInstruction(kCompileLazy),
+                                                profile_(profile) {
+  }
+
+  FULLGEN_DEFAULT_METHODS(CompileLazy)
+
+ protected:
+  CodeProfile* profile_;
+};
+
 class FCall : public FInstruction {
  public:
-  FCall() : FInstruction(kCall) {
+  FCall() : FInstruction(kCall), tail(false) {
   }
 
   FULLGEN_DEFAULT_METHODS(Call)
+
+  // Result is returned right away, callee may reuse the frame
+  bool tail;
 };
 
 #undef FULLGEN_DEFAULT_METHODS
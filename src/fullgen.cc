@@ -28,6 +28,7 @@
 #include "heap-inl.h"
 #include "scope.h"  // ScopeSlot
 #include "macroassembler.h"
+#include "code-space.h"  // CodeProfile
 
 namespace candor {
 namespace internal {
@@ -43,7 +44,8 @@ Fullgen::Fullgen(Heap* heap, Root* root, const char* filename)
       current_function_(NULL),
       loop_start_(NULL),
       loop_end_(NULL),
-      source_map_(heap->source_map()) {
+      source_map_(heap->source_map()),
+      profile_(NULL) {
 }
 
 
@@ -80,6 +82,20 @@ void Fullgen::Build(AstNode* ast) {
 }
 
 
+void Fullgen::BuildLazy(AstNode* ast) {
+  FunctionLiteral* fn = FunctionLiteral::Cast(ast);
+  assert(profile() != NULL);
+
+  if (fn->label() == NULL) {
+    fn->label(new Label());
+  }
+
+  Add(new FLabel(fn->label()));
+  Add(new FCompileLazy(profile()));
+  Add(new FAlignCode());
+}
+
+
 void Fullgen::Generate(Masm* masm) {
   FInstructionList::Item* ihead = instructions_.head();
   for (; ihead != NULL; ihead = ihead->next()) {
@@ -91,9 +107,22 @@ void Fullgen::Generate(Masm* masm) {
       masm->stack_slots(FEntry::Cast(instr)->stack_slots() + 1);
     }
 
+    // Back edges jump to the aligned loop header
+    if (instr->type() == FInstruction::kLabel && FLabel::Cast(instr)->loop) {
+      masm->AlignLoop();
+    }
+
     // Amend source map
-    if (instr->ast() != NULL && instr->ast()->offset() >= 0) {
-      source_map()->Push(masm->offset(), instr->ast()->offset());
+    AstNode* ast = instr->ast();
+
+    // Attribute calls to the callee expression (as HIR does), so stack traces
+    // are the same whichever tier has produced the frame
+    if (ast != NULL && instr->type() == FInstruction::kCall &&
+        ast->is(AstNode::kCall)) {
+      ast = FunctionLiteral::Cast(ast)->variable();
+    }
+    if (ast != NULL && ast->offset() >= 0) {
+      source_map()->Push(masm->offset(), ast->offset());
     }
 
     // generate instruction itself
@@ -231,6 +260,7 @@ FInstruction* Fullgen::VisitFunction(AstNode* stmt) {
   if (current_function()->root_ast() == stmt) {
     current_function()->body = new FLabel(fn->label());
     Add(current_function()->body);
+    if (profile() != NULL) Add(new FProfile(profile(), true));
     current_function()->entry = new FEntry(stmt->context_slots());
     Add(current_function()->entry);
 
@@ -263,7 +293,9 @@ FInstruction* Fullgen::VisitFunction(AstNode* stmt) {
 
 FInstruction* Fullgen::VisitReturn(AstNode* node) {
   FScopedSlot result(this);
-  Visit(node->lhs())->SetResult(&result);
+  FInstruction* value = Visit(node->lhs());
+  if (value->type() == FInstruction::kCall) FCall::Cast(value)->tail = true;
+  value->SetResult(&result);
 
   return Add(new FReturn())->AddArg(&result);
 }
@@ -451,7 +483,22 @@ FInstruction* Fullgen::VisitWhile(AstNode* node) {
   FLabel* body = new FLabel();
   loop_end_ = new FLabel();
 
+  loop_start_->loop = true;
   Add(loop_start_);
+  if (profile() != NULL) {
+    // Only loops in the function's body can be entered by optimized code
+    // (see HIRGen::VisitFunction)
+    int osr_loop = -1;
+    AstList::Item* head = current_function()->root_ast()->children()->head();
+    for (; head != NULL; head = head->next()) {
+      if (head->value() == node) {
+        osr_loop = node->id;
+        break;
+      }
+    }
+
+    Add(new FProfile(profile(), false, osr_loop));
+  }
   Visit(node->lhs())->SetResult(&cond);
   Add(new FIf(body, loop_end_))->AddArg(&cond);
 
@@ -563,6 +610,9 @@ FInstruction* Fullgen::VisitCall(AstNode* stmt) {
     stores_.Push(store);
   }
 
+  // Function should stay in its own slot, index computations below are
+  // using scoped slots that are released before the call
+  FScopedSlot var_slot(this);
   FInstruction* var;
   if (fn->args()->length() > 0 &&
       fn->args()->head()->value()->is(AstNode::kSelf)) {
@@ -577,6 +627,7 @@ FInstruction* Fullgen::VisitCall(AstNode* stmt) {
   } else {
     var = Visit(fn->variable());
   }
+  var->SetResult(&var_slot);
 
   // Add stack alignment instruction
   Add(new FAlignStack())->AddArg(&argc_slot);
@@ -646,9 +697,6 @@ FInstruction* Fullgen::VisitCall(AstNode* stmt) {
     Add(hhead->value());
   }
 
-  FScopedSlot var_slot(this);
-  var->SetResult(&var_slot);
-
   // Release slots used for arguments
   while (arg_slots.length() > 0) ReleaseSlot(arg_slots.Shift());
 
@@ -703,7 +751,7 @@ FInstruction* Fullgen::VisitUnOp(AstNode* node) {
     load = Visit(op->lhs())->SetResult(&load_slot);
     GetNumber(1)->SetResult(&one);
 
-    add = Add(new FBinOp(type));
+    add = Add(new FBinOp(type, GetFeedback(node, type)));
     add->AddArg(&load_slot)->AddArg(&one)->SetResult(&value);
 
     if (op->subtype() == UnOp::kPreInc || op->subtype() == UnOp::kPreDec) {
@@ -758,6 +806,16 @@ FInstruction* Fullgen::VisitUnOp(AstNode* node) {
 }
 
 
+TypeFeedback* Fullgen::GetFeedback(AstNode* site, BinOp::BinOpType type) {
+  // Only arithmetic is speculated on, nodes created by compiler have no id
+  if (profile() == NULL || site->id == -1 || !BinOp::is_math(type)) {
+    return NULL;
+  }
+
+  return profile()->GetFeedback(site->id);
+}
+
+
 FInstruction* Fullgen::VisitBinOp(AstNode* node) {
   BinOp* op = BinOp::Cast(node);
   FScopedSlot lhs(this);
@@ -767,7 +825,9 @@ FInstruction* Fullgen::VisitBinOp(AstNode* node) {
     FScopedSlot rhs(this);
     Visit(node->rhs())->SetResult(&rhs);
 
-    return Add(new FBinOp(op->subtype()))->AddArg(&lhs)->AddArg(&rhs);
+    return Add(new FBinOp(op->subtype(), GetFeedback(node, op->subtype())))
+        ->AddArg(&lhs)
+        ->AddArg(&rhs);
   } else {
     FScopedSlot result(this);
     FLabel* t = new FLabel();
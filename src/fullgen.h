@@ -38,6 +38,8 @@ namespace internal {
 // Forward declaration
 class Heap;
 class SourceMap;
+class CodeProfile;
+class TypeFeedback;
 class ScopeSlot;
 class Fullgen;
 class FInstruction;
@@ -109,6 +111,9 @@ class Fullgen : public Visitor<FInstruction> {
   void Build(AstNode* ast);
   void Generate(Masm* masm);
 
+  // Only a trampoline, that will compile function on the first call
+  void BuildLazy(AstNode* ast);
+
   FInstruction* Visit(AstNode* node);
   void VisitChildren(AstNode* node);
 
@@ -169,6 +174,12 @@ class Fullgen : public Visitor<FInstruction> {
   inline Root* root();
   inline SourceMap* source_map();
 
+  // If set - generated code will count calls and loop iterations, and
+  // record kinds of arithmetic operands
+  inline CodeProfile* profile();
+  inline void profile(CodeProfile* profile);
+  TypeFeedback* GetFeedback(AstNode* site, BinOp::BinOpType type);
+
  private:
   static bool log_;
 
@@ -187,6 +198,7 @@ class Fullgen : public Visitor<FInstruction> {
   FOperandList free_slots_;
 
   SourceMap* source_map_;
+  CodeProfile* profile_;
 
   friend class FScopedSlot;
 };
@@ -74,6 +74,9 @@ void GC::CollectGarbage(char* stack_top) {
   // Colour on-stack registers
   ColourFrames(stack_top);
 
+  // Weakly referenced values from the other space survive anyway
+  ColourWeakSurvivors();
+
   // Reset marks for items from external space
   while (black_items()->length() != 0) {
     GCValue* value = black_items()->Shift();
@@ -86,9 +89,15 @@ void GC::CollectGarbage(char* stack_top) {
   // Visit all weak references and call callbacks if some of them are dead
   HandleWeakReferences();
 
+  // Remove dead interned strings (weak callbacks may still use them)
+  heap()->string_table()->Sweep(this);
+
   space->Swap(tmp_space());
   delete tmp_space();
 
+  // Unreachable old space functions are dead now, free their code
+  if (IsMarkingCode()) heap()->code_space()->CollectGarbage();
+
   if (gc_type() != kNewSpace || heap()->needs_gc() == Heap::kGCNewSpace) {
     // Reset GC flag
     heap()->needs_gc(Heap::kGCNone);
@@ -132,7 +141,7 @@ void GC::RelocateWeakHandles() {
         v = new GCValue(ref->value(),
                         reinterpret_cast<char**>(ref->valueptr()));
         v->Relocate(v->value()->GetGCMark());
-      } else {
+      } else if (IsInCurrentSpace(ref->value())) {
         // Value was garbage collected - remove reference from the list
         heap()->references()->RemoveOne(item->key());
       }
@@ -141,6 +150,39 @@ void GC::RelocateWeakHandles() {
 }
 
 
+void GC::ColourWeakSurvivors() {
+  HValueRefMap::Item* ref = heap()->references()->head();
+  for (; ref != NULL; ref = ref->next_scalar()) {
+    if (ref->value()->is_weak()) ColourWeakSurvivor(ref->value()->value());
+  }
+
+  HValueWeakRefMap::Item* weak = heap()->weak_references()->head();
+  for (; weak != NULL; weak = weak->next_scalar()) {
+    ColourWeakSurvivor(weak->value()->value());
+  }
+
+  // Visiting survivors may append more prototypes to the list
+  GCList::Item* item = weak_items()->head();
+  for (; item != NULL; item = item->next()) {
+    ColourWeakSurvivor(item->value()->value());
+  }
+}
+
+
+void GC::ColourWeakSurvivor(HValue* value) {
+  char* addr = reinterpret_cast<char*>(value);
+
+  // Skip ICs zap values, everything unboxed and values that may be collected
+  if (addr == HNil::New() || HValue::IsUnboxed(addr)) return;
+  if (IsInCurrentSpace(value)) return;
+
+  // Value isn't moved, but everything it references (including code of the
+  // functions) should stay alive
+  push_grey(value, NULL);
+  ProcessGrey();
+}
+
+
 void GC::ColourFrames(char* stack_top) {
   // Go through the frames
   char** frame = reinterpret_cast<char**>(stack_top);
@@ -154,6 +196,10 @@ void GC::ColourFrames(char* stack_top) {
     if (frame == NULL) break;
 
     char* value = *frame;
+
+    // Return addresses and code of the OSR entries
+    if (IsMarkingCode()) heap()->code_space()->Mark(value);
+
     // Skip nil, non-pointer values and rbp pushes
     if (value != HNil::New() && !HValue::IsUnboxed(value)) {
       push_grey(HValue::Cast(value), frame);
@@ -247,6 +293,13 @@ void GC::ProcessGrey() {
 }
 
 
+bool GC::IsMarkingCode() {
+  // Old space GC visits every reachable value, unreachable functions are
+  // still callable until the memory of the old space is freed
+  return gc_type() == kOldSpace && heap()->code_space() != NULL;
+}
+
+
 bool GC::IsInCurrentSpace(HValue* value) {
   return (gc_type() == kOldSpace &&
          value->Generation() >= Heap::kMinOldSpaceGeneration) ||
@@ -278,6 +331,8 @@ void GC::VisitValue(HValue* value) {
             break;
           case HString::kCons:
             return VisitString(value);
+          case HString::kSliced:
+            return VisitSlicedString(value);
         }
       }
     case Heap::kTagNumber:
@@ -304,6 +359,8 @@ void GC::VisitContext(HContext* context) {
 
 
 void GC::VisitFunction(HFunction* fn) {
+  if (IsMarkingCode()) heap()->code_space()->Mark(HFunction::Code(fn->addr()));
+
   if (fn->parent_slot() != NULL &&
       fn->parent() != reinterpret_cast<char*>(Heap::kBindingContextTag)) {
     push_grey(HValue::Cast(fn->parent()), fn->parent_slot());
@@ -346,5 +403,11 @@ void GC::VisitString(HValue* value) {
             HString::RightConsSlot(value->addr()));
 }
 
+
+void GC::VisitSlicedString(HValue* value) {
+  push_grey(HValue::Cast(HString::SliceParent(value->addr())),
+            HString::SliceParentSlot(value->addr()));
+}
+
 }  // namespace internal
 }  // namespace candor
@@ -72,6 +72,11 @@ class GC {
   void RelocateWeakHandles();
 
   void ColourFrames(char* stack_top);
+
+  // Values outside of the collected space aren't visited through the weak
+  // references, but still survive GC. Colour everything they reference.
+  void ColourWeakSurvivors();
+  void ColourWeakSurvivor(HValue* value);
   void HandleWeakReferences();
 
   void ProcessGrey();
@@ -83,9 +88,13 @@ class GC {
   void VisitArray(HArray* arr);
   void VisitMap(HMap* map);
   void VisitString(HValue* value);
+  void VisitSlicedString(HValue* value);
 
   bool IsInCurrentSpace(HValue* value);
 
+  // Code space is collected together with the old space (see CodeSpace)
+  bool IsMarkingCode();
+
   inline void push_grey(HValue* value, char** reference) {
     grey_items()->Push(new GCValue(value, reference));
   }
@@ -120,12 +120,153 @@ void Space::Clear() {
 }
 
 
+StringTable::StringTable(Heap* heap) : heap_(heap),
+                                      size_(kInitialSize),
+                                      length_(0),
+                                      deleted_(0) {
+  slots_ = new char*[size_];
+  memset(slots_, 0, sizeof(*slots_) * size_);
+}
+
+
+StringTable::~StringTable() {
+  delete[] slots_;
+  slots_ = NULL;
+}
+
+
+char* StringTable::Forward(char* str) {
+  // Weak callbacks are invoked before the table is swept,
+  // strings moved by GC have forwarding pointer in the hash slot
+  HValue* value = HValue::Cast(str);
+  return value->IsGCMarked() ? value->GetGCMark() : str;
+}
+
+
+char** StringTable::Lookup(char* str, uint32_t hash) {
+  uint32_t mask = size_ - 1;
+  uint32_t length = HString::Length(str);
+  char** deleted = NULL;
+
+  for (uint32_t i = hash & mask; ; i = (i + 1) & mask) {
+    char* slot = slots_[i];
+
+    // Empty slot: return the first free one
+    if (slot == NULL) return deleted == NULL ? &slots_[i] : deleted;
+
+    if (slot == HNil::New()) {
+      if (deleted == NULL) deleted = &slots_[i];
+      continue;
+    }
+
+    // Interned strings are always flat
+    slot = Forward(slot);
+    if (slot == str ||
+        (HString::Length(slot) == length &&
+         HString::CachedHash(slot) == hash &&
+         memcmp(slot + HString::kValueOffset,
+                HString::Value(heap_, str),
+                length) == 0)) {
+      return &slots_[i];
+    }
+  }
+}
+
+
+char* StringTable::Find(char* str) {
+  if (HString::IsInterned(str)) return str;
+
+  char* slot = *Lookup(str, HString::Hash(heap_, str));
+  return slot == NULL || slot == HNil::New() ? NULL : Forward(slot);
+}
+
+
+char* StringTable::Intern(char* str) {
+  if (HString::IsInterned(str)) return str;
+
+  uint32_t hash = HString::Hash(heap_, str);
+  char** slot = Lookup(str, hash);
+  if (*slot != NULL && *slot != HNil::New()) return Forward(*slot);
+
+  // Only flat strings are interned
+  switch (HValue::GetRepresentation<HString::Representation>(str)) {
+    case HString::kNormal:
+      break;
+    case HString::kCons:
+      // Value() puts flattened string into the left slot
+      HString::Value(heap_, str);
+      while (HValue::GetRepresentation<HString::Representation>(str) ==
+             HString::kCons) {
+        str = HString::LeftCons(str);
+      }
+      if (!HString::HasHash(str)) HString::Hash(heap_, str);
+      break;
+    default:
+      str = HString::New(heap_,
+                         Heap::kTenureNew,
+                         HString::Value(heap_, str),
+                         HString::Length(str));
+      HString::Hash(heap_, str);
+      break;
+  }
+
+  if (*slot == HNil::New()) deleted_--;
+  *slot = str;
+  HString::SetInterned(str);
+  length_++;
+
+  // Keep load factor below 1/2
+  if ((length_ + deleted_) << 1 > size_) Rehash();
+
+  return str;
+}
+
+
+void StringTable::Rehash() {
+  char** old_slots = slots_;
+  uint32_t old_size = size_;
+
+  if (length_ << 2 > size_) size_ <<= 1;
+  slots_ = new char*[size_];
+  memset(slots_, 0, sizeof(*slots_) * size_);
+  deleted_ = 0;
+
+  for (uint32_t i = 0; i < old_size; i++) {
+    char* str = old_slots[i];
+    if (str == NULL || str == HNil::New()) continue;
+
+    *Lookup(str, HString::CachedHash(Forward(str))) = str;
+  }
+
+  delete[] old_slots;
+}
+
+
+void StringTable::Sweep(GC* gc) {
+  for (uint32_t i = 0; i < size_; i++) {
+    char* str = slots_[i];
+    if (str == NULL || str == HNil::New()) continue;
+
+    HValue* value = HValue::Cast(str);
+    if (value->IsGCMarked()) {
+      slots_[i] = value->GetGCMark();
+    } else if (gc->IsInCurrentSpace(value)) {
+      // String is dead - leave tombstone
+      slots_[i] = HNil::New();
+      length_--;
+      deleted_++;
+    }
+  }
+}
+
+
 Heap::Heap(uint32_t page_size) : new_space_(this, page_size),
                                  old_space_(this, page_size),
                                  last_stack_(NULL),
                                  last_frame_(NULL),
                                  pending_exception_(NULL),
                                  needs_gc_(kGCNone),
+                                 string_table_(this),
                                  gc_(this),
                                  code_space_(NULL) {
   current_ = this;
@@ -150,7 +291,9 @@ char* Heap::ToFactory(char* key) {
 
 
 char* Heap::CreateString(const char* key, uint32_t size) {
-  return ToFactory(HString::New(this, Heap::kTenureOld, key, size));
+  // Runtime might have already interned the same string
+  return ToFactory(string_table()->Intern(
+        HString::New(this, Heap::kTenureOld, key, size)));
 }
 
 
@@ -251,6 +394,14 @@ HValue* HValue::CopyTo(Space* old_space, Space* new_space) {
           // + lhs + rhs + scratch_slot (for traversing)
           size += 2 * kPointerSize;
           break;
+        case HString::kSliced:
+          if (HString::ShouldFlattenSlice(addr())) {
+            return CopySliceTo(old_space, new_space);
+          }
+
+          // + parent + offset
+          size += 2 * kPointerSize;
+          break;
         default:
           UNEXPECTED
           break;
@@ -290,6 +441,35 @@ HValue* HValue::CopyTo(Space* old_space, Space* new_space) {
 }
 
 
+HValue* HValue::CopySliceTo(Space* old_space, Space* new_space) {
+  uint32_t length = HString::Length(addr());
+  char* parent = HString::SliceParent(addr());
+
+  IncrementGeneration();
+  char* result;
+  uint32_t size = 3 * kPointerSize + length;
+  if (Generation() >= Heap::kMinOldSpaceGeneration) {
+    result = old_space->Allocate(size);
+  } else {
+    result = new_space->Allocate(size);
+  }
+
+  // Copy tag and turn slice into a flat string, parent is always flat and
+  // its bytes are intact even if it was already moved
+  memcpy(result + interior_offset(0),
+         addr() + interior_offset(0),
+         kPointerSize);
+  SetRepresentation<HString::Representation>(result, HString::kNormal);
+  *reinterpret_cast<intptr_t*>(result + HString::kHashOffset) = 0;
+  *reinterpret_cast<intptr_t*>(result + HString::kLengthOffset) = length;
+  memcpy(result + HString::kValueOffset,
+         parent + HString::kValueOffset + HString::SliceOffset(addr()),
+         length);
+
+  return HValue::Cast(result);
+}
+
+
 char* HContext::New(Heap* heap,
                     ZoneList<char*>* values) {
   char* result = heap->AllocateTagged(Heap::kTagContext,
@@ -383,6 +563,48 @@ char* HString::NewCons(Heap* heap,
 }
 
 
+char* HString::NewSlice(Heap* heap,
+                        Heap::TenureType tenure,
+                        char* parent,
+                        uint32_t offset,
+                        uint32_t length) {
+  assert(offset + length <= Length(parent));
+
+  // Slices always point to the flat string
+  while (GetRepresentation<Representation>(parent) != kNormal) {
+    if (GetRepresentation<Representation>(parent) == kSliced) {
+      offset += SliceOffset(parent);
+      parent = SliceParent(parent);
+    } else {
+      // Flatten cons and use its cached value
+      Value(heap, parent);
+      parent = LeftCons(parent);
+    }
+  }
+
+  // Whole string
+  if (offset == 0 && length == Length(parent)) return parent;
+
+  // Small slices aren't worth the indirection
+  if (length < kMinSliceLength) {
+    return New(heap, tenure, parent + kValueOffset + offset, length);
+  }
+
+  char* result = New(heap, tenure, 2 * kPointerSize);
+
+  // Set representation
+  SetRepresentation<Representation>(result, kSliced);
+
+  // Set length
+  *reinterpret_cast<uint32_t*>(result + kLengthOffset) = length;
+
+  *SliceParentSlot(result) = parent;
+  *reinterpret_cast<intptr_t*>(result + kSliceOffsetOffset) = offset;
+
+  return result;
+}
+
+
 char* HString::FlattenCons(char* addr, char* buffer) {
   while (addr != NULL) {
     switch (GetRepresentation<Representation>(addr)) {
@@ -392,6 +614,14 @@ char* HString::FlattenCons(char* addr, char* buffer) {
           memcpy(buffer, addr + kValueOffset, len);
           return buffer + len;
         }
+      case kSliced:
+        {
+          uint32_t len = HString::Length(addr);
+          memcpy(buffer,
+                 SliceParent(addr) + kValueOffset + SliceOffset(addr),
+                 len);
+          return buffer + len;
+        }
       case kCons:
         {
           char* left = LeftCons(addr);
@@ -444,6 +674,9 @@ char* HString::Value(Heap* heap, char* addr) {
 
         return value;
       }
+    case kSliced:
+      // Parent is always flat
+      return SliceParent(addr) + kValueOffset + SliceOffset(addr);
     default:
       UNEXPECTED
       return NULL;
@@ -120,6 +120,40 @@ class Space {
   uint32_t size_limit_;
 };
 
+// Weak table of interned strings. All strings used as object's keys are
+// interned, so property lookups may compare keys by pointer
+class StringTable {
+ public:
+  explicit StringTable(Heap* heap);
+  ~StringTable();
+
+  // Returns interned string with the same contents as `str`
+  // (interning flat copy of `str` if there's no such string yet)
+  char* Intern(char* str);
+
+  // Returns interned string or NULL
+  char* Find(char* str);
+
+  // Relocate moved strings and remove dead ones
+  // (invoked by GC after weak callbacks)
+  void Sweep(GC* gc);
+
+  inline uint32_t length() { return length_; }
+
+  static const uint32_t kInitialSize = 256;
+
+ private:
+  static char* Forward(char* str);
+  char** Lookup(char* str, uint32_t hash);
+  void Rehash();
+
+  Heap* heap_;
+  char** slots_;
+  uint32_t size_;
+  uint32_t length_;
+  uint32_t deleted_;
+};
+
 typedef HashMap<NumberKey, HValueReference, EmptyClass> HValueRefMap;
 typedef List<HValueReference, EmptyClass> HValueRefList;
 typedef HashMap<NumberKey, HValueWeakRef, EmptyClass> HValueWeakRefMap;
@@ -186,6 +220,7 @@ class Heap {
   static const uint32_t kMinFactorySize = 128;
   static const uint32_t kBindingContextTag = 0x0DEC0DEC;
   static const uint32_t kEnterFrameTag = 0xFEEDBEEE;
+  static const uint32_t kOSRFrameTag = 0xDEADC0DE;
   static const uint32_t kICDisabledValue = 0xABBAABBA;
   static const uint32_t kICZapValue = 0xABBADEEC;
 
@@ -237,6 +272,7 @@ class Heap {
   inline CodeSpace* code_space() { return code_space_; }
   inline void code_space(CodeSpace* code_space) { code_space_ = code_space; }
   inline SourceMap* source_map() { return &source_map_; }
+  inline StringTable* string_table() { return &string_table_; }
 
   // Factory methods
   char* CreateString(const char* key, uint32_t size);
@@ -259,6 +295,7 @@ class Heap {
 
   HValueRefMap references_;
   HValueWeakRefMap weak_references_;
+  StringTable string_table_;
   HValue* factory_;
 
   GC gc_;
@@ -292,6 +329,7 @@ class HValue {
   }
 
   HValue* CopyTo(Space* old_space, Space* new_space);
+  HValue* CopySliceTo(Space* old_space, Space* new_space);
 
   inline bool IsGCMarked();
   inline char* GetGCMark();
@@ -464,7 +502,8 @@ class HString : public HValue {
  public:
   enum Representation {
     kNormal = 0x00,
-    kCons   = 0x01
+    kCons   = 0x01,
+    kSliced = 0x02
   };
 
   static char* New(Heap* heap,
@@ -479,6 +518,11 @@ class HString : public HValue {
                        uint32_t length,
                        char* left,
                        char* right);
+  static char* NewSlice(Heap* heap,
+                        Heap::TenureType tenure,
+                        char* parent,
+                        uint32_t offset,
+                        uint32_t length);
 
   inline uint32_t length() { return Length(addr()); }
 
@@ -490,6 +534,27 @@ class HString : public HValue {
     return *reinterpret_cast<uint32_t*>(addr + kLengthOffset);
   }
 
+  static inline bool IsInterned(char* addr) {
+    return (*reinterpret_cast<uint8_t*>(addr + kInternedOffset) &
+            kInternedBit) != 0;
+  }
+
+  static inline void SetInterned(char* addr) {
+    *reinterpret_cast<uint8_t*>(addr + kInternedOffset) |= kInternedBit;
+  }
+
+  static inline bool HasHash(char* addr) { return CachedHash(addr) != 0; }
+  static inline uint32_t CachedHash(char* addr) {
+    return *reinterpret_cast<uint32_t*>(addr + kHashOffset);
+  }
+
+  // Shrink flat string in-place, trailing bytes will be dropped by GC
+  static inline void Truncate(char* addr, uint32_t length) {
+    assert(length <= Length(addr));
+    *reinterpret_cast<intptr_t*>(addr + kHashOffset) = 0;
+    *reinterpret_cast<intptr_t*>(addr + kLengthOffset) = length;
+  }
+
   static inline char* LeftCons(char* addr) { return *LeftConsSlot(addr); }
   static inline char* RightCons(char* addr) { return *RightConsSlot(addr); }
 
@@ -501,6 +566,24 @@ class HString : public HValue {
     return reinterpret_cast<char**>(addr + kRightConsOffset);
   }
 
+  static inline char* SliceParent(char* addr) {
+    return *SliceParentSlot(addr);
+  }
+
+  static inline char** SliceParentSlot(char* addr) {
+    return reinterpret_cast<char**>(addr + kSliceParentOffset);
+  }
+
+  static inline uint32_t SliceOffset(char* addr) {
+    return *reinterpret_cast<intptr_t*>(addr + kSliceOffsetOffset);
+  }
+
+  // Slice should be copied into a flat string if it retains too much of the
+  // parent's bytes
+  static inline bool ShouldFlattenSlice(char* addr) {
+    return Length(SliceParent(addr)) > kMaxSliceRatio * Length(addr);
+  }
+
   static const int kHashOffset = HINTERIOR_OFFSET(1);
   static const int kLengthOffset = HINTERIOR_OFFSET(2);
   static const int kValueOffset = HINTERIOR_OFFSET(3);
@@ -508,7 +591,17 @@ class HString : public HValue {
   static const int kLeftConsOffset = HINTERIOR_OFFSET(3);
   static const int kRightConsOffset = HINTERIOR_OFFSET(4);
 
+  // Tag word has no spare byte on ia32, so interned flag shares GC mark's
+  // byte (which uses only 0x80 and 0x40 bits)
+  static const int kInternedOffset = kGCMarkOffset;
+  static const int kInternedBit = 0x20;
+
+  static const int kSliceParentOffset = HINTERIOR_OFFSET(3);
+  static const int kSliceOffsetOffset = HINTERIOR_OFFSET(4);
+
   static const int kMinConsLength = 24;
+  static const int kMinSliceLength = 24;
+  static const uint32_t kMaxSliceRatio = 8;
 
   static const Heap::HeapTag class_tag = Heap::kTagString;
 };
@@ -143,6 +143,26 @@ inline Root* HIRGen::root() {
 }
 
 
+inline CodeProfile* HIRGen::profile() {
+  return profile_;
+}
+
+
+inline void HIRGen::profile(CodeProfile* profile) {
+  profile_ = profile;
+}
+
+
+inline AstNode* HIRGen::osr_loop() {
+  return osr_loop_;
+}
+
+
+inline void HIRGen::osr_loop(AstNode* loop) {
+  osr_loop_ = loop;
+}
+
+
 inline int HIRGen::block_id() {
   return block_id_++;
 }
@@ -428,6 +448,29 @@ inline int HIRBlock::dominator_depth() {
 }
 
 
+inline HIRBlock* HIRBlock::dominator_jump() {
+  // Skew-binary jump pointers: any ancestor in dominator tree is reachable
+  // in a logarithmic number of jumps and dominator() steps
+  if (dominator_jump_ == NULL) {
+    HIRBlock* dom = dominator();
+    if (dom == NULL) {
+      dominator_jump_ = this;
+    } else {
+      HIRBlock* jump = dom->dominator_jump();
+      HIRBlock* next = jump->dominator_jump();
+      if (dom->dominator_depth() - jump->dominator_depth() ==
+          jump->dominator_depth() - next->dominator_depth()) {
+        dominator_jump_ = next;
+      } else {
+        dominator_jump_ = dom;
+      }
+    }
+  }
+
+  return dominator_jump_;
+}
+
+
 inline HIRBlockList* HIRBlock::dominates() {
   return &dominates_;
 }
@@ -96,6 +96,13 @@ inline bool HIRInstruction::IsNumber() {
 }
 
 
+inline bool HIRInstruction::IsNumberOnly() {
+  int mask = kSmiRepresentation | kHeapNumberRepresentation;
+  return representation() != kUnknownRepresentation &&
+         (representation() & ~mask) == 0;
+}
+
+
 inline bool HIRInstruction::IsSmi() {
   return representation() & kSmiRepresentation;
 }
@@ -133,6 +140,22 @@ inline HIRInstruction* HIRInstruction::Pin() {
 }
 
 
+inline HIRRange* HIRInstruction::range() {
+  return range_;
+}
+
+
+inline void HIRInstruction::range(HIRRange* range) {
+  range_ = range;
+}
+
+
+inline HIRRange* HIRRange::New(int64_t min, int64_t max) {
+  if (min < kMin || max > kMax) return NULL;
+  return new HIRRange(min, max);
+}
+
+
 inline HIRBlock* HIRInstruction::block() {
   return block_;
 }
@@ -184,6 +207,16 @@ inline HIRInstructionList* HIRInstruction::effects_out() {
 }
 
 
+inline bool HIRInstruction::HasUnknownEffects() {
+  return unknown_effects_;
+}
+
+
+inline void HIRInstruction::MarkUnknownEffects() {
+  unknown_effects_ = true;
+}
+
+
 inline HIRInstruction* HIRInstruction::left() {
   assert(args()->length() >= 1);
   return args()->head()->value();
@@ -255,6 +288,11 @@ inline ScopeSlot* HIRLiteral::root_slot() {
 }
 
 
+inline AstNode::Type HIRLiteral::literal_type() {
+  return type_;
+}
+
+
 inline FunctionLiteral* HIRFunction::ast() {
   return ast_;
 }
@@ -270,11 +308,31 @@ inline int HIREntry::context_slots() {
 }
 
 
+inline bool HIREntry::osr() {
+  return osr_;
+}
+
+
 inline BinOp::BinOpType HIRBinOp::binop_type() {
   return binop_type_;
 }
 
 
+inline int HIRBinOp::feedback() {
+  return feedback_;
+}
+
+
+inline void HIRBinOp::feedback(int kinds) {
+  feedback_ = kinds;
+}
+
+
+inline ScopeSlot* HIRLoadOsr::osr_slot() {
+  return osr_slot_;
+}
+
+
 inline ScopeSlot* HIRLoadContext::context_slot() {
   return context_slot_;
 }
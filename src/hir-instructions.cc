@@ -24,6 +24,7 @@
 #include "hir-inl.h"
 #include "hir-instructions.h"
 #include "hir-instructions-inl.h"
+#include "code-space.h"  // TypeFeedback
 
 namespace candor {
 namespace internal {
@@ -33,15 +34,23 @@ HIRInstruction::HIRInstruction(Type type)
       gcm_visited(0),
       gvn_visited(0),
       alias_visited(0),
+      range_visited(0),
+      effects_out_mark(NULL),
+      effects_in_mark(NULL),
       is_live(0),
+      block_pos(0),
+      double_barrier_pos(-1),
       type_(type),
       slot_(NULL),
       ast_(NULL),
       lir_(NULL),
+      block_(NULL),
       hashed_(false),
       hash_(0),
       removed_(false),
       pinned_(true),
+      unknown_effects_(false),
+      range_(NULL),
       representation_(kHoleRepresentation) {
 }
 
@@ -51,15 +60,23 @@ HIRInstruction::HIRInstruction(Type type, ScopeSlot* slot)
       gcm_visited(0),
       gvn_visited(0),
       alias_visited(0),
+      range_visited(0),
+      effects_out_mark(NULL),
+      effects_in_mark(NULL),
       is_live(0),
+      block_pos(0),
+      double_barrier_pos(-1),
       type_(type),
       slot_(slot),
       ast_(NULL),
       lir_(NULL),
+      block_(NULL),
       hashed_(false),
       hash_(0),
       removed_(false),
       pinned_(true),
+      unknown_effects_(false),
+      range_(NULL),
       representation_(kHoleRepresentation) {
 }
 
@@ -161,6 +178,21 @@ uint32_t HIRInstruction::Hash(HIRInstruction* instr) {
     }
   }
 
+  // Literals have no inputs, but differ by values
+  if (instr->Is(kLiteral)) {
+    ScopeSlot* slot = HIRLiteral::Cast(instr)->root_slot();
+    uint32_t value_hash = slot->is_immediate() ?
+        ComputeHash(reinterpret_cast<intptr_t>(slot->value())) :
+        ComputeHash(slot->index());
+
+    while (value_hash != 0) {
+      r += value_hash & 0xff;
+      r += r << 10;
+      r ^= r >> 6;
+      value_hash = value_hash >> 8;
+    }
+  }
+
   // Shuffle bits
   r += r << 3;
   r ^= r >> 13;
@@ -197,6 +229,7 @@ bool HIRInstruction::IsGVNEqual(HIRInstruction* to) {
 
 
 bool HIRInstruction::HasSameEffects(HIRInstruction* to) {
+  if (HasUnknownEffects() || to->HasUnknownEffects()) return false;
   if (effects_in()->length() != to->effects_in()->length()) return false;
 
   // Effects should be the same
@@ -278,6 +311,24 @@ void HIRPhi::CalculateRepresentation() {
 }
 
 
+void HIRPhi::RemoveInputAt(int i) {
+  assert(i < input_count_);
+  HIRInstruction* input = inputs_[i];
+
+  for (; i < input_count_ - 1; i++) inputs_[i] = inputs_[i + 1];
+  input_count_--;
+
+  HIRInstructionList::Item* head = args()->head();
+  for (; head != NULL; head = head->next()) {
+    if (head->value() == input) {
+      args()->Remove(head);
+      break;
+    }
+  }
+  input->RemoveUse(this);
+}
+
+
 void HIRPhi::ReplaceArg(HIRInstruction* o, HIRInstruction* n) {
   HIRInstruction::ReplaceArg(o, n);
 
@@ -287,6 +338,13 @@ void HIRPhi::ReplaceArg(HIRInstruction* o, HIRInstruction* n) {
 }
 
 
+// Phis with equal inputs in different blocks are still distinct values,
+// and their block's predecessors reference them by identity
+bool HIRPhi::HasGVNSideEffects() {
+  return true;
+}
+
+
 bool HIRPhi::Effects(HIRInstruction* instr) {
   return true;
 }
@@ -352,10 +410,11 @@ HIRNil::HIRNil() : HIRInstruction(kNil) {
 }
 
 
-HIREntry::HIREntry(Label* label, int context_slots_)
+HIREntry::HIREntry(Label* label, int context_slots_, bool osr)
     : HIRInstruction(kEntry),
       label_(label),
-      context_slots_(context_slots_) {
+      context_slots_(context_slots_),
+      osr_(osr) {
 }
 
 
@@ -365,7 +424,7 @@ bool HIREntry::HasSideEffects() {
 
 
 void HIREntry::Print(PrintBuffer* p) {
-  p->Print("i%d = Entry[%d]\n", id, context_slots_);
+  p->Print("i%d = Entry[%d%s]\n", id, context_slots_, osr_ ? ", osr" : "");
 }
 
 
@@ -415,7 +474,8 @@ bool HIRGetStackTrace::HasSideEffects() {
 
 
 HIRBinOp::HIRBinOp(BinOp::BinOpType type) : HIRInstruction(kBinOp),
-                                            binop_type_(type) {
+                                            binop_type_(type),
+                                            feedback_(TypeFeedback::kNone) {
 }
 
 
@@ -430,10 +490,22 @@ void HIRBinOp::CalculateRepresentation() {
     res = kBooleanRepresentation;
   } else if (BinOp::is_math(binop_type_)) {
     if (binop_type_ != BinOp::kAdd) {
-      res = kNumberRepresentation;
+      // Heap number (-) number = heap number
+      if (left == kHeapNumberRepresentation ||
+          right == kHeapNumberRepresentation) {
+        res = kHeapNumberRepresentation;
+      } else {
+        res = kNumberRepresentation;
+      }
     } else if ((left | right) & kStringRepresentation) {
       // "123" + any, or any + "123"
       res = kStringRepresentation;
+    } else if ((left == kHeapNumberRepresentation &&
+                args()->tail()->value()->IsNumberOnly()) ||
+               (right == kHeapNumberRepresentation &&
+                args()->head()->value()->IsNumberOnly())) {
+      // Heap number + number = heap number
+      res = kHeapNumberRepresentation;
     } else {
       int mask = kSmiRepresentation |
                  kHeapNumberRepresentation |
@@ -453,6 +525,17 @@ bool HIRBinOp::IsGVNEqual(HIRInstruction* to) {
 }
 
 
+HIRLoadOsr::HIRLoadOsr(ScopeSlot* slot)
+    : HIRInstruction(kLoadOsr),
+      osr_slot_(slot) {
+}
+
+
+bool HIRLoadOsr::HasGVNSideEffects() {
+  return true;
+}
+
+
 HIRLoadContext::HIRLoadContext(ScopeSlot* slot)
     : HIRInstruction(kLoadContext),
       context_slot_(slot) {
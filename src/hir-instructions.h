@@ -23,6 +23,8 @@
 #ifndef _SRC_HIR_INSTRUCTIONS_H_
 #define _SRC_HIR_INSTRUCTIONS_H_
 
+#include <stdint.h>  // int64_t
+
 #include "ast.h"  // AstNode
 #include "scope.h"  // ScopeSlot
 #include "zone.h"  // Zone, ZoneList
@@ -36,6 +38,7 @@ class HIRGen;
 class HIRBlock;
 class HIRInstruction;
 class HIRPhi;
+class HIRRange;
 class LInstruction;
 
 typedef ZoneList<HIRInstruction*> HIRInstructionList;
@@ -53,6 +56,7 @@ typedef ZoneList<HIRPhi*> HIRPhiList;
     V(StoreArg) \
     V(StoreVarArg) \
     V(AlignStack) \
+    V(LoadOsr) \
     V(LoadContext) \
     V(StoreContext) \
     V(LoadProperty) \
@@ -111,8 +115,19 @@ class HIRInstruction : public ZoneObject {
   int gcm_visited;
   int gvn_visited;
   int alias_visited;
+  int range_visited;
+
+  // Last instruction that has this one in effects_out/effects_in lists,
+  // used to avoid duplicates in them
+  HIRInstruction* effects_out_mark;
+  HIRInstruction* effects_in_mark;
   int is_live;
 
+  // Position in block and position of the last preceding instruction that
+  // may clobber double registers (see LGen::CanKeepUnboxed)
+  int block_pos;
+  int double_barrier_pos;
+
   virtual void ReplaceArg(HIRInstruction* o, HIRInstruction* n);
   virtual bool HasSideEffects();
   virtual bool HasGVNSideEffects();
@@ -135,6 +150,7 @@ class HIRInstruction : public ZoneObject {
 
   inline Representation representation();
   inline bool IsNumber();
+  inline bool IsNumberOnly();
   inline bool IsSmi();
   inline bool IsHeapNumber();
   inline bool IsString();
@@ -144,6 +160,10 @@ class HIRInstruction : public ZoneObject {
   inline HIRInstruction* Unpin();
   inline HIRInstruction* Pin();
 
+  // NULL if value isn't proven to be a SMI
+  inline HIRRange* range();
+  inline void range(HIRRange* range);
+
   inline HIRBlock* block();
   inline void block(HIRBlock* block);
   inline ScopeSlot* slot();
@@ -155,6 +175,11 @@ class HIRInstruction : public ZoneObject {
   inline HIRInstructionList* effects_in();
   inline HIRInstructionList* effects_out();
 
+  // Instruction is under effect of too many instructions to list them in
+  // effects_in (see HIRGen::FindInEffects)
+  inline bool HasUnknownEffects();
+  inline void MarkUnknownEffects();
+
   inline HIRInstruction* left();
   inline HIRInstruction* right();
   inline HIRInstruction* third();
@@ -177,6 +202,9 @@ class HIRInstruction : public ZoneObject {
 
   bool removed_;
   bool pinned_;
+  bool unknown_effects_;
+
+  HIRRange* range_;
 
   // Cached representation
   Representation representation_;
@@ -189,6 +217,24 @@ class HIRInstruction : public ZoneObject {
 
 #undef HIR_INSTRUCTION_ENUM
 
+// Bounds of integer value that is known to be a SMI
+// (see HIRGen::FindRanges)
+class HIRRange : public ZoneObject {
+ public:
+  HIRRange(int64_t min, int64_t max) : min(min), max(max) {
+  }
+
+  // Returns NULL if bounds exceed SMI range
+  static inline HIRRange* New(int64_t min, int64_t max);
+
+  int64_t min;
+  int64_t max;
+
+  // Values that are SMIs on both 32 and 64 bit platforms
+  static const int64_t kMax = 0x3fffffff;
+  static const int64_t kMin = -0x40000000;
+};
+
 class HIRGVNMap : public ZoneMap<HIRInstruction, HIRInstruction, ZoneObject>,
                   public ZoneObject {
  public:
@@ -208,9 +254,11 @@ class HIRPhi : public HIRInstruction {
 
   void ReplaceArg(HIRInstruction* o, HIRInstruction* n);
   void CalculateRepresentation();
+  bool HasGVNSideEffects();
   bool Effects(HIRInstruction* instr);
 
   inline void AddInput(HIRInstruction* instr);
+  void RemoveInputAt(int i);
   inline HIRInstruction* InputAt(int i);
   inline void Nilify();
 
@@ -229,6 +277,7 @@ class HIRLiteral : public HIRInstruction {
   HIRLiteral(AstNode::Type type, ScopeSlot* slot);
 
   inline ScopeSlot* root_slot();
+  inline AstNode::Type literal_type();
 
   void CalculateRepresentation();
 
@@ -268,7 +317,7 @@ class HIRNil : public HIRInstruction {
 
 class HIREntry : public HIRInstruction {
  public:
-  HIREntry(Label* label, int context_slots);
+  HIREntry(Label* label, int context_slots, bool osr);
 
   void Print(PrintBuffer* p);
   bool HasSideEffects();
@@ -276,11 +325,15 @@ class HIREntry : public HIRInstruction {
   inline Label* label();
   inline int context_slots();
 
+  // Entered from the baseline frame, whose context is reused
+  inline bool osr();
+
   HIR_DEFAULT_METHODS(Entry)
 
  private:
   Label* label_;
   int context_slots_;
+  bool osr_;
 };
 
 class HIRReturn : public HIRInstruction {
@@ -345,12 +398,31 @@ class HIRBinOp : public HIRInstruction {
   void CalculateRepresentation();
   inline BinOp::BinOpType binop_type();
 
+  // Kinds of operands seen by the baseline code (see TypeFeedback)
+  inline int feedback();
+  inline void feedback(int kinds);
+
   HIR_DEFAULT_METHODS(BinOp)
 
  protected:
   bool IsGVNEqual(HIRInstruction* to);
 
   BinOp::BinOpType binop_type_;
+  int feedback_;
+};
+
+// Value of the stack variable in the baseline frame (on-stack replacement)
+class HIRLoadOsr : public HIRInstruction {
+ public:
+  explicit HIRLoadOsr(ScopeSlot* slot);
+
+  inline ScopeSlot* osr_slot();
+  bool HasGVNSideEffects();
+
+  HIR_DEFAULT_METHODS(LoadOsr)
+
+ protected:
+  ScopeSlot* osr_slot_;
 };
 
 class HIRLoadContext : public HIRInstruction {
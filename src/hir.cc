@@ -26,6 +26,8 @@
 
 #include "hir-inl.h"
 #include "macroassembler.h"  // Label
+#include "code-space.h"  // CodeProfile
+#include "compile-stats.h"  // CompileStats
 #include "splay-tree.h"
 
 namespace candor {
@@ -39,6 +41,13 @@ HIRGen::HIRGen(Heap* heap, Root* root, const char* filename)
       current_root_(NULL),
       break_continue_info_(NULL),
       root_(root),
+      profile_(NULL),
+      osr_loop_(NULL),
+      inline_info_(NULL),
+      inline_return_(NULL),
+      inline_loop_depth_(0),
+      inline_profile_(NULL),
+      inlined_size_(0),
       filename_(filename),
       loop_depth_(0),
       block_id_(0),
@@ -48,6 +57,12 @@ HIRGen::HIRGen(Heap* heap, Root* root, const char* filename)
 
 
 HIRGen::~HIRGen() {
+  // LIR has already used slots of the inlined functions
+  HIRInlineList::Item* ihead = inline_candidates_.head();
+  for (; ihead != NULL; ihead = ihead->next()) {
+    ihead->value()->Restore();
+  }
+
   // Bitmaps in blocks are allocated :(
   HIRBlock* b;
   while ((b = blocks_.Shift()) != NULL) {
@@ -57,10 +72,13 @@ HIRGen::~HIRGen() {
 
 
 void HIRGen::Build(AstNode* root) {
+  CompileStats::Timer timer(CompileStats::kHIRBuild);
+
   HIRFunction* current = new HIRFunction(root);
   current->Init(this, NULL);
 
-  HIRBlock* b = CreateBlock(current->ast()->stack_slots());
+  int inline_slots = FindInlineCandidates(current->ast());
+  HIRBlock* b = CreateBlock(current->ast()->stack_slots() + inline_slots);
   set_current_block(b);
   set_current_root(b);
 
@@ -76,14 +94,39 @@ void HIRGen::Build(AstNode* root) {
   set_current_root(NULL);
 
   // Optimize
+  timer.Switch(CompileStats::kPropagateConstants);
+  PropagateConstants();
+  timer.Switch(CompileStats::kFindReachableBlocks);
   FindReachableBlocks();
+  timer.Switch(CompileStats::kDeriveDominators);
   DeriveDominators();
+  timer.Switch(CompileStats::kPrunePhis);
   PrunePhis();
+  timer.Switch(CompileStats::kScalarReplacement);
+  ScalarReplacement();
+  timer.Switch(CompileStats::kFindEffects);
   FindEffects();
+  timer.Switch(CompileStats::kEliminateDeadCode);
   EliminateDeadCode();
+  timer.Switch(CompileStats::kGlobalValueNumbering);
   GlobalValueNumbering();
+  timer.Switch(CompileStats::kFindRanges);
+  FindRanges();
+  timer.Switch(CompileStats::kUnpinContextLoads);
+  UnpinContextLoads();
+  timer.Switch(CompileStats::kGlobalCodeMotion);
   GlobalCodeMotion();
 
+  if (CompileStats::enabled()) {
+    int instructions = 0;
+    HIRBlockList::Item* bhead = blocks_.head();
+    for (; bhead != NULL; bhead = bhead->next()) {
+      instructions += bhead->value()->instructions()->length();
+    }
+    CompileStats::Count(CompileStats::kHIRBlocks, blocks_.length());
+    CompileStats::Count(CompileStats::kHIRInstructions, instructions);
+  }
+
   if (log_) {
     PrintBuffer p(stdout);
     p.Print("## HIR %s Start ##\n", filename_ == NULL ? "unknown" : filename_);
@@ -347,8 +390,6 @@ void HIRGen::FindOutEffects(HIRInstruction* instr) {
   if (instr->alias_visited == 1) return;
   instr->alias_visited = 1;
 
-  SplayTree<NumberKey, HIRInstruction, NopPolicy, ZoneObject> effects_;
-
   HIRInstructionList::Item* uhead = instr->uses()->head();
   for (; uhead != NULL; uhead = uhead->next()) {
     HIRInstruction* use = uhead->value();
@@ -361,15 +402,14 @@ void HIRGen::FindOutEffects(HIRInstruction* instr) {
     for (; ehead != NULL; ehead = ehead->next()) {
       HIRInstruction* effect = ehead->value();
 
-      NumberKey* key = NumberKey::New(effect->id);
-      if (!effects_.Insert(key, effect)) continue;
+      if (effect->effects_out_mark == instr) continue;
+      effect->effects_out_mark = instr;
       instr->effects_out()->Push(effect);
     }
 
     // Phi effects it's inputs, and call effects it's arguments
-    if (use->Effects(instr)) {
-      NumberKey* key = NumberKey::New(use->id);
-      if (!effects_.Insert(key, use)) continue;
+    if (use->Effects(instr) && use->effects_out_mark != instr) {
+      use->effects_out_mark = instr;
       instr->effects_out()->Push(use);
     }
   }
@@ -380,31 +420,26 @@ void HIRGen::FindInEffects(HIRInstruction* instr) {
   if (instr->alias_visited == 2) return;
   instr->alias_visited = 2;
 
-  SplayTree<NumberKey, HIRInstruction, NopPolicy, ZoneObject> effects_;
-
   HIRInstructionList::Item* ahead = instr->args()->head();
   for (; ahead != NULL; ahead = ahead->next()) {
     HIRInstruction* arg = ahead->value();
 
-    // If inputs are under effect - instruction is under effect too
-    FindInEffects(arg);
-    HIRInstructionList::Item* ehead = instr->effects_in()->head();
-    for (; ehead != NULL; ehead = ehead->next()) {
-      HIRInstruction* effect = ehead->value();
-      NumberKey* key = NumberKey::New(effect->id);
-      if (!effects_.Insert(key, effect)) continue;
-      instr->effects_in()->Push(effect);
+    // Keep effect lists short, otherwise FindInEffects and GVN are quadratic
+    // in the number of stores to the object
+    if (arg->effects_out()->length() > kMaxEffects) {
+      instr->MarkUnknownEffects();
+      continue;
     }
 
-    ehead = arg->effects_out()->head();
+    HIRInstructionList::Item* ehead = arg->effects_out()->head();
     for (; ehead != NULL; ehead = ehead->next()) {
       // If instruction may be reachable from one of outcoming effects of
       // it's arguments are under effect.
       HIRInstruction* effect = ehead->value();
+      if (effect->effects_in_mark == instr) continue;
       if (instr->block()->reachable_from()->Test(effect->block()->id) ||
           (instr->block() == effect->block() && effect->id < instr->id)) {
-        NumberKey* key = NumberKey::New(effect->id);
-        if (!effects_.Insert(key, effect)) continue;
+        effect->effects_in_mark = instr;
         instr->effects_in()->Push(effect);
       }
     }
@@ -467,6 +502,677 @@ void HIRGen::GlobalValueNumbering(HIRInstruction* instr,
 
 // Implementation of Globel Code Motion algorithm from
 // Cliff Click's paper.
+void HIRGen::FindRanges() {
+  HIRBlockList::Item* bhead = blocks_.head();
+  for (; bhead != NULL; bhead = bhead->next()) {
+    HIRInstructionList::Item* ihead = bhead->value()->instructions()->head();
+    for (; ihead != NULL; ihead = ihead->next()) {
+      FindRange(ihead->value());
+    }
+  }
+}
+
+
+HIRRange* HIRGen::FindRange(HIRInstruction* instr) {
+  // Cycles are resolved only for loop counters (see FindInductionRange),
+  // everything else in them has no range
+  if (instr->range_visited) return instr->range();
+  instr->range_visited = 1;
+
+  HIRRange* res = NULL;
+  switch (instr->type()) {
+    case HIRInstruction::kLiteral:
+      if (instr->representation() == HIRInstruction::kSmiRepresentation) {
+        char* value = HIRLiteral::Cast(instr)->root_slot()->value();
+        int64_t num = HNumber::Untag(reinterpret_cast<intptr_t>(value));
+        res = HIRRange::New(num, num);
+      }
+      break;
+    case HIRInstruction::kBinOp:
+      {
+        HIRRange* l = FindRange(instr->left());
+        HIRRange* r = FindRange(instr->right());
+        if (l == NULL || r == NULL) break;
+
+        switch (HIRBinOp::Cast(instr)->binop_type()) {
+          case BinOp::kAdd:
+            res = HIRRange::New(l->min + r->min, l->max + r->max);
+            break;
+          case BinOp::kSub:
+            res = HIRRange::New(l->min - r->max, l->max - r->min);
+            break;
+          case BinOp::kMul:
+            {
+              int64_t a = l->min * r->min;
+              int64_t b = l->min * r->max;
+              int64_t c = l->max * r->min;
+              int64_t d = l->max * r->max;
+              res = HIRRange::New(Min(Min(a, b), Min(c, d)),
+                                  Max(Max(a, b), Max(c, d)));
+            }
+            break;
+          default:
+            break;
+        }
+      }
+      break;
+    case HIRInstruction::kPhi:
+      {
+        HIRPhi* phi = HIRPhi::Cast(instr);
+        if (phi->block()->IsLoop()) {
+          res = FindInductionRange(phi);
+          break;
+        }
+
+        for (int i = 0; i < phi->input_count(); i++) {
+          HIRRange* input = FindRange(phi->InputAt(i));
+          if (input == NULL) {
+            res = NULL;
+            break;
+          }
+
+          if (res == NULL) {
+            res = new HIRRange(input->min, input->max);
+          } else {
+            res->min = Min(res->min, input->min);
+            res->max = Max(res->max, input->max);
+          }
+        }
+      }
+      break;
+    default:
+      break;
+  }
+
+  instr->range(res);
+  return res;
+}
+
+
+HIRRange* HIRGen::FindInductionRange(HIRPhi* phi) {
+  if (phi->input_count() != 2) return NULL;
+
+  HIRRange* init = FindRange(phi->InputAt(0));
+  HIRInstruction* next = phi->InputAt(1);
+  if (init == NULL || !next->Is(HIRInstruction::kBinOp)) return NULL;
+
+  // Counter should change by a constant step on every iteration
+  BinOp::BinOpType type = HIRBinOp::Cast(next)->binop_type();
+  HIRInstruction* step_value = NULL;
+  if (next->left() == phi) {
+    step_value = next->right();
+  } else if (type == BinOp::kAdd && next->right() == phi) {
+    step_value = next->left();
+  }
+  if (step_value == NULL || step_value == phi) return NULL;
+
+  HIRRange* step_range = FindRange(step_value);
+  if (step_range == NULL || step_range->min != step_range->max) return NULL;
+
+  int64_t step;
+  if (type == BinOp::kAdd) {
+    step = step_range->min;
+  } else if (type == BinOp::kSub) {
+    step = -step_range->min;
+  } else {
+    return NULL;
+  }
+  if (step == 0) return NULL;
+
+  // Loop's condition is in the block following the header (see VisitWhile),
+  // `&&` and `||` start new blocks, so branch there is the loop's exit
+  HIRBlock* cond_block = phi->block()->SuccAt(0);
+  if (cond_block == NULL || cond_block->instructions()->length() == 0) {
+    return NULL;
+  }
+  HIRInstruction* branch = cond_block->instructions()->tail()->value();
+  if (!branch->Is(HIRInstruction::kIf)) return NULL;
+  HIRInstruction* cond = branch->left();
+
+  // Counter may be tested either before or after the change,
+  // loop continues while `phi + offset` is on the `bound`'s side
+  int64_t offset;
+  int64_t bound;
+  if (cond == phi || cond == next) {
+    // while (i--) {}, while (--i) {}
+    offset = cond == phi ? 0 : step;
+    if (step == -1 && init->min + offset >= 0) {
+      bound = 1;
+    } else if (step == 1 && init->max + offset <= 0) {
+      bound = -1;
+    } else {
+      return NULL;
+    }
+  } else if (cond->Is(HIRInstruction::kBinOp)) {
+    // while (i < n) {}, while (++i <= n) {}
+    BinOp::BinOpType op = HIRBinOp::Cast(cond)->binop_type();
+    HIRInstruction* tested = cond->left();
+    HIRInstruction* limit = cond->right();
+    if (limit == phi || limit == next) {
+      tested = cond->right();
+      limit = cond->left();
+      switch (op) {
+        case BinOp::kLt: op = BinOp::kGt; break;
+        case BinOp::kGt: op = BinOp::kLt; break;
+        case BinOp::kLe: op = BinOp::kGe; break;
+        case BinOp::kGe: op = BinOp::kLe; break;
+        default: break;
+      }
+    }
+    if (tested != phi && tested != next) return NULL;
+    offset = tested == phi ? 0 : step;
+
+    HIRRange* limit_range = FindRange(limit);
+    if (limit_range == NULL) return NULL;
+
+    if (step > 0 && op == BinOp::kLt) {
+      bound = limit_range->max - 1;
+    } else if (step > 0 && op == BinOp::kLe) {
+      bound = limit_range->max;
+    } else if (step < 0 && op == BinOp::kGt) {
+      bound = limit_range->min + 1;
+    } else if (step < 0 && op == BinOp::kGe) {
+      bound = limit_range->min;
+    } else {
+      return NULL;
+    }
+  } else {
+    return NULL;
+  }
+
+  // Value that will be taken by counter after the last successful check
+  int64_t last = bound - offset + step;
+  if (step > 0) {
+    return HIRRange::New(init->min, Max(init->max, last));
+  } else {
+    return HIRRange::New(Min(init->min, last), init->max);
+  }
+}
+
+
+void HIRGen::UnpinContextLoads() {
+  ScopeSlot::UseList stores;
+
+  // Calls may change any captured variable
+  HIRBlockList::Item* bhead = blocks_.head();
+  for (; bhead != NULL; bhead = bhead->next()) {
+    HIRInstructionList::Item* ihead = bhead->value()->instructions()->head();
+    for (; ihead != NULL; ihead = ihead->next()) {
+      HIRInstruction* instr = ihead->value();
+      if (instr->Is(HIRInstruction::kCall)) return;
+      if (instr->Is(HIRInstruction::kStoreContext)) {
+        stores.Push(HIRStoreContext::Cast(instr)->context_slot());
+      }
+    }
+  }
+
+  // Loads of variables that are never changed may be moved out of loops
+  bhead = blocks_.head();
+  for (; bhead != NULL; bhead = bhead->next()) {
+    HIRInstructionList::Item* ihead = bhead->value()->instructions()->head();
+    for (; ihead != NULL; ihead = ihead->next()) {
+      HIRInstruction* instr = ihead->value();
+      if (!instr->Is(HIRInstruction::kLoadContext)) continue;
+
+      ScopeSlot* slot = HIRLoadContext::Cast(instr)->context_slot();
+      ScopeSlot::UseList::Item* shead = stores.head();
+      for (; shead != NULL; shead = shead->next()) {
+        if (shead->value()->is_equal(slot)) break;
+      }
+
+      if (shead == NULL) instr->Unpin();
+    }
+  }
+}
+
+
+void HIRGen::PropagateConstants() {
+  bool change;
+  do {
+    change = false;
+
+    HIRBlockList::Item* bhead = blocks_.head();
+    for (; bhead != NULL; bhead = bhead->next()) {
+      HIRBlock* block = bhead->value();
+
+      HIRInstructionList::Item* ihead = block->instructions()->head();
+      HIRInstructionList::Item* next;
+      for (; ihead != NULL; ihead = next) {
+        HIRInstruction* instr = ihead->value();
+        next = ihead->next();
+
+        HIRInstruction* value = FoldConstant(instr);
+        if (value == NULL) continue;
+
+        // Put new literal right before the folded instruction
+        if (value->block() == NULL) {
+          block->instructions()->InsertBefore(ihead, value);
+          value->Init(this, block);
+        }
+
+        Replace(instr, value);
+        block->Remove(instr);
+        change = true;
+      }
+
+      if (FoldBranch(block)) change = true;
+    }
+
+    if (change && RemoveDeadBlocks()) change = true;
+  } while (change);
+}
+
+
+HIRInstruction* HIRGen::FoldConstant(HIRInstruction* instr) {
+  switch (instr->type()) {
+    case HIRInstruction::kBinOp:
+      {
+        HIRInstruction* l = instr->left();
+        HIRInstruction* r = instr->right();
+        BinOp::BinOpType type = HIRBinOp::Cast(instr)->binop_type();
+        if (!l->Is(HIRInstruction::kLiteral) ||
+            !r->Is(HIRInstruction::kLiteral)) {
+          return NULL;
+        }
+
+        // Compare strings by contents (i.e. `typeof a == "number"`)
+        if (l->IsString() && r->IsString() && BinOp::is_equality(type)) {
+          bool eq = IsEqualKey(l, r) != BinOp::is_negative_eq(type);
+          return CreateRootLiteral(eq ? AstNode::kTrue : AstNode::kFalse,
+                                   eq ? Heap::kRootTrueIndex :
+                                        Heap::kRootFalseIndex);
+        }
+
+        ScopeSlot* lslot = HIRLiteral::Cast(l)->root_slot();
+        ScopeSlot* rslot = HIRLiteral::Cast(r)->root_slot();
+        if (!l->IsNumber() || !lslot->is_immediate() ||
+            !r->IsNumber() || !rslot->is_immediate()) {
+          return NULL;
+        }
+
+        int64_t a = HNumber::Untag(reinterpret_cast<intptr_t>(lslot->value()));
+        int64_t b = HNumber::Untag(reinterpret_cast<intptr_t>(rslot->value()));
+        int64_t res;
+        bool cmp;
+
+        // Results of wider operands may not fit into 64 bits
+        if (!BinOp::is_logic(type) &&
+            (a < HIRRange::kMin || a > HIRRange::kMax ||
+             b < HIRRange::kMin || b > HIRRange::kMax)) {
+          return NULL;
+        }
+
+        switch (type) {
+          case BinOp::kAdd: res = a + b; break;
+          case BinOp::kSub: res = a - b; break;
+          case BinOp::kMul: res = a * b; break;
+          case BinOp::kBAnd: res = a & b; break;
+          case BinOp::kBOr: res = a | b; break;
+          case BinOp::kBXor: res = a ^ b; break;
+          case BinOp::kEq:
+          case BinOp::kStrictEq: cmp = a == b; break;
+          case BinOp::kNe:
+          case BinOp::kStrictNe: cmp = a != b; break;
+          case BinOp::kLt: cmp = a < b; break;
+          case BinOp::kGt: cmp = a > b; break;
+          case BinOp::kLe: cmp = a <= b; break;
+          case BinOp::kGe: cmp = a >= b; break;
+          default:
+            // Division, modulo and shifts follow the runtime's number rules
+            return NULL;
+        }
+
+        if (BinOp::is_logic(type)) {
+          return CreateRootLiteral(cmp ? AstNode::kTrue : AstNode::kFalse,
+                                   cmp ? Heap::kRootTrueIndex :
+                                         Heap::kRootFalseIndex);
+        }
+
+        // Results that are not SMIs on every platform are left to runtime
+        if (res < HIRRange::kMin || res > HIRRange::kMax) return NULL;
+        return CreateSmi(res);
+      }
+    case HIRInstruction::kNot:
+      {
+        int truth = ConstantTruth(instr->left());
+        if (truth == -1) return NULL;
+
+        return CreateRootLiteral(truth ? AstNode::kFalse : AstNode::kTrue,
+                                 truth ? Heap::kRootFalseIndex :
+                                         Heap::kRootTrueIndex);
+      }
+    case HIRInstruction::kTypeof:
+      {
+        HIRInstruction* arg = instr->left();
+        int index;
+        switch (arg->type()) {
+          case HIRInstruction::kNil: index = Heap::kRootNilTypeIndex; break;
+          case HIRInstruction::kFunction:
+            index = Heap::kRootFunctionTypeIndex;
+            break;
+          case HIRInstruction::kAllocateObject:
+            index = Heap::kRootObjectTypeIndex;
+            break;
+          case HIRInstruction::kAllocateArray:
+            index = Heap::kRootArrayTypeIndex;
+            break;
+          case HIRInstruction::kLiteral:
+            if (arg->IsNumber()) {
+              index = Heap::kRootNumberTypeIndex;
+            } else if (arg->IsString()) {
+              index = Heap::kRootStringTypeIndex;
+            } else if (arg->IsBoolean()) {
+              index = Heap::kRootBooleanTypeIndex;
+            } else {
+              return NULL;
+            }
+            break;
+          default:
+            return NULL;
+        }
+
+        return CreateRootLiteral(AstNode::kString, index);
+      }
+    case HIRInstruction::kPhi:
+      {
+        // All inputs (except phi itself) are the same constant
+        HIRPhi* phi = HIRPhi::Cast(instr);
+        HIRInstruction* value = NULL;
+        for (int i = 0; i < phi->input_count(); i++) {
+          HIRInstruction* input = phi->InputAt(i);
+          if (input == phi) continue;
+          if (!input->Is(HIRInstruction::kLiteral)) return NULL;
+
+          if (value == NULL) {
+            value = input;
+          } else if (!HIRLiteral::Cast(value)->root_slot()->is_equal(
+                         HIRLiteral::Cast(input)->root_slot())) {
+            return NULL;
+          }
+        }
+
+        return value;
+      }
+    default:
+      return NULL;
+  }
+}
+
+
+bool HIRGen::FoldBranch(HIRBlock* block) {
+  if (block->instructions()->length() == 0) return false;
+
+  HIRInstruction* branch = block->instructions()->tail()->value();
+  if (!branch->Is(HIRInstruction::kIf)) return false;
+
+  int truth = ConstantTruth(branch->left());
+  if (truth == -1) return false;
+
+  HIRBlock* dead = block->SuccAt(truth ? 1 : 0);
+  HIRInstruction* jump = new HIRGoto();
+  jump->ast(branch->ast());
+  jump->Init(this, block);
+
+  // Block is already ended, so put goto in place of the branch
+  block->Remove(branch);
+  block->instructions()->Push(jump);
+  block->RemoveSuccessor(dead);
+
+  return true;
+}
+
+
+bool HIRGen::RemoveDeadBlocks() {
+  int* reachable = reinterpret_cast<int*>(Zone::current()->Allocate(
+      sizeof(*reachable) * blocks_.length()));
+  memset(reachable, 0, sizeof(*reachable) * blocks_.length());
+
+  HIRBlockList work_queue;
+  HIRBlockList::Item* rhead = roots_.head();
+  for (; rhead != NULL; rhead = rhead->next()) {
+    work_queue.Push(rhead->value());
+  }
+
+  HIRBlock* b;
+  while ((b = work_queue.Shift()) != NULL) {
+    if (reachable[b->id]) continue;
+    reachable[b->id] = 1;
+
+    for (int i = 0; i < b->succ_count(); i++) work_queue.Push(b->SuccAt(i));
+  }
+
+  bool change = false;
+  HIRInstruction* nil = NULL;
+  HIRBlockList::Item* bhead = blocks_.head();
+  for (; bhead != NULL; bhead = bhead->next()) {
+    HIRBlock* block = bhead->value();
+    if (reachable[block->id]) continue;
+
+    while (block->succ_count() > 0) {
+      block->RemoveSuccessor(block->SuccAt(0));
+      change = true;
+    }
+
+    HIRInstruction* instr;
+    while (block->instructions()->length() > 0) {
+      instr = block->instructions()->head()->value();
+
+      // Variables assigned only on the removed path are nil on live ones
+      HIRInstructionList live_uses;
+      HIRInstructionList::Item* uhead = instr->uses()->head();
+      for (; uhead != NULL; uhead = uhead->next()) {
+        HIRInstruction* use = uhead->value();
+        if (reachable[use->block()->id]) live_uses.Push(use);
+      }
+
+      if (live_uses.length() > 0 && nil == NULL) {
+        HIRBlock* root = roots_.head()->value();
+        HIRInstructionList::Item* entry = root->instructions()->head();
+
+        nil = new HIRNil();
+        nil->Unpin();
+        root->instructions()->InsertBefore(entry->next(), nil);
+        nil->Init(this, root);
+      }
+
+      uhead = live_uses.head();
+      for (; uhead != NULL; uhead = uhead->next()) {
+        uhead->value()->ReplaceArg(instr, nil);
+      }
+
+      block->Remove(instr);
+    }
+  }
+
+  return change;
+}
+
+
+HIRInstruction* HIRGen::CreateLiteral(AstNode::Type type, ScopeSlot* slot) {
+  return (new HIRLiteral(type, slot))->Unpin();
+}
+
+
+HIRInstruction* HIRGen::CreateSmi(int64_t value) {
+  ScopeSlot* slot = new ScopeSlot(ScopeSlot::kContext, -2);
+  slot->type(ScopeSlot::kImmediate);
+  slot->value(HNumber::New(root()->heap(), value));
+
+  return CreateLiteral(AstNode::kNumber, slot);
+}
+
+
+HIRInstruction* HIRGen::CreateRootLiteral(AstNode::Type type, int index) {
+  ScopeSlot* slot = new ScopeSlot(ScopeSlot::kContext, -2);
+  slot->index(index);
+
+  return CreateLiteral(type, slot);
+}
+
+
+int HIRGen::ConstantTruth(HIRInstruction* instr) {
+  if (instr->Is(HIRInstruction::kNil)) return 0;
+  if (!instr->Is(HIRInstruction::kLiteral)) return -1;
+
+  HIRLiteral* lit = HIRLiteral::Cast(instr);
+  switch (lit->literal_type()) {
+    case AstNode::kTrue: return 1;
+    case AstNode::kFalse: return 0;
+    case AstNode::kNumber:
+      if (!lit->root_slot()->is_immediate()) return -1;
+      return lit->root_slot()->value() == HNumber::New(root()->heap(), 0) ?
+          0 : 1;
+    default:
+      return -1;
+  }
+}
+
+
+void HIRGen::ScalarReplacement() {
+  HIRInstructionList allocs;
+
+  HIRBlockList::Item* bhead = blocks_.head();
+  for (; bhead != NULL; bhead = bhead->next()) {
+    HIRInstructionList::Item* ihead = bhead->value()->instructions()->head();
+    for (; ihead != NULL; ihead = ihead->next()) {
+      HIRInstruction* instr = ihead->value();
+      if (instr->Is(HIRInstruction::kAllocateObject) ||
+          instr->Is(HIRInstruction::kAllocateArray)) {
+        allocs.Push(instr);
+      }
+    }
+  }
+
+  HIRInstructionList::Item* ahead = allocs.head();
+  for (; ahead != NULL; ahead = ahead->next()) {
+    ScalarReplace(ahead->value());
+  }
+}
+
+
+bool HIRGen::ScalarReplace(HIRInstruction* alloc) {
+  // Object escapes if it's used by anything except property accesses with
+  // constant keys, or if it's changed outside of the block that created it
+  HIRInstructionList::Item* uhead = alloc->uses()->head();
+  for (; uhead != NULL; uhead = uhead->next()) {
+    HIRInstruction* use = uhead->value();
+
+    if (use->Is(HIRInstruction::kStoreProperty)) {
+      if (use->block() != alloc->block() || use->third() == alloc) {
+        return false;
+      }
+    } else if (!use->Is(HIRInstruction::kLoadProperty)) {
+      return false;
+    }
+    if (use->left() != alloc || !IsScalarKey(alloc, use->right())) {
+      return false;
+    }
+  }
+
+  // Replay stores in the allocation's block, loads there see the values
+  // stored before them
+  HIRInstructionList stores;
+  HIRInstructionList loads;
+  HIRInstructionList values;
+  HIRInstructionList::Item* ihead = alloc->block()->instructions()->head();
+  while (ihead->value() != alloc) ihead = ihead->next();
+  for (; ihead != NULL; ihead = ihead->next()) {
+    HIRInstruction* instr = ihead->value();
+    if (!instr->Is(HIRInstruction::kStoreProperty) &&
+        !instr->Is(HIRInstruction::kLoadProperty)) {
+      continue;
+    }
+    if (instr->left() != alloc) continue;
+
+    HIRInstructionList::Item* store = FindStore(&stores, instr->right());
+    if (instr->Is(HIRInstruction::kStoreProperty)) {
+      if (store != NULL) stores.Remove(store);
+      stores.Push(instr);
+    } else {
+      // Property is missing, keep the object
+      if (store == NULL) return false;
+      loads.Push(instr);
+      values.Push(store->value()->third());
+    }
+  }
+
+  // Loads in other blocks see the final values
+  uhead = alloc->uses()->head();
+  for (; uhead != NULL; uhead = uhead->next()) {
+    HIRInstruction* use = uhead->value();
+    if (use->block() == alloc->block()) continue;
+
+    HIRInstructionList::Item* store = FindStore(&stores, use->right());
+    if (store == NULL) return false;
+    loads.Push(use);
+    values.Push(store->value()->third());
+  }
+
+  HIRInstructionList::Item* lhead = loads.head();
+  HIRInstructionList::Item* vhead = values.head();
+  for (; lhead != NULL; lhead = lhead->next(), vhead = vhead->next()) {
+    HIRInstruction* load = lhead->value();
+
+    Replace(load, vhead->value());
+    load->block()->Remove(load);
+  }
+
+  // Only stores are left
+  HIRInstruction* use;
+  while ((use = alloc->uses()->Shift()) != NULL) {
+    use->block()->Remove(use);
+  }
+  alloc->block()->Remove(alloc);
+
+  return true;
+}
+
+
+bool HIRGen::IsScalarKey(HIRInstruction* alloc, HIRInstruction* key) {
+  if (!key->Is(HIRInstruction::kLiteral)) return false;
+
+  // Arrays are indexed by numbers and objects by strings, other kinds of keys
+  // may be converted and alias each other
+  if (alloc->Is(HIRInstruction::kAllocateArray)) {
+    return key->representation() == HIRInstruction::kSmiRepresentation;
+  } else {
+    return key->representation() == HIRInstruction::kStringRepresentation;
+  }
+}
+
+
+bool HIRGen::IsEqualKey(HIRInstruction* a, HIRInstruction* b) {
+  ScopeSlot* aslot = HIRLiteral::Cast(a)->root_slot();
+  ScopeSlot* bslot = HIRLiteral::Cast(b)->root_slot();
+
+  if (aslot->is_equal(bslot)) return true;
+  if (aslot->is_immediate() || bslot->is_immediate()) return false;
+
+  // Equal strings may live in different root slots
+  char* avalue = root()->Get(aslot->index());
+  char* bvalue = root()->Get(bslot->index());
+  assert(avalue != NULL && bvalue != NULL);
+
+  uint32_t length = HString::Length(avalue);
+  if (length != HString::Length(bvalue)) return false;
+
+  return memcmp(HString::Value(root()->heap(), avalue),
+                HString::Value(root()->heap(), bvalue),
+                length) == 0;
+}
+
+
+HIRInstructionList::Item* HIRGen::FindStore(HIRInstructionList* stores,
+                                            HIRInstruction* key) {
+  HIRInstructionList::Item* head = stores->head();
+  for (; head != NULL; head = head->next()) {
+    if (IsEqualKey(head->value()->right(), key)) return head;
+  }
+
+  return NULL;
+}
+
+
 void HIRGen::GlobalCodeMotion() {
   HIRInstructionList instructions_;
 
@@ -565,7 +1271,9 @@ void HIRGen::ScheduleEarly(HIRInstruction* instr, HIRBlock* root) {
   if (instr->IsPinned()) return;
 
   // Start with the shallowest dominator
-  if (instr->effects_in()->length() == 0) instr->block(root);
+  if (instr->effects_in()->length() == 0 && !instr->HasUnknownEffects()) {
+    instr->block(root);
+  }
 
   // Schedule all inputs
   HIRInstructionList::Item* ahead = instr->args()->head();
@@ -606,6 +1314,16 @@ void HIRGen::ScheduleLate(HIRInstruction* instr) {
 
   if (lca == NULL) lca = instr->block();
 
+  // Reads of objects that are changed somewhere can't be moved down past the
+  // stores, keep them in the earliest block if it dominates all uses
+  if ((instr->Is(HIRInstruction::kLoadProperty) ||
+       instr->Is(HIRInstruction::kKeysof) ||
+       instr->Is(HIRInstruction::kSizeof)) &&
+      instr->left()->effects_out()->length() != 0 &&
+      FindLCA(lca, instr->block()) == instr->block()) {
+    return;
+  }
+
   // Select best block between ->block() and lca
   HIRBlock* best = lca;
 
@@ -629,17 +1347,32 @@ void HIRGen::ScheduleLate(HIRInstruction* instr) {
 HIRBlock* HIRGen::FindLCA(HIRBlock* a, HIRBlock* b) {
   if (a == NULL) return b;
 
+  // Climb to the same depth, jumping when it doesn't skip it
   while (a->dominator_depth() > b->dominator_depth()) {
-    a = a->dominator();
+    if (a->dominator_jump()->dominator_depth() >= b->dominator_depth()) {
+      a = a->dominator_jump();
+    } else {
+      a = a->dominator();
+    }
   }
 
   while (b->dominator_depth() > a->dominator_depth()) {
-    b = b->dominator();
+    if (b->dominator_jump()->dominator_depth() >= a->dominator_depth()) {
+      b = b->dominator_jump();
+    } else {
+      b = b->dominator();
+    }
   }
 
+  // Jumps of blocks at the same depth lead to the same depth too
   while (a != b) {
-    a = a->dominator();
-    b = b->dominator();
+    if (a->dominator_jump() != b->dominator_jump()) {
+      a = a->dominator_jump();
+      b = b->dominator_jump();
+    } else {
+      a = a->dominator();
+      b = b->dominator();
+    }
   }
 
   return a;
@@ -662,8 +1395,34 @@ HIRInstruction* HIRGen::VisitFunction(AstNode* stmt) {
   }
 
   if (current_root() == current_block() &&
-      current_block()->IsEmpty()) {
-    Add(new HIREntry(fn->label(), stmt->context_slots()));
+      current_block()->IsEmpty() &&
+      osr_loop() != NULL) {
+    Add(new HIREntry(fn->label(), stmt->context_slots(), true));
+
+    // Arguments and context are already in the baseline frame,
+    // take values of all stack variables from it
+    for (int i = 0; i < stmt->stack_slots(); i++) {
+      ScopeSlot* slot = new ScopeSlot(ScopeSlot::kStack);
+      slot->index(i);
+
+      Assign(slot, Add(new HIRLoadOsr(slot)));
+    }
+
+    // And continue from the loop's head
+    AstList::Item* head = stmt->children()->head();
+    while (head->value() != osr_loop()) head = head->next();
+    for (; head != NULL; head = head->next()) Visit(head->value());
+
+    if (!current_block()->IsEnded()) {
+      HIRInstruction* val = Add(new HIRNil());
+      HIRInstruction* end = Return(new HIRReturn());
+      end->AddArg(val);
+    }
+
+    return NULL;
+  } else if (current_root() == current_block() &&
+             current_block()->IsEmpty()) {
+    Add(new HIREntry(fn->label(), stmt->context_slots(), false));
     HIRInstruction* index = NULL;
     int flat_index = 0;
     bool seen_varg = false;
@@ -791,6 +1550,13 @@ HIRInstruction* HIRGen::VisitAssign(AstNode* stmt) {
 
 HIRInstruction* HIRGen::VisitReturn(AstNode* stmt) {
   HIRInstruction* lhs = Visit(stmt->lhs());
+
+  // Inlined function returns to the call site
+  if (inline_info_ != NULL) {
+    InlineReturn(lhs);
+    return lhs;
+  }
+
   return Return(new HIRReturn())->AddArg(lhs);
 }
 
@@ -799,20 +1565,25 @@ HIRInstruction* HIRGen::VisitValue(AstNode* stmt) {
   AstValue* value = AstValue::Cast(stmt);
   ScopeSlot* slot = value->slot();
   if (slot->is_stack()) {
-    HIRInstruction* i = current_block()->env()->At(slot);
+    return LoadStack(slot);
+  } else {
+    return Add(new HIRLoadContext(slot));
+  }
+}
 
-    if (i != NULL && i->block() == current_block()) {
-      // Local value
-      return i;
-    } else {
-      HIRPhi* phi = CreatePhi(slot);
-      if (i != NULL) phi->AddInput(i);
 
-      // External value
-      return Add(Assign(slot, phi));
-    }
+HIRInstruction* HIRGen::LoadStack(ScopeSlot* slot) {
+  HIRInstruction* i = current_block()->env()->At(slot);
+
+  if (i != NULL && i->block() == current_block()) {
+    // Local value
+    return i;
   } else {
-    return Add(new HIRLoadContext(slot));
+    HIRPhi* phi = CreatePhi(slot);
+    if (i != NULL) phi->AddInput(i);
+
+    // External value
+    return Add(Assign(slot, phi));
   }
 }
 
@@ -847,12 +1618,26 @@ HIRInstruction* HIRGen::VisitWhile(AstNode* stmt) {
   BreakContinueInfo* old = break_continue_info_;
   HIRBlock* start = CreateBlock();
 
-  current_block()->MarkPreLoop();
+  // Inlined bodies use stack slots after the function's ones
+  HIRLoopAnalyze analyze(stmt);
+  if (analyze.has_calls()) {
+    HIRInlineList::Item* ihead = inline_candidates_.head();
+    for (; ihead != NULL; ihead = ihead->next()) {
+      int result = ihead->value()->result()->index();
+      for (int i = result - ihead->value()->fn()->stack_slots();
+           i <= result;
+           i++) {
+        analyze.slots()->Set(i);
+      }
+    }
+  }
+
+  current_block()->MarkPreLoop(analyze.slots());
   Goto(start);
 
   // HIRBlock can't be join and branch at the same time
   set_current_block(CreateBlock());
-  start->MarkLoop();
+  start->MarkLoop(analyze.slots());
   start->Goto(current_block());
 
   HIRInstruction* cond = Visit(stmt->lhs());
@@ -925,6 +1710,7 @@ HIRInstruction* HIRGen::VisitUnOp(AstNode* stmt) {
       res = Visit(wrap);
       load = res->args()->head()->value();
       value = res;
+      AddFeedback(value, stmt);
     } else {
       HIRInstruction* ione = Visit(one);
       res = Visit(op->lhs());
@@ -936,6 +1722,7 @@ HIRInstruction* HIRGen::VisitUnOp(AstNode* stmt) {
           ->AddArg(ione);
 
       bin->ast(wrap);
+      AddFeedback(bin, stmt);
       value = bin;
     }
 
@@ -991,6 +1778,7 @@ HIRInstruction* HIRGen::VisitBinOp(AstNode* stmt) {
     HIRInstruction* lhs = Visit(op->lhs());
     HIRInstruction* rhs = Visit(op->rhs());
     res = Add(new HIRBinOp(op->subtype()))->Unpin()->AddArg(lhs)->AddArg(rhs);
+    AddFeedback(res, stmt);
   } else {
     HIRInstruction* lhs = Visit(op->lhs());
     HIRBlock* branch = CreateBlock();
@@ -1104,6 +1892,9 @@ HIRInstruction* HIRGen::VisitCall(AstNode* stmt) {
     }
   }
 
+  HIRInstruction* inlined = VisitInlined(fn);
+  if (inlined != NULL) return inlined;
+
   // Generate all arg's values and populate list of stores
   HIRInstruction* vararg = NULL;
   HIRInstructionList stores_;
@@ -1307,6 +2098,7 @@ HIRBlock::HIRBlock(HIRGen* g) : id(g->block_id()),
                                 semi_(this),
                                 dominator_(NULL),
                                 dominator_depth_(-1),
+                                dominator_jump_(NULL),
                                 lir_(NULL),
                                 start_id_(-1),
                                 end_id_(-1) {
@@ -1373,10 +2165,10 @@ void HIRBlock::AddPredecessor(HIRBlock* b) {
 }
 
 
-void HIRBlock::MarkPreLoop() {
-  // Every slot that wasn't seen before should have nil value
+void HIRBlock::MarkPreLoop(HIRSlotSet* slots) {
+  // Every slot used in loop that wasn't seen before should have nil value
   for (int i = 0; i < env()->stack_slots() - 1; i++) {
-    if (env()->At(i) != NULL) continue;
+    if (env()->At(i) != NULL || !slots->Test(i)) continue;
 
     ScopeSlot* slot = new ScopeSlot(ScopeSlot::kStack);
     slot->index(i);
@@ -1386,11 +2178,13 @@ void HIRBlock::MarkPreLoop() {
 }
 
 
-void HIRBlock::MarkLoop() {
+void HIRBlock::MarkLoop(HIRSlotSet* slots) {
   loop_ = true;
 
-  // Create phi for every possible value (except logic_slot)
+  // Create phi for every value used in loop (except logic_slot), others
+  // can't be changed by it
   for (int i = 0; i < env()->stack_slots() - 1; i++) {
+    if (!slots->Test(i)) continue;
     ScopeSlot* slot = new ScopeSlot(ScopeSlot::kStack);
     slot->index(i);
 
@@ -1403,6 +2197,195 @@ void HIRBlock::MarkLoop() {
 }
 
 
+void HIRGen::AddFeedback(HIRInstruction* instr, AstNode* site) {
+  CodeProfile* p = inline_info_ == NULL ? profile() : inline_profile_;
+
+  // Nodes created by compiler itself have no id
+  if (p == NULL || site->id == -1) return;
+  if (!instr->Is(HIRInstruction::kBinOp)) return;
+
+  HIRBinOp::Cast(instr)->feedback(p->FeedbackKinds(site->id));
+}
+
+
+int HIRGen::FindInlineCandidates(FunctionLiteral* fn) {
+  HIRInlineAnalyze caller(fn);
+  int slots = 0;
+
+  // Only functions assigned once at the top level of the body are known at
+  // every call site that follows the assignment
+  AstList::Item* head = fn->children()->head();
+  for (; head != NULL; head = head->next()) {
+    AstNode* node = head->value();
+    if (!node->is(AstNode::kAssign) ||
+        !node->lhs()->is(AstNode::kValue) ||
+        !node->rhs()->is(AstNode::kFunction)) {
+      continue;
+    }
+
+    ScopeSlot* slot = AstValue::Cast(node->lhs())->slot();
+    FunctionLiteral* callee = FunctionLiteral::Cast(node->rhs());
+    if (!slot->is_stack() || caller.assigns(slot) != 1) continue;
+
+    // Small leaf functions without own context
+    if (callee->own_length() > static_cast<uint32_t>(kMaxInlineSize) ||
+        callee->context_slots() != 0) {
+      continue;
+    }
+
+    bool has_vararg = false;
+    AstList::Item* arg = callee->args()->head();
+    for (; arg != NULL; arg = arg->next()) {
+      if (arg->value()->is(AstNode::kVarArg)) has_vararg = true;
+    }
+    if (has_vararg) continue;
+
+    HIRInlineAnalyze analyze(callee);
+    if (!analyze.is_leaf()) continue;
+
+    // Put callee's variables after the caller's ones
+    int offset = fn->stack_slots() + slots;
+    ScopeSlot* result = new ScopeSlot(ScopeSlot::kStack);
+    result->index(offset + callee->stack_slots());
+
+    HIRInlineInfo* info = new HIRInlineInfo(callee, result, offset);
+    analyze.Relocate(info);
+    inline_candidates_.Push(info);
+    slots += callee->stack_slots() + 1;
+  }
+
+  return slots;
+}
+
+
+// Follows phis to the function that is the only value of variable
+static HIRFunction* ResolveFunction(HIRInstruction* instr, int depth) {
+  if (instr == NULL) return NULL;
+  if (instr->Is(HIRInstruction::kFunction)) return HIRFunction::Cast(instr);
+  if (!instr->Is(HIRInstruction::kPhi) || depth == 0) return NULL;
+
+  HIRPhi* phi = HIRPhi::Cast(instr);
+  HIRFunction* res = NULL;
+  for (int i = 0; i < phi->input_count(); i++) {
+    if (phi->InputAt(i) == phi) continue;
+
+    HIRFunction* input = ResolveFunction(phi->InputAt(i), depth - 1);
+    if (input == NULL || (res != NULL && res != input)) return NULL;
+    res = input;
+  }
+
+  return res;
+}
+
+
+HIRInstruction* HIRGen::VisitInlined(FunctionLiteral* call) {
+  // Nested inlining isn't possible: callees have no inner functions
+  if (inline_info_ != NULL) return NULL;
+  if (!call->variable()->is(AstNode::kValue)) return NULL;
+
+  AstList::Item* arg = call->args()->head();
+  for (; arg != NULL; arg = arg->next()) {
+    if (arg->value()->is(AstNode::kSelf) ||
+        arg->value()->is(AstNode::kVarArg)) {
+      return NULL;
+    }
+  }
+
+  ScopeSlot* slot = AstValue::Cast(call->variable())->slot();
+  if (!slot->is_stack()) return NULL;
+
+  HIRFunction* f = ResolveFunction(current_block()->env()->At(slot), 8);
+  if (f == NULL) return NULL;
+
+  HIRInlineInfo* info = NULL;
+  HIRInlineList::Item* head = inline_candidates_.head();
+  for (; head != NULL; head = head->next()) {
+    if (head->value()->fn() == f->ast()) {
+      info = head->value();
+      break;
+    }
+  }
+  if (info == NULL) return NULL;
+
+  FunctionLiteral* fn = info->fn();
+  if (inlined_size_ + fn->own_length() > static_cast<uint32_t>(kMaxInlinedSize)) {
+    return NULL;
+  }
+  inlined_size_ += fn->own_length();
+
+  // Evaluate arguments in the caller
+  HIRInstructionList args;
+  for (arg = call->args()->head(); arg != NULL; arg = arg->next()) {
+    args.Push(Visit(arg->value()));
+  }
+
+  // Variables of the previous inlined copy should not leak into this one
+  int start = info->result()->index() - fn->stack_slots();
+  for (int i = start; i < info->result()->index(); i++) {
+    ScopeSlot* local = new ScopeSlot(ScopeSlot::kStack);
+    local->index(i);
+
+    Assign(local, Add(new HIRNil()));
+  }
+
+  HIRInstructionList::Item* value = args.head();
+  for (arg = fn->args()->head(); arg != NULL; arg = arg->next()) {
+    ScopeSlot* local = AstValue::Cast(arg->value())->slot();
+    Assign(local, value == NULL ? Add(new HIRNil()) : value->value());
+
+    if (value != NULL) value = value->next();
+  }
+
+  // Inlined sites are profiled by the callee's baseline code
+  CodeProfile* callee_profile = NULL;
+  if (profile() != NULL && fn->label() != NULL) {
+    CodeProfileList::Item* phead = profile()->chunk()->profiles()->head();
+    for (; phead != NULL; phead = phead->next()) {
+      if (phead->value()->entry() == fn->label()->addr()) {
+        callee_profile = phead->value();
+        break;
+      }
+    }
+  }
+
+  BreakContinueInfo* old_break_continue = break_continue_info_;
+  break_continue_info_ = NULL;
+  inline_info_ = info;
+  inline_profile_ = callee_profile;
+  inline_loop_depth_ = loop_depth_;
+
+  VisitChildren(fn);
+  if (!current_block()->IsEnded()) InlineReturn(Add(new HIRNil()));
+
+  assert(inline_return_ != NULL);
+  set_current_block(inline_return_);
+  HIRInstruction* result = LoadStack(info->result());
+
+  break_continue_info_ = old_break_continue;
+  inline_info_ = NULL;
+  inline_profile_ = NULL;
+  inline_return_ = NULL;
+  current_node_ = call;
+
+  return result;
+}
+
+
+void HIRGen::InlineReturn(HIRInstruction* value) {
+  Assign(inline_info_->result(), value);
+
+  // NOTE: Return blocks are created lazily, after the blocks that jump into
+  // them, so that GCM keeps definitions before their uses
+  HIRBlock* join = CreateBlock();
+  join->loop_depth = inline_loop_depth_;
+
+  // Blocks can have only two predecessors, chain joins
+  if (inline_return_ != NULL) inline_return_->Goto(join);
+  Goto(join);
+  inline_return_ = join;
+}
+
+
 void HIRGen::Replace(HIRInstruction* o, HIRInstruction* n) {
   HIRInstructionList::Item* head = o->uses()->head();
   for (; head != NULL; head = head->next()) {
@@ -1426,10 +2409,51 @@ void HIRBlock::Remove(HIRInstruction* instr) {
     }
   }
 
+  if (instr->Is(HIRInstruction::kPhi)) {
+    HIRPhiList::Item* phead = phis_.head();
+    for (; phead != NULL; phead = phead->next()) {
+      if (phead->value() == instr) {
+        phis_.Remove(phead);
+        break;
+      }
+    }
+  }
+
   instr->Remove();
 }
 
 
+void HIRBlock::RemoveSuccessor(HIRBlock* b) {
+  int i = succ_[0] == b ? 0 : 1;
+  assert(succ_[i] == b);
+
+  for (; i < succ_count_ - 1; i++) succ_[i] = succ_[i + 1];
+  succ_count_--;
+
+  b->RemovePredecessor(this);
+}
+
+
+void HIRBlock::RemovePredecessor(HIRBlock* b) {
+  int i = pred_[0] == b ? 0 : 1;
+  assert(pred_[i] == b);
+
+  // Phis have inputs in the order of predecessors, unless both inputs
+  // were the same
+  HIRPhiList::Item* head = phis_.head();
+  for (; head != NULL; head = head->next()) {
+    HIRPhi* phi = head->value();
+    if (phi->input_count() == 2) phi->RemoveInputAt(i);
+  }
+
+  // Loop without back edge
+  if (i == 1) loop_ = false;
+
+  for (; i < pred_count_ - 1; i++) pred_[i] = pred_[i + 1];
+  pred_count_--;
+}
+
+
 HIREnvironment::HIREnvironment(int stack_slots)
     : stack_slots_(stack_slots + 1) {
   // ^^ NOTE: One stack slot is reserved for bool logic binary operations
@@ -1456,6 +2480,156 @@ void HIREnvironment::Copy(HIREnvironment* from) {
 }
 
 
+HIRInlineAnalyze::HIRInlineAnalyze(FunctionLiteral* fn)
+    : Visitor<AstNode>(kPreorder),
+      is_leaf_(true) {
+  int size = sizeof(*assigns_) * (fn->stack_slots() + 1);
+  assigns_ = reinterpret_cast<int*>(Zone::current()->Allocate(size));
+  memset(assigns_, 0, size);
+
+  // Arguments are assigned on entry
+  AstList::Item* head = fn->args()->head();
+  for (; head != NULL; head = head->next()) {
+    AstNode* arg = head->value();
+    if (arg->is(AstNode::kVarArg)) arg = arg->lhs();
+
+    Visit(arg);
+    Assigns(arg);
+  }
+
+  VisitChildren(fn);
+}
+
+
+AstNode* HIRInlineAnalyze::VisitFunction(AstNode* node) {
+  // Nested function's body belongs to other scope, but it captures context
+  is_leaf_ = false;
+  return node;
+}
+
+
+AstNode* HIRInlineAnalyze::VisitCall(AstNode* node) {
+  FunctionLiteral* fn = FunctionLiteral::Cast(node);
+
+  // Stack trace should contain all frames
+  if (fn->variable()->is(AstNode::kValue)) {
+    AstNode* name = AstValue::Cast(fn->variable())->name();
+    if (name->length() == 8 && strncmp(name->value(), "__$trace", 8) == 0) {
+      is_leaf_ = false;
+    }
+  }
+
+  Visit(fn->variable());
+
+  AstList::Item* arg = fn->args()->head();
+  for (; arg != NULL; arg = arg->next()) {
+    Visit(arg->value());
+  }
+
+  return node;
+}
+
+
+AstNode* HIRInlineAnalyze::VisitAssign(AstNode* node) {
+  Assigns(node->lhs());
+  VisitChildren(node);
+  return node;
+}
+
+
+AstNode* HIRInlineAnalyze::VisitUnOp(AstNode* node) {
+  if (UnOp::Cast(node)->is_changing()) Assigns(node->lhs());
+  VisitChildren(node);
+  return node;
+}
+
+
+AstNode* HIRInlineAnalyze::VisitValue(AstNode* node) {
+  ScopeSlot* slot = AstValue::Cast(node)->slot();
+
+  ScopeSlot::UseList::Item* head = slots_.head();
+  for (; head != NULL; head = head->next()) {
+    if (head->value() == slot) return node;
+  }
+  slots_.Push(slot);
+
+  return node;
+}
+
+
+void HIRInlineAnalyze::Assigns(AstNode* node) {
+  if (!node->is(AstNode::kValue)) return;
+
+  ScopeSlot* slot = AstValue::Cast(node)->slot();
+  if (slot->is_stack()) assigns_[slot->index()]++;
+}
+
+
+void HIRInlineAnalyze::Relocate(HIRInlineInfo* info) {
+  ScopeSlot::UseList::Item* head = slots_.head();
+  for (; head != NULL; head = head->next()) {
+    ScopeSlot* slot = head->value();
+
+    if (slot->is_stack()) {
+      slot->index(slot->index() + info->offset());
+    } else if (slot->is_context() && slot->depth() > 0) {
+      slot->depth(slot->depth() - 1);
+    } else {
+      continue;
+    }
+    info->slots()->Push(slot);
+  }
+}
+
+
+void HIRInlineInfo::Restore() {
+  ScopeSlot* slot;
+  while ((slot = slots_.Shift()) != NULL) {
+    if (slot->is_stack()) {
+      slot->index(slot->index() - offset());
+    } else {
+      slot->depth(slot->depth() + 1);
+    }
+  }
+}
+
+
+HIRLoopAnalyze::HIRLoopAnalyze(AstNode* loop) : Visitor<AstNode>(kPreorder),
+                                                slots_(0),
+                                                has_calls_(false) {
+  VisitChildren(loop);
+}
+
+
+AstNode* HIRLoopAnalyze::VisitFunction(AstNode* node) {
+  // Nested function's variables are either in its own stack or in context
+  return node;
+}
+
+
+AstNode* HIRLoopAnalyze::VisitCall(AstNode* node) {
+  FunctionLiteral* fn = FunctionLiteral::Cast(node);
+
+  has_calls_ = true;
+  Visit(fn->variable());
+
+  AstList::Item* arg = fn->args()->head();
+  for (; arg != NULL; arg = arg->next()) {
+    Visit(arg->value());
+  }
+
+  return node;
+}
+
+
+AstNode* HIRLoopAnalyze::VisitValue(AstNode* node) {
+  ScopeSlot* slot = AstValue::Cast(node)->slot();
+  if (slot->is_stack()) slots_.Set(slot->index());
+
+  return node;
+}
+
+
 BreakContinueInfo::BreakContinueInfo(HIRGen *g, HIRBlock* end) : g_(g),
                                                                  brk_(end) {
 }
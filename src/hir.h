@@ -43,8 +43,12 @@ namespace internal {
 class HIRGen;
 class HIRBlock;
 class LBlock;
+class CodeProfile;
+class HIRInlineInfo;
 
 typedef ZoneList<HIRBlock*> HIRBlockList;
+typedef ZoneList<HIRInlineInfo*> HIRInlineList;
+typedef BitField<EmptyClass, ZonePolicy> HIRSlotSet;
 
 class HIREnvironment : public ZoneObject {
  public:
@@ -85,6 +89,7 @@ class HIRBlock : public ZoneObject {
   inline HIRBlock* root();
   inline void root(HIRBlock* root);
   inline HIRBlock* AddSuccessor(HIRBlock* b);
+  void RemoveSuccessor(HIRBlock* b);
   inline HIRInstruction* Add(HIRInstruction::Type type);
   inline HIRInstruction* Add(HIRInstruction::Type type, ScopeSlot* slot);
   inline HIRInstruction* Add(HIRInstruction* instr);
@@ -95,8 +100,8 @@ class HIRBlock : public ZoneObject {
   inline HIRInstruction* Return(HIRInstruction* instr);
   inline bool IsEnded();
   inline bool IsEmpty();
-  void MarkPreLoop();
-  void MarkLoop();
+  void MarkPreLoop(HIRSlotSet* slots);
+  void MarkLoop(HIRSlotSet* slots);
   inline bool IsLoop();
   inline HIRPhi* CreatePhi(ScopeSlot* slot);
 
@@ -121,6 +126,7 @@ class HIRBlock : public ZoneObject {
   inline HIRBlock* dominator();
   inline void dominator(HIRBlock* dom);
   inline int dominator_depth();
+  inline HIRBlock* dominator_jump();
   inline HIRBlockList* dominates();
 
   inline LBlock* lir();
@@ -130,6 +136,7 @@ class HIRBlock : public ZoneObject {
 
  protected:
   void AddPredecessor(HIRBlock* b);
+  void RemovePredecessor(HIRBlock* b);
   inline void Compress();
   inline HIRBlock* Evaluate();
 
@@ -156,6 +163,7 @@ class HIRBlock : public ZoneObject {
   HIRBlock* semi_;
   HIRBlock* dominator_;
   int dominator_depth_;
+  HIRBlock* dominator_jump_;
   HIRBlockList dominates_;
 
   // Allocator augmentation
@@ -182,6 +190,86 @@ class BreakContinueInfo : public ZoneObject {
   HIRBlock* brk_;
 };
 
+// Function that may be inlined into the one being compiled, its stack
+// variables are moved into the caller's frame
+class HIRInlineInfo : public ZoneObject {
+ public:
+  HIRInlineInfo(FunctionLiteral* fn, ScopeSlot* result, int offset)
+      : fn_(fn),
+        result_(result),
+        offset_(offset) {
+  }
+
+  // Moves callee's variables back to its own frame, AST is kept by the chunk
+  // for its next compilations (see HIRInlineAnalyze::Relocate)
+  void Restore();
+
+  inline FunctionLiteral* fn() { return fn_; }
+  inline ScopeSlot* result() { return result_; }
+  inline int offset() { return offset_; }
+  inline ScopeSlot::UseList* slots() { return &slots_; }
+
+ private:
+  FunctionLiteral* fn_;
+
+  // Holds returned value at the end of the inlined body
+  ScopeSlot* result_;
+
+  // Slots moved into the caller's frame
+  int offset_;
+  ScopeSlot::UseList slots_;
+};
+
+// Walks function's body (skipping nested functions) and collects
+// information needed for inlining
+class HIRInlineAnalyze : public Visitor<AstNode> {
+ public:
+  explicit HIRInlineAnalyze(FunctionLiteral* fn);
+
+  AstNode* VisitFunction(AstNode* node);
+  AstNode* VisitCall(AstNode* node);
+  AstNode* VisitAssign(AstNode* node);
+  AstNode* VisitUnOp(AstNode* node);
+  AstNode* VisitValue(AstNode* node);
+
+  // Moves stack variables by `info->offset()` and context ones one level up,
+  // as if they were declared in the caller
+  void Relocate(HIRInlineInfo* info);
+
+  // Number of assignments to the stack slot
+  inline int assigns(ScopeSlot* slot) { return assigns_[slot->index()]; }
+
+  // Function has no nested functions and doesn't inspect the stack
+  inline bool is_leaf() { return is_leaf_; }
+
+ private:
+  void Assigns(AstNode* node);
+
+  int* assigns_;
+  bool is_leaf_;
+  ScopeSlot::UseList slots_;
+};
+
+// Collects stack slots used in loop's condition and body (skipping nested
+// functions), only values of those may change between iterations
+class HIRLoopAnalyze : public Visitor<AstNode> {
+ public:
+  explicit HIRLoopAnalyze(AstNode* loop);
+
+  AstNode* VisitFunction(AstNode* node);
+  AstNode* VisitCall(AstNode* node);
+  AstNode* VisitValue(AstNode* node);
+
+  inline HIRSlotSet* slots() { return &slots_; }
+
+  // Loop contains calls, which may be inlined
+  inline bool has_calls() { return has_calls_; }
+
+ private:
+  HIRSlotSet slots_;
+  bool has_calls_;
+};
+
 class HIRGen : public Visitor<HIRInstruction> {
  public:
   HIRGen(Heap* heap, Root* root, const char* filename);
@@ -200,6 +288,37 @@ class HIRGen : public Visitor<HIRInstruction> {
   void FindInEffects(HIRInstruction* instr);
   void GlobalValueNumbering();
   void GlobalValueNumbering(HIRInstruction* instr, HIRGVNMap* gvn);
+
+  // Folds instructions with constant operands and branches on constants,
+  // removes blocks that become unreachable
+  void PropagateConstants();
+  HIRInstruction* FoldConstant(HIRInstruction* instr);
+  bool FoldBranch(HIRBlock* block);
+  bool RemoveDeadBlocks();
+  HIRInstruction* CreateLiteral(AstNode::Type type, ScopeSlot* slot);
+  HIRInstruction* CreateSmi(int64_t value);
+  HIRInstruction* CreateRootLiteral(AstNode::Type type, int index);
+
+  // 1 if constant value is truthy, 0 if falsy, -1 if value isn't constant
+  int ConstantTruth(HIRInstruction* instr);
+
+  // Replaces objects and arrays that are only used for property accesses
+  // with constant keys by the values stored in them
+  void ScalarReplacement();
+  bool ScalarReplace(HIRInstruction* alloc);
+  bool IsScalarKey(HIRInstruction* alloc, HIRInstruction* key);
+  bool IsEqualKey(HIRInstruction* a, HIRInstruction* b);
+  HIRInstructionList::Item* FindStore(HIRInstructionList* stores,
+                                      HIRInstruction* key);
+
+  // Finds bounds of SMI values: loop counters and arithmetic on them
+  void FindRanges();
+  HIRRange* FindRange(HIRInstruction* instr);
+  HIRRange* FindInductionRange(HIRPhi* phi);
+
+  // Lets GCM move loads of variables that can't change out of loops
+  void UnpinContextLoads();
+
   void GlobalCodeMotion();
   void ScheduleEarly(HIRInstruction* instr, HIRBlock* root);
   void ScheduleLate(HIRInstruction* instr);
@@ -207,6 +326,18 @@ class HIRGen : public Visitor<HIRInstruction> {
 
   void Replace(HIRInstruction* o, HIRInstruction* n);
 
+  // Attaches operand kinds seen by the baseline code at `site` to binop
+  void AddFeedback(HIRInstruction* instr, AstNode* site);
+
+  // Reserves stack slots for variables of functions that may be inlined,
+  // returns number of them
+  int FindInlineCandidates(FunctionLiteral* fn);
+
+  // Inlines body of the called function, returns its result or NULL
+  HIRInstruction* VisitInlined(FunctionLiteral* call);
+  void InlineReturn(HIRInstruction* value);
+  HIRInstruction* LoadStack(ScopeSlot* slot);
+
   HIRInstruction* Visit(AstNode* stmt);
   HIRInstruction* VisitFunction(AstNode* stmt);
   HIRInstruction* VisitAssign(AstNode* stmt);
@@ -272,11 +403,31 @@ class HIRGen : public Visitor<HIRInstruction> {
 
   inline Root* root();
 
+  // Profile of the function being optimized (NULL if there's no feedback)
+  inline CodeProfile* profile();
+  inline void profile(CodeProfile* profile);
+
+  // If set - function is entered from its baseline frame at the head of
+  // this loop (on-stack replacement)
+  inline AstNode* osr_loop();
+  inline void osr_loop(AstNode* loop);
+
   inline int block_id();
   inline int instr_id();
   inline int dfs_id();
 
-  static const int kMaxOptimizableSize = 25000;
+  // Liveness sets in LGen take memory quadratic in function's size (13MB
+  // for 100k characters of test-compile's function), larger functions are
+  // left in baseline code (see also LGen::kMaxLivenessSize)
+  static const int kMaxOptimizableSize = 100000;
+
+  // Arguments changed by more instructions put their users under unknown
+  // effects, instead of listing all of them
+  static const int kMaxEffects = 64;
+
+  // Limits on callee's and on all inlined bodies' source lengths
+  static const int kMaxInlineSize = 300;
+  static const int kMaxInlinedSize = 3000;
 
  private:
   HIRBlock* current_block_;
@@ -286,6 +437,16 @@ class HIRGen : public Visitor<HIRInstruction> {
   HIRBlockList roots_;
   HIRBlockList blocks_;
   Root* root_;
+  CodeProfile* profile_;
+  AstNode* osr_loop_;
+
+  // Inlining state
+  HIRInlineList inline_candidates_;
+  HIRInlineInfo* inline_info_;
+  HIRBlock* inline_return_;
+  int inline_loop_depth_;
+  CodeProfile* inline_profile_;
+  int inlined_size_;
   const char* filename_;
   int loop_depth_;
 
@@ -202,6 +202,13 @@ void Assembler::testb(Register dst, const Immediate src) {
 }
 
 
+void Assembler::testb(const Operand& dst, const Immediate src) {
+  emitb(0xF6);
+  emit_modrm(dst, 0);
+  emitb(src.value());
+}
+
+
 void Assembler::testl(Register dst, const Immediate src) {
   assert(dst != esi && dst != edi);
   emitb(0xF7);
@@ -241,6 +248,12 @@ void Assembler::jmp(Condition cond, Label* label) {
 }
 
 
+void Assembler::jmp(Register dst) {
+  emitb(0xFF);
+  emit_modrm(dst, 0x04);
+}
+
+
 void Assembler::mov(Register dst, Register src) {
   emitb(0x8B);
   emit_modrm(dst, src);
@@ -363,6 +376,13 @@ void Assembler::imull(Register src) {
 }
 
 
+void Assembler::imull(Register dst, Register src) {
+  emitb(0x0F);
+  emitb(0xAF);
+  emit_modrm(dst, src);
+}
+
+
 void Assembler::idivl(Register src) {
   emitb(0xF7);
   emit_modrm(src, 0x07);
@@ -395,6 +415,13 @@ void Assembler::orlb(Register dst, const Immediate src) {
 }
 
 
+void Assembler::orb(const Operand& dst, const Immediate src) {
+  emitb(0x80);
+  emit_modrm(dst, 0x01);
+  emitb(src.value());
+}
+
+
 void Assembler::xorl(Register dst, Register src) {
   emitb(0x33);
   emit_modrm(dst, src);
@@ -413,6 +440,12 @@ void Assembler::dec(Register dst) {
 }
 
 
+void Assembler::dec(const Operand& dst) {
+  emitb(0xFF);
+  emit_modrm(dst, 0x01);
+}
+
+
 void Assembler::shl(Register dst, const Immediate src) {
   emitb(0xC1);
   emit_modrm(dst, 0x04);
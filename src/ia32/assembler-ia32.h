@@ -292,6 +292,7 @@ class Assembler {
   void bind(Label* label);
   void jmp(Label* label);
   void jmp(Condition cond, Label* label);
+  void jmp(Register dst);
 
   void cmpl(Register dst, Register src);
   void cmpl(Register dst, const Operand& src);
@@ -303,6 +304,7 @@ class Assembler {
   void cmpb(const Operand& dst, const Immediate src);
 
   void testb(Register dst, const Immediate src);
+  void testb(const Operand& dst, const Immediate src);
   void testl(Register dst, const Immediate src);
 
   void mov(Register dst, Register src);
@@ -326,16 +328,19 @@ class Assembler {
   void subl(Register dst, const Operand& src);
   void sublb(Register dst, const Immediate src);
   void imull(Register src);
+  void imull(Register dst, Register src);
   void idivl(Register src);
 
   void andl(Register dst, Register src);
   void andb(Register dst, const Immediate src);
   void orl(Register dst, Register src);
   void orlb(Register dst, const Immediate src);
+  void orb(const Operand& dst, const Immediate src);
   void xorl(Register dst, Register src);
 
   void inc(Register dst);
   void dec(Register dst);
+  void dec(const Operand& dst);
   void shl(Register dst, const Immediate src);
   void shr(Register dst, const Immediate src);
   void shl(Register dst);
@@ -28,6 +28,7 @@
 #include "heap-inl.h"
 #include "macroassembler.h"
 #include "stubs.h"
+#include "code-space.h"  // CodeProfile
 
 namespace candor {
 namespace internal {
@@ -350,6 +351,42 @@ void FNot::Generate(Masm* masm) {
 #define BINARY_SUB_ENUM(V)\
     case BinOp::k##V: stub = masm->stubs()->GetBinary##V##Stub(); break;
 
+// Remembers kinds of binop's operands in eax and ebx
+static void RecordFeedback(Masm* masm, TypeFeedback* feedback) {
+  Register regs[2] = { eax, ebx };
+  Operand kinds(scratch, TypeFeedback::kKindsOffset);
+  Label not_smi, any, done;
+
+  __ mov(scratch, eax);
+  __ orl(scratch, ebx);
+  __ IsUnboxed(scratch, &not_smi, NULL);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(feedback)));
+  __ RecordExternal(ExternalReference::kFeedback);
+  __ orb(kinds, Immediate(TypeFeedback::kSmi));
+  __ jmp(&done);
+
+  __ bind(&not_smi);
+  for (int i = 0; i < 2; i++) {
+    Label next;
+    __ IsUnboxed(regs[i], NULL, &next);
+    __ IsNil(regs[i], NULL, &any);
+    __ IsHeapObject(Heap::kTagNumber, regs[i], &any, NULL);
+    __ bind(&next);
+  }
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(feedback)));
+  __ RecordExternal(ExternalReference::kFeedback);
+  __ orb(kinds, Immediate(TypeFeedback::kNumber));
+  __ jmp(&done);
+
+  __ bind(&any);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(feedback)));
+  __ RecordExternal(ExternalReference::kFeedback);
+  __ orb(kinds, Immediate(TypeFeedback::kAny));
+
+  __ bind(&done);
+}
+
+
 void FBinOp::Generate(Masm* masm) {
   char* stub = NULL;
 
@@ -364,6 +401,7 @@ void FBinOp::Generate(Masm* masm) {
   // ebx <- rhs
   __ mov(eax, *inputs[0]->ToOperand());
   __ mov(ebx, *inputs[1]->ToOperand());
+  if (feedback_ != NULL) RecordFeedback(masm, feedback_);
   __ Call(stub);
   // result -> eax
   __ mov(*result->ToOperand(), eax);
@@ -435,9 +473,10 @@ void FStoreVarArg::Generate(Masm* masm) {
   // eax <- value
   // edx <- offset
   __ mov(eax, *inputs[0]->ToOperand());
+  __ mov(ebx, *inputs[1]->ToOperand());
   __ mov(edx, esp);
-  __ shl(eax, Immediate(1));
-  __ addl(edx, *inputs[1]->ToOperand());
+  __ shl(ebx, Immediate(1));
+  __ addl(edx, ebx);
   __ Call(masm->stubs()->GetStoreVarArgStub());
 }
 
@@ -525,6 +564,12 @@ void FCall::Generate(Masm* masm) {
   __ IsNil(ebx, NULL, &not_function);
   __ IsHeapObject(Heap::kTagFunction, ebx, &not_function, NULL);
 
+  if (tail) {
+    Label call;
+    __ TailCallFunction(ebx, &call);
+    __ bind(&call);
+  }
+
   Masm::Spill context_s(masm, context_reg);
   Masm::Spill root_s(masm);
 
@@ -578,5 +623,72 @@ void FGetStackTrace::Generate(Masm* masm) {
   __ mov(*result->ToOperand(), eax);
 }
 
+
+void FProfile::Generate(Masm* masm) {
+  Label entry, done;
+  Operand counter(scratch, CodeProfile::kCounterOffset);
+
+  // NOTE: CodeSpace::Optimize() replaces these two instructions in prologue
+  // with a jump to the optimized code
+  __ bind(&entry);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(profile_)));
+  __ RecordExternal(ExternalReference::kProfile);
+  __ dec(counter);
+
+  // Loops are only counting
+  if (!entry_) {
+    if (osr_loop_ == -1) return;
+
+    __ jmp(kGe, &done);
+
+    // Loop is hot, try entering optimized code at its head
+    __ push(Immediate(HNumber::Tag(osr_loop_)));
+    __ push(scratch);
+    __ Call(masm->stubs()->GetOSRStub());
+  __ addlb(esp, Immediate(8));
+    __ cmpl(eax, Immediate(0));
+    __ jmp(kEq, &done);
+
+    // Optimized code runs the rest of the function using this frame's
+    // variables, return its result (the mark lets stack trace skip this frame)
+    __ push(Immediate(Heap::kOSRFrameTag));
+    __ push(Immediate(Heap::kOSRFrameTag));
+    __ Call(eax);
+    __ mov(esp, ebp);
+    __ pop(ebp);
+    __ ret(0);
+
+    __ bind(&done);
+    return;
+  }
+
+  __ jmp(kGe, &done);
+
+  // Function is hot, try optimizing it and start again
+  // (either baseline or patched code will be executed)
+  __ push(scratch);
+  __ Call(masm->stubs()->GetTierUpStub());
+  __ addlb(esp, Immediate(4));
+  __ jmp(&entry);
+
+  __ bind(&done);
+}
+
+void FCompileLazy::Generate(Masm* masm) {
+  Label entry;
+
+  // NOTE: CodeSpace::CompileLazy() replaces these instructions with a jump
+  // to the compiled code
+  __ bind(&entry);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(profile_)));
+  __ RecordExternal(ExternalReference::kProfile);
+  __ push(scratch);
+  __ Call(masm->stubs()->GetCompileLazyStub());
+  __ addlb(esp, Immediate(4));
+
+  // Function's code is in place now
+  __ jmp(&entry);
+}
+
 }  // namespace internal
 }  // namespace candor
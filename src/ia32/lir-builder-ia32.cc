@@ -41,7 +41,7 @@ void LGen::VisitNil(HIRInstruction* instr) {
 
 void LGen::VisitEntry(HIRInstruction* instr) {
   HIREntry* entry = HIREntry::Cast(instr);
-  Bind(new LEntry(entry->label(), entry->context_slots()));
+  Bind(new LEntry(entry->label(), entry->context_slots(), entry->osr()));
 }
 
 
@@ -96,14 +96,30 @@ void LGen::VisitNot(HIRInstruction* instr) {
 
 
 void LGen::VisitBinOp(HIRInstruction* instr) {
+  // Comparison is generated by the branch (see VisitIf)
+  if (IsSmiCompare(instr)) return;
+
+  if (IsSmiBinOp(instr)) {
+    Bind(new LBinOpSmi())
+        ->AddScratch(CreateVirtual())
+        ->AddArg(instr->left(), LUse::kRegister)
+        ->AddArg(instr->right(), LUse::kRegister)
+        ->SetResult(CreateVirtual(), LUse::kRegister);
+    return;
+  }
+
   LInstruction* op;
   LInterval* lhs = ToFixed(instr->left(), eax);
   LInterval* rhs = ToFixed(instr->right(), ebx);
   HIRBinOp* hir = HIRBinOp::Cast(instr);
+  bool is_number = instr->right()->IsNumber() && instr->left()->IsNumber() &&
+      BinOp::is_math(hir->binop_type()) && hir->binop_type() != BinOp::kDiv;
+
+  if (is_number || IsSmiSpeculation(instr)) {
+    LBinOpNumber* number = new LBinOpNumber();
+    if (!is_number) number->deopt_profile = hir_->profile();
 
-  if (instr->right()->IsNumber() && instr->left()->IsNumber() &&
-      BinOp::is_math(hir->binop_type()) && hir->binop_type() != BinOp::kDiv) {
-    op = Bind(new LBinOpNumber())
+    op = Bind(number)
         ->MarkHasCall()
         ->AddScratch(CreateVirtual())
         ->AddArg(lhs, LUse::kRegister)
@@ -159,6 +175,13 @@ void LGen::VisitClone(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitLoadOsr(HIRInstruction* instr) {
+  Bind(new LLoadOsr())
+      ->SetSlot(HIRLoadOsr::Cast(instr)->osr_slot())
+      ->SetResult(CreateVirtual(), LUse::kRegister);
+}
+
+
 void LGen::VisitLoadContext(HIRInstruction* instr) {
   Bind(new LLoadContext())
       ->SetSlot(HIRLoadContext::Cast(instr)->context_slot())
@@ -280,7 +303,7 @@ void LGen::VisitStoreVarArg(HIRInstruction* instr) {
 void LGen::VisitCall(HIRInstruction* instr) {
   LInterval* lhs = ToFixed(instr->left(), ebx);
   LInterval* rhs = ToFixed(instr->right(), eax);
-  LInstruction* op = Bind(new LCall())
+  LInstruction* op = Bind(new LCall(IsTailCall(instr)))
       ->MarkHasCall()
       ->AddArg(lhs, LUse::kRegister)
       ->AddArg(rhs, LUse::kRegister);
@@ -290,6 +313,13 @@ void LGen::VisitCall(HIRInstruction* instr) {
 
 
 void LGen::VisitIf(HIRInstruction* instr) {
+  if (IsSmiCompare(instr->left())) {
+    Bind(new LBranchSmi())
+        ->AddArg(instr->left()->left(), LUse::kRegister)
+        ->AddArg(instr->left()->right(), LUse::kRegister);
+    return;
+  }
+
   if (instr->left()->IsNumber()) {
     Bind(new LBranchNumber())
         ->AddArg(instr->left(), LUse::kRegister);
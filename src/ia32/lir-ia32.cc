@@ -63,6 +63,16 @@ void LEntry::Generate(Masm* masm) {
 
   // Save argc
   Operand argc(ebp, -HValue::kPointerSize * 2);
+
+  // Baseline frame below has already initialized arguments and context
+  if (osr_) {
+    Operand baseline_argc(scratch, -HValue::kPointerSize * 2);
+    __ mov(scratch, Operand(ebp, 0));
+    __ mov(scratch, baseline_argc);
+    __ mov(argc, scratch);
+    return;
+  }
+
   __ mov(argc, eax);
 
   // Allocate context slots
@@ -193,6 +203,27 @@ void LBranchNumber::Generate(Masm* masm) {
 }
 
 
+void LBranchSmi::Generate(Masm* masm) {
+  // Tagging preserves order of SMIs
+  __ cmpl(inputs[0]->ToRegister(), inputs[1]->ToRegister());
+
+  // Jmp to `right` block if comparison is false
+  Condition cond;
+  switch (HIRBinOp::Cast(hir()->left())->binop_type()) {
+    case BinOp::kLt: cond = kGe; break;
+    case BinOp::kGt: cond = kLe; break;
+    case BinOp::kLe: cond = kGt; break;
+    case BinOp::kGe: cond = kLt; break;
+    case BinOp::kEq:
+    case BinOp::kStrictEq: cond = kNe; break;
+    case BinOp::kNe:
+    case BinOp::kStrictNe: cond = kEq; break;
+    default: UNEXPECTED
+  }
+  __ jmp(cond, TargetAt(1)->label);
+}
+
+
 
 
 void LLoadProperty::Generate(Masm* masm) {
@@ -304,6 +335,33 @@ void LBinOp::Generate(Masm* masm) {
 }
 
 
+// Returns function to the baseline code once speculation has failed,
+// current frame continues on the generic path (see CodeSpace::Deoptimize)
+static void GenerateDeopt(Masm* masm, CodeProfile* profile) {
+  // Version of the code being generated and profile
+  __ push(Immediate(HNumber::Tag(profile->version())));
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(profile)));
+  __ push(scratch);
+  __ Call(masm->stubs()->GetDeoptimizeStub());
+  __ addlb(esp, Immediate(2 * 4));
+}
+
+
+// Failed speculation is rare, deoptimization code is placed out of line
+class DeoptSlowPath : public Masm::SlowPath {
+ public:
+  explicit DeoptSlowPath(CodeProfile* profile) : profile_(profile) {
+  }
+
+  void Generate(Masm* masm) {
+    GenerateDeopt(masm, profile_);
+  }
+
+ private:
+  CodeProfile* profile_;
+};
+
+
 void LBinOpNumber::Generate(Masm* masm) {
   BinOp::BinOpType type = HIRBinOp::Cast(hir())->binop_type();
 
@@ -312,8 +370,16 @@ void LBinOpNumber::Generate(Masm* masm) {
   Register scratch = scratches[0]->ToRegister();
   Label stub_call, done;
 
-  __ IsUnboxed(left, &stub_call, NULL);
-  __ IsUnboxed(right, &stub_call, NULL);
+  // Non-SMI inputs invalidate speculation
+  DeoptSlowPath* deopt = NULL;
+  Label* not_smi = &stub_call;
+  if (deopt_profile != NULL) {
+    deopt = new DeoptSlowPath(deopt_profile);
+    not_smi = &deopt->entry;
+  }
+
+  __ IsUnboxed(left, not_smi, NULL);
+  __ IsUnboxed(right, not_smi, NULL);
 
   // Save left side in case of overflow
   __ mov(scratch, left);
@@ -338,6 +404,13 @@ void LBinOpNumber::Generate(Masm* masm) {
   // Restore left side
   __ mov(left, scratch);
 
+  // Overflow doesn't invalidate speculation, deoptimized code continues
+  // with the stub call too
+  if (deopt != NULL) {
+    __ Defer(deopt);
+    __ bind(&deopt->exit);
+  }
+
   __ bind(&stub_call);
 
   char* stub = NULL;
@@ -355,6 +428,36 @@ void LBinOpNumber::Generate(Masm* masm) {
   __ bind(&done);
 }
 
+
+void LBinOpSmi::Generate(Masm* masm) {
+  Register scratch = scratches[0]->ToRegister();
+
+  // Result may share register with any of inputs
+  __ mov(scratch, inputs[0]->ToRegister());
+  switch (HIRBinOp::Cast(hir())->binop_type()) {
+    case BinOp::kAdd:
+      __ addl(scratch, inputs[1]->ToRegister());
+      break;
+    case BinOp::kSub:
+      __ subl(scratch, inputs[1]->ToRegister());
+      break;
+    case BinOp::kMul:
+      __ Untag(scratch);
+      __ imull(scratch, inputs[1]->ToRegister());
+      break;
+    default:
+      UNEXPECTED
+  }
+  __ mov(result->ToRegister(), scratch);
+}
+
+
+void LBinOpDouble::Generate(Masm* masm) {
+  // There're no spare double registers on ia32,
+  // LGen never emits this instruction here
+  UNEXPECTED
+}
+
 #undef BINARY_SUB_ENUM
 #undef BINARY_SUB_TYPES
 
@@ -401,6 +504,12 @@ void LCall::Generate(Masm* masm) {
   __ IsNil(ebx, NULL, &not_function);
   __ IsHeapObject(Heap::kTagFunction, ebx, &not_function, NULL);
 
+  if (tail_) {
+    Label call;
+    __ TailCallFunction(ebx, &call);
+    __ bind(&call);
+  }
+
   Masm::Spill context_s(masm, context_reg);
   Masm::Spill root_s(masm);
 
@@ -510,6 +619,17 @@ void LAlignStack::Generate(Masm* masm) {
 }
 
 
+void LLoadOsr::Generate(Masm* masm) {
+  // Baseline frame is the caller's one (see FOperand::ToOperand())
+  Operand frame(ebp, 0);
+  Operand value(result->ToRegister(),
+                -HValue::kPointerSize * (slot()->index() + 3));
+
+  __ mov(result->ToRegister(), frame);
+  __ mov(result->ToRegister(), value);
+}
+
+
 void LLoadContext::Generate(Masm* masm) {
   Heap* heap = masm->heap();
   Immediate root(reinterpret_cast<intptr_t>(heap->old_space()->root()));
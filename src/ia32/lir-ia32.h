@@ -31,6 +31,9 @@ namespace internal {
 
 const int kLIRRegisterCount = 4;
 
+// Doubles are always boxed on ia32
+const int kLIRDoubleRegisterCount = 0;
+
 }  // namespace internal
 }  // namespace candor
 
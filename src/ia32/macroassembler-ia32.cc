@@ -84,6 +84,8 @@ void Masm::Popad(Register preserve) {
 
 
 void Masm::AlignCode() {
+  EmitSlowPaths();
+
   offset_ = RoundUp(offset_, 16);
   Grow();
 }
@@ -179,6 +181,11 @@ void Masm::FinalizeSpills() {
 }
 
 
+void Masm::Move(Register dst, Immediate src) {
+  mov(dst, src);
+}
+
+
 void Masm::Allocate(Heap::HeapTag tag,
                     Register size_reg,
                     uint32_t size,
@@ -249,6 +256,32 @@ void Masm::AllocateNumber(DoubleRegister value, Register result) {
 }
 
 
+void Masm::UnboxNumber(Register number,
+                       DoubleRegister result,
+                       Label* not_number) {
+  Label heap_number, done;
+
+  IsUnboxed(number, &heap_number, NULL);
+
+  mov(scratch, number);
+  Untag(scratch);
+  xorld(result, result);
+  cvtsi2sd(result, scratch);
+  jmp(&done);
+
+  bind(&heap_number);
+  if (not_number != NULL) {
+    IsNil(number, NULL, not_number);
+    IsHeapObject(Heap::kTagNumber, number, not_number, NULL);
+  }
+
+  Operand qvalue(number, HNumber::kValueOffset);
+  movd(result, qvalue);
+
+  bind(&done);
+}
+
+
 void Masm::AllocateObjectLiteral(Heap::HeapTag tag,
                                  Register tag_reg,
                                  Register size,
@@ -385,8 +418,10 @@ void Masm::EnterFramePrologue() {
 
   push(Immediate(Heap::kTagNil));
   mov(scratch, last_frame);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   mov(scratch, last_stack);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   push(Immediate(Heap::kEnterFrameTag));
 }
@@ -407,10 +442,12 @@ void Masm::ExitFramePrologue() {
   push(Immediate(Heap::kTagNil));
 
   mov(scratch, last_frame);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   mov(scratch_op, ebp);
 
   mov(scratch, last_stack);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   mov(scratch_op, esp);
   xorl(scratch, scratch);
@@ -428,6 +465,7 @@ void Masm::ExitFrameEpilogue() {
   // NOTE: we can safely use ebx here, look at stubs-ia32.cc
   mov(ebx, scratch);
   mov(scratch, last_stack);
+  RecordExternal(ExternalReference::kHeapAddress);
   mov(scratch_op, ebx);
 
   pop(scratch);
@@ -435,6 +473,7 @@ void Masm::ExitFrameEpilogue() {
   // Restore previous last_frame
   mov(ebx, scratch);
   mov(scratch, last_frame);
+  RecordExternal(ExternalReference::kHeapAddress);
   mov(scratch_op, ebx);
 
   pop(scratch);
@@ -557,20 +596,28 @@ void Masm::StringHash(Register str, Register result) {
 }
 
 
+class CollectGarbageSlowPath : public Masm::SlowPath {
+ public:
+  void Generate(Masm* masm) {
+    masm->Call(masm->stubs()->GetCollectGarbageStub());
+  }
+};
+
+
 void Masm::CheckGC() {
   Immediate gc_flag(reinterpret_cast<uint32_t>(heap()->needs_gc_addr()));
   Operand scratch_op(scratch, 0);
 
-  Label done;
+  CollectGarbageSlowPath* gc = new CollectGarbageSlowPath();
 
   // Check needs_gc flag
   mov(scratch, gc_flag);
+  RecordExternal(ExternalReference::kHeapAddress);
   cmpb(scratch_op, Immediate(0));
-  jmp(kEq, &done);
-
-  Call(stubs()->GetCollectGarbageStub());
+  jmp(kNe, &gc->entry);
+  Defer(gc);
 
-  bind(&done);
+  bind(&gc->exit);
 }
 
 
@@ -639,11 +686,18 @@ void Masm::Call(const Operand& addr) {
 
 void Masm::Call(char* stub) {
   mov(scratch, Immediate(reinterpret_cast<uint32_t>(stub)));
+  RecordExternal(ExternalReference::kStub);
 
   Call(scratch);
 }
 
 
+void Masm::Jump(char* code) {
+  mov(scratch, Immediate(reinterpret_cast<uint32_t>(code)));
+  jmp(scratch);
+}
+
+
 void Masm::CallFunction(Register fn) {
   Immediate root(reinterpret_cast<intptr_t>(heap()->old_space()->root()));
   Operand scratch_op(scratch, 0);
@@ -681,6 +735,71 @@ void Masm::CallFunction(Register fn) {
 }
 
 
+void Masm::TailCallFunction(Register fn, Label* fallback) {
+  Immediate root(reinterpret_cast<intptr_t>(heap()->old_space()->root()));
+  Operand scratch_op(scratch, 0);
+
+  Operand context_slot(fn, HFunction::kParentOffset);
+  Operand code_slot(fn, HFunction::kCodeOffset);
+  Operand root_slot(fn, HFunction::kRootOffset);
+  Operand argc(ebp, -HValue::kPointerSize * 2);
+
+  // Bindings are called by stub
+  cmpl(context_slot, Immediate(Heap::kBindingContextTag));
+  jmp(kEq, fallback);
+
+  // ecx <- aligned new argc, edx <- aligned current argc
+  Label even_argc, even_current, loop, copy;
+  mov(ecx, eax);
+  testb(ecx, Immediate(HNumber::Tag(3)));
+  jmp(kEq, &even_argc);
+  orlb(ecx, Immediate(HNumber::Tag(3)));
+  addlb(ecx, Immediate(HNumber::Tag(1)));
+  bind(&even_argc);
+
+  mov(edx, argc);
+  testb(edx, Immediate(HNumber::Tag(3)));
+  jmp(kEq, &even_current);
+  orlb(edx, Immediate(HNumber::Tag(3)));
+  addlb(edx, Immediate(HNumber::Tag(1)));
+  bind(&even_current);
+
+  cmpl(ecx, edx);
+  jmp(kGt, fallback);
+
+  // Copy arguments, starting from the last one
+  Operand from(edx, 0);
+  Operand to(edx, HValue::kPointerSize * 2);
+  shl(ecx, Immediate(1));
+  jmp(&loop);
+
+  bind(&copy);
+  sublb(ecx, Immediate(HValue::kPointerSize));
+  mov(edx, esp);
+  addl(edx, ecx);
+  mov(scratch, from);
+  mov(edx, ebp);
+  addl(edx, ecx);
+  mov(to, scratch);
+
+  bind(&loop);
+  cmplb(ecx, Immediate(0));
+  jmp(kNe, &copy);
+
+  // Set new root
+  mov(context_reg, root_slot);
+  mov(scratch, root);
+  mov(scratch_op, context_reg);
+
+  // Leave frame and enter function
+  mov(esp, ebp);
+  pop(ebp);
+  mov(context_reg, context_slot);
+  mov(scratch, code_slot);
+  jmp(scratch);
+}
+
+
 void Masm::ProbeCPU() {
   push(ebp);
   mov(ebp, esp);
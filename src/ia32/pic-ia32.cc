@@ -21,6 +21,9 @@
  */
 
 #include "pic.h"
+
+#include <stddef.h>  // offsetof
+
 #include "code-space.h"  // CodeSpace
 #include "stubs.h"  // Stubs
 #include "macroassembler.h"  // Masm
@@ -46,30 +49,29 @@ void PIC::Generate(Masm* masm) {
   __ mov(eax_s, eax);
   __ mov(ebx_s, ebx);
 
-  if (size_ != 0) {
-    // Proto in case of array
-    __ mov(edx, Immediate(Heap::kICDisabledValue));
+  // Proto in case of array
+  __ mov(edx, Immediate(Heap::kICDisabledValue));
 
-    // Fast-case non-object
-    __ IsNil(eax, NULL, &miss);
-    __ IsUnboxed(eax, NULL, &miss);
-    __ IsHeapObject(Heap::kTagObject, eax, &miss, NULL);
+  // Fast-case non-object
+  __ IsNil(eax, NULL, &miss);
+  __ IsUnboxed(eax, NULL, &miss);
+  __ IsHeapObject(Heap::kTagObject, eax, &miss, NULL);
 
-    // Load proto
-    __ mov(edx, proto_op);
-    __ cmpl(edx, Immediate(Heap::kICDisabledValue));
-    __ jmp(kEq, &miss);
-  }
+  // Load proto
+  __ mov(edx, proto_op);
+  __ cmpl(edx, Immediate(Heap::kICDisabledValue));
+  __ jmp(kEq, &miss);
 
-  for (int i = size_ - 1; i >= 0; i--) {
+  // Compare it with every entry of the table, Miss() fills them in order
+  __ mov(ebx, Immediate(reinterpret_cast<intptr_t>(entries_)));
+  for (int i = 0; i < kMaxSize; i++) {
     Label local_miss;
+    Operand proto(ebx, i * sizeof(Entry) + offsetof(Entry, proto));
+    Operand result(ebx, i * sizeof(Entry) + offsetof(Entry, result));
 
-    __ mov(ebx, Immediate(reinterpret_cast<intptr_t>(protos_[i])));
-    proto_offsets_[i] = reinterpret_cast<char**>(static_cast<intptr_t>(
-          masm->offset() - 4));
-    __ cmpl(edx, ebx);
+    __ cmpl(edx, proto);
     __ jmp(kNe, &local_miss);
-    __ mov(eax, Immediate(results_[i]));
+    __ mov(eax, result);
     __ xorl(ebx, ebx);
     __ mov(esp, ebp);
     __ pop(ebp);
@@ -80,10 +82,8 @@ void PIC::Generate(Masm* masm) {
   // Cache failed - call runtime
   __ bind(&miss);
 
-  if (size_ != 0) {
-    __ mov(ebx, ebx_s);
-    __ mov(eax, eax_s);
-  }
+  __ mov(ebx, ebx_s);
+  __ mov(eax, eax_s);
   __ Call(space_->stubs()->GetLookupPropertyStub());
 
   // Miss(this, object, result, ip)
@@ -380,6 +380,161 @@ void CollectGarbageStub::Generate() {
 }
 
 
+void TierUpStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeTierUpCallback tier_up = &RuntimeTierUp;
+  Heap* heap = masm()->heap();
+  Immediate root(reinterpret_cast<intptr_t>(heap->old_space()->root()));
+  Operand scratch_op(scratch, 0);
+  Operand profile(ebp, 8);
+
+  // Function's arguments should be preserved
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeTierUp(heap, profile, root)
+    __ mov(scratch, root);
+    __ mov(scratch, scratch_op);
+    __ mov(eax, profile);
+    __ mov(ebx, Immediate(reinterpret_cast<intptr_t>(heap)));
+
+    __ push(scratch);
+    __ push(scratch);
+
+    __ push(eax);
+    __ push(ebx);
+
+    __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&tier_up)));
+    __ Call(eax);
+
+    __ addlb(esp, Immediate(4 * 4));
+  }
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(1);
+}
+
+
+void CompileLazyStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeCompileLazyCallback compile = &RuntimeCompileLazy;
+  Heap* heap = masm()->heap();
+  Immediate root(reinterpret_cast<intptr_t>(heap->old_space()->root()));
+  Operand scratch_op(scratch, 0);
+  Operand profile(ebp, 8);
+
+  // Function's arguments should be preserved
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeCompileLazy(heap, profile, root)
+    __ mov(scratch, root);
+    __ mov(scratch, scratch_op);
+    __ mov(eax, profile);
+    __ mov(ebx, Immediate(reinterpret_cast<intptr_t>(heap)));
+
+    __ push(scratch);
+    __ push(scratch);
+
+    __ push(eax);
+    __ push(ebx);
+
+    __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&compile)));
+    __ Call(eax);
+
+    __ addlb(esp, Immediate(4 * 4));
+  }
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(1);
+}
+
+
+void DeoptimizeStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeDeoptimizeCallback deopt = &RuntimeDeoptimize;
+  Operand profile(ebp, 8);
+  Operand version(ebp, 12);
+
+  // Operands of the failed instruction should be preserved
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeDeoptimize(heap, profile, version)
+    __ mov(eax, profile);
+    __ mov(ebx, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(ecx, version);
+
+    __ push(eax);
+    __ push(ecx);
+
+    __ push(eax);
+    __ push(ebx);
+
+    __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&deopt)));
+    __ Call(eax);
+
+    __ addlb(esp, Immediate(4 * 4));
+  }
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(2);
+}
+
+
+void OSRStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeOSRCallback osr = &RuntimeOSR;
+  Heap* heap = masm()->heap();
+  Immediate root(reinterpret_cast<intptr_t>(heap->old_space()->root()));
+  Operand scratch_op(scratch, 0);
+  Operand profile(ebp, 8);
+  Operand loop(ebp, 12);
+
+  // Baseline code keeps values on stack, but root and context are needed
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeOSR(heap, profile, loop, root)
+    __ mov(scratch, root);
+    __ mov(scratch, scratch_op);
+    __ mov(eax, profile);
+    __ mov(ebx, Immediate(reinterpret_cast<intptr_t>(heap)));
+    __ mov(ecx, loop);
+
+    __ push(scratch);
+    __ push(ecx);
+    __ push(eax);
+    __ push(ebx);
+
+    __ mov(eax, Immediate(*reinterpret_cast<intptr_t*>(&osr)));
+    __ Call(eax);
+
+    __ addlb(esp, Immediate(4 * 4));
+  }
+
+  // Optimized code's address or NULL
+  __ Popad(eax);
+
+  GenerateEpilogue(2);
+}
+
+
 void TypeofStub::Generate() {
   GeneratePrologue();
   Heap* heap = masm()->heap();
@@ -541,6 +696,11 @@ void LookupPropertyStub::Generate() {
     // invalidate IC if key wasn't the same
     __ IsNil(scratch, &same_key, NULL);
 
+    // Only interned strings may be used as keys, let runtime intern it
+    Operand interned(ebx, HString::kInternedOffset);
+    __ testb(interned, Immediate(HString::kInternedBit));
+    __ jmp(kEq, &cleanup);
+
     __ mov(qproto, Immediate(Heap::kICDisabledValue));
     __ bind(&same_key);
 
@@ -89,16 +89,10 @@ inline LInterval* LGen::CreateConst() {
 
 
 inline LBlock* LGen::IsBlockStart(int pos) {
-  HIRBlockList::Item* bhead = blocks_.head();
-  for (; bhead != NULL; bhead = bhead->next()) {
-    LBlock* block = bhead->value()->lir();
-    if (block->start_id == pos) return block;
+  int index = FindBlock(pos);
+  if (index == -1 || block_index_[index]->start_id != pos) return NULL;
 
-    // Optimization
-    if (block->start_id > pos) return NULL;
-  }
-
-  return NULL;
+  return block_index_[index];
 }
 
 
@@ -128,19 +122,19 @@ inline ZoneList<LInstruction*>* LBlock::instructions() {
 inline void LBlock::PrintHeader(PrintBuffer* p) {
   p->Print("# Block %d\n", hir()->id);
 
-  if (live_in.head() != NULL || live_out.head() != NULL) {
+  if (!live_in.IsEmpty() || !live_out.IsEmpty()) {
     p->Print("# in: ");
-    LUseMap::Item* mitem = live_in.head();
-    for (; mitem != NULL; mitem = mitem->next_scalar()) {
-      p->Print("%d", static_cast<int>(mitem->key()->value()));
-      if (mitem->next_scalar() != NULL) p->Print(", ");
+    for (int id = live_in.Next(0); id != -1; ) {
+      p->Print("%d", id);
+      id = live_in.Next(id + 1);
+      if (id != -1) p->Print(", ");
     }
 
     p->Print(", out: ");
-    mitem = live_out.head();
-    for (; mitem != NULL; mitem = mitem->next_scalar()) {
-      p->Print("%d", static_cast<int>(mitem->key()->value()));
-      if (mitem->next_scalar() != NULL) p->Print(", ");
+    for (int id = live_out.Next(0); id != -1; ) {
+      p->Print("%d", id);
+      id = live_out.Next(id + 1);
+      if (id != -1) p->Print(", ");
     }
     p->Print("\n");
   }
@@ -263,7 +257,7 @@ inline void LInterval::Print(PrintBuffer* p) {
     case kVirtual: p->Print("v%d", id); break;
     case kRegister:
       p->Print("%s:%d", RegisterNameByIndex(index()), id);
-      if (register_hint != NULL) {
+      if (register_hint != NULL && register_hint->is_register()) {
         int index = register_hint->interval()->index();
         const char* name = RegisterNameByIndex(index);
         p->Print("(%s)", name);
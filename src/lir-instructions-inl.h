@@ -141,7 +141,8 @@ inline LLabel* LControlInstruction::TargetAt(int i) {
 inline LControlInstruction* LControlInstruction::Cast(LInstruction* instr) {
   assert(instr->type() == kGoto ||
          instr->type() == kBranch ||
-         instr->type() == kBranchNumber);
+         instr->type() == kBranchNumber ||
+         instr->type() == kBranchSmi);
   return reinterpret_cast<LControlInstruction*>(instr);
 }
 
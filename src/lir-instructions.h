@@ -38,6 +38,7 @@ namespace internal {
 class LInstruction;
 class LBlock;
 class ScopeSlot;
+class CodeProfile;
 typedef ZoneList<LInstruction*> LInstructionList;
 
 #define LIR_INSTRUCTION_SIMPLE_TYPES(V) \
@@ -53,14 +54,14 @@ typedef ZoneList<LInstruction*> LInstructionList;
     V(StoreArg) \
     V(StoreVarArg) \
     V(AlignStack) \
+    V(LoadOsr) \
     V(Not) \
     V(BinOp) \
-    V(BinOpNumber) \
+    V(BinOpSmi) \
     V(Typeof) \
     V(Sizeof) \
     V(Keysof) \
     V(Clone) \
-    V(Call) \
     V(CollectGarbage) \
     V(GetStackTrace) \
     V(Phi)
@@ -73,10 +74,14 @@ typedef ZoneList<LInstruction*> LInstructionList;
     V(Literal) \
     V(Branch) \
     V(BranchNumber) \
+    V(BranchSmi) \
+    V(BinOpNumber) \
+    V(BinOpDouble) \
     V(LoadProperty) \
     V(StoreProperty) \
     V(AllocateObject) \
     V(AllocateArray) \
+    V(Call) \
     V(Goto) \
     LIR_INSTRUCTION_SIMPLE_TYPES(V)
 
@@ -175,10 +180,11 @@ class LInstruction : public ZoneObject {
 
 class LEntry : public LInstruction {
  public:
-  LEntry(Label* label, int context_slots)
+  LEntry(Label* label, int context_slots, bool osr)
       : LInstruction(kEntry),
         label_(label),
-        context_slots_(context_slots) {
+        context_slots_(context_slots),
+        osr_(osr) {
   }
 
   INSTRUCTION_METHODS(Entry)
@@ -186,6 +192,7 @@ class LEntry : public LInstruction {
  private:
   Label* label_;
   int context_slots_;
+  bool osr_;
 };
 
 class LLabel : public LInstruction {
@@ -290,6 +297,66 @@ class LBranchNumber : public LControlInstruction {
   INSTRUCTION_METHODS(BranchNumber)
 };
 
+// Comparison of two SMIs (see HIRGen::FindRanges) fused with branch
+class LBranchSmi : public LControlInstruction {
+ public:
+  LBranchSmi() : LControlInstruction(kBranchSmi) {
+  }
+
+  INSTRUCTION_METHODS(BranchSmi)
+};
+
+class LCall : public LInstruction {
+ public:
+  explicit LCall(bool tail) : LInstruction(kCall), tail_(tail) {
+  }
+
+  INSTRUCTION_METHODS(Call)
+
+ private:
+  // Result is returned right away, callee may reuse the frame
+  // (see LGen::IsTailCall)
+  bool tail_;
+};
+
+class LBinOpNumber : public LInstruction {
+ public:
+  LBinOpNumber() : LInstruction(kBinOpNumber), deopt_profile(NULL) {
+  }
+
+  INSTRUCTION_METHODS(BinOpNumber)
+
+  // Profile to deoptimize if operands are not the ones the speculation
+  // was based on (NULL if instruction isn't speculative)
+  CodeProfile* deopt_profile;
+};
+
+class LBinOpDouble : public LInstruction {
+ public:
+  LBinOpDouble() : LInstruction(kBinOpDouble),
+                   result_double(-1),
+                   live_doubles(0),
+                   deopt_profile(NULL) {
+    input_doubles[0] = -1;
+    input_doubles[1] = -1;
+  }
+
+  INSTRUCTION_METHODS(BinOpDouble)
+
+  inline bool IsUnboxed() { return result_double != -1; }
+
+  // Indexes of double registers holding unboxed lhs/rhs and result
+  // (-1 if value is boxed)
+  int input_doubles[2];
+  int result_double;
+
+  // Mask of other unboxed values live across instruction
+  int live_doubles;
+
+  // See LBinOpNumber::deopt_profile
+  CodeProfile* deopt_profile;
+};
+
 class LAccessProperty : public LInstruction {
  public:
   explicit LAccessProperty(Type type) : LInstruction(type),
@@ -31,6 +31,8 @@
 #include "hir-inl.h"
 #include "lir-instructions.h"
 #include "lir-instructions-inl.h"
+#include "code-space.h"  // TypeFeedback
+#include "compile-stats.h"  // CompileStats
 #include "source-map.h"  // SourceMap
 
 namespace candor {
@@ -43,8 +45,12 @@ LGen::LGen(HIRGen* hir, const char* filename, HIRBlock* root)
       instr_id_(0),
       interval_id_(0),
       virtual_index_(40),
+      live_doubles_(0),
+      liveness_size_(0),
       current_block_(NULL),
       current_instruction_(NULL),
+      block_index_(NULL),
+      block_count_(0),
       intervals_(kIntervalsInitial),
       unhandled_(kIntervalsInitial),
       active_(kIntervalsInitial),
@@ -60,15 +66,34 @@ LGen::LGen(HIRGen* hir, const char* filename, HIRBlock* root)
     registers_[i]->MarkFixed();
   }
 
+  CompileStats::Timer timer(CompileStats::kLIRBuild);
   FlattenBlocks(root);
   GenerateInstructions();
+  timer.Switch(CompileStats::kLiveness);
   ComputeLocalLiveSets();
   ComputeGlobalLiveSets();
+  if (is_too_large()) return;
+  timer.Switch(CompileStats::kBuildIntervals);
   BuildIntervals();
+  timer.Switch(CompileStats::kRegisterAllocation);
   WalkIntervals();
+  timer.Switch(CompileStats::kResolveDataFlow);
   ResolveDataFlow();
+  timer.Switch(CompileStats::kAllocateSpills);
   AllocateSpills();
 
+  if (CompileStats::enabled()) {
+    int instructions = 0;
+    HIRBlockList::Item* bhead = blocks_.head();
+    for (; bhead != NULL; bhead = bhead->next()) {
+      instructions += bhead->value()->lir()->instructions()->length();
+    }
+    CompileStats::Count(CompileStats::kLIRInstructions, instructions);
+    CompileStats::Count(CompileStats::kIntervals, intervals_.length());
+    CompileStats::Count(CompileStats::kLivenessBytes, liveness_size_);
+    CompileStats::Count(CompileStats::kSpills, spill_index_);
+  }
+
   if (log_) {
     PrintBuffer p(stdout);
     p.Print("## LIR %s Start ##\n", filename == NULL ? "unknown" : filename);
@@ -123,6 +148,14 @@ void LGen::FlattenBlocks(HIRBlock* root) {
       work_queue.Unshift(b->SuccAt(i));
     }
   }
+
+  block_count_ = blocks_.length();
+  block_index_ = reinterpret_cast<LBlock**>(Zone::current()->Allocate(
+      sizeof(*block_index_) * block_count_));
+  HIRBlockList::Item* bhead = blocks_.head();
+  for (int i = 0; bhead != NULL; bhead = bhead->next(), i++) {
+    block_index_[i] = bhead->value()->lir();
+  }
 }
 
 
@@ -135,6 +168,8 @@ void LGen::GenerateInstructions() {
     current_block_ = b->lir();
     Add(current_block_->label());
 
+    NumberDoubleBarriers(b);
+
     HIRInstructionList::Item* ihead = b->instructions()->head();
     for (; ihead != NULL; ihead = ihead->next()) {
       current_instruction_ = ihead->value();
@@ -143,6 +178,163 @@ void LGen::GenerateInstructions() {
   }
 }
 
+bool LGen::IsDoubleBinOp(HIRInstruction* instr) {
+  if (!instr->Is(HIRInstruction::kBinOp)) return false;
+
+  switch (HIRBinOp::Cast(instr)->binop_type()) {
+    case BinOp::kAdd:
+    case BinOp::kSub:
+    case BinOp::kMul:
+    case BinOp::kDiv:
+      return instr->representation() ==
+          HIRInstruction::kHeapNumberRepresentation;
+    default:
+      return false;
+  }
+}
+
+
+bool LGen::IsSmiSpeculation(HIRInstruction* instr) {
+  if (!instr->Is(HIRInstruction::kBinOp)) return false;
+
+  switch (HIRBinOp::Cast(instr)->binop_type()) {
+    case BinOp::kAdd:
+    case BinOp::kSub:
+    case BinOp::kMul:
+      return HIRBinOp::Cast(instr)->feedback() == TypeFeedback::kSmi;
+    default:
+      return false;
+  }
+}
+
+
+bool LGen::IsDoubleSpeculation(HIRInstruction* instr) {
+  if (!instr->Is(HIRInstruction::kBinOp)) return false;
+
+  int kinds = HIRBinOp::Cast(instr)->feedback();
+  switch (HIRBinOp::Cast(instr)->binop_type()) {
+    case BinOp::kAdd:
+    case BinOp::kSub:
+    case BinOp::kMul:
+    case BinOp::kDiv:
+      return (kinds & TypeFeedback::kNumber) != 0 &&
+             (kinds & TypeFeedback::kAny) == 0;
+    default:
+      return false;
+  }
+}
+
+
+bool LGen::IsSmiBinOp(HIRInstruction* instr) {
+  if (!instr->Is(HIRInstruction::kBinOp) || instr->range() == NULL) {
+    return false;
+  }
+
+  switch (HIRBinOp::Cast(instr)->binop_type()) {
+    case BinOp::kAdd:
+    case BinOp::kSub:
+    case BinOp::kMul:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+bool LGen::IsSmiCompare(HIRInstruction* instr) {
+  if (!instr->Is(HIRInstruction::kBinOp) ||
+      !BinOp::is_logic(HIRBinOp::Cast(instr)->binop_type())) {
+    return false;
+  }
+
+  if (instr->left()->range() == NULL || instr->right()->range() == NULL) {
+    return false;
+  }
+
+  // Result is consumed only by the branch (see VisitIf)
+  return instr->uses()->length() == 1 &&
+         instr->uses()->head()->value()->Is(HIRInstruction::kIf);
+}
+
+
+bool LGen::IsTailCall(HIRInstruction* instr) {
+  // Code entered from the baseline frame returns into it
+  if (hir_->osr_loop() != NULL) return false;
+
+  if (instr->uses()->length() != 1) return false;
+  HIRInstruction* use = instr->uses()->head()->value();
+
+  return use->Is(HIRInstruction::kReturn) && use->block() == instr->block();
+}
+
+
+bool LGen::CanKeepUnboxed(HIRInstruction* instr) {
+  if (!IsDoubleBinOp(instr) || instr->uses()->length() != 1) return false;
+
+  // Slow case of `+` may produce a string
+  if (HIRBinOp::Cast(instr)->binop_type() == BinOp::kAdd &&
+      (!instr->left()->IsNumberOnly() || !instr->right()->IsNumberOnly())) {
+    return false;
+  }
+
+  // The only use should be a later arithmetic in the same block
+  HIRInstruction* use = instr->uses()->head()->value();
+  if (!IsDoubleBinOp(use) || use->block() != instr->block()) return false;
+  if (use->block_pos <= instr->block_pos) return false;
+
+  // Nothing between them should clobber double registers
+  return use->double_barrier_pos < instr->block_pos;
+}
+
+
+bool LGen::PreservesDoubles(HIRInstruction* instr) {
+  // Double registers are preserved only by instructions without calls
+  switch (instr->type()) {
+    case HIRInstruction::kNop:
+    case HIRInstruction::kNil:
+    case HIRInstruction::kLiteral:
+    case HIRInstruction::kLoadContext:
+      return true;
+    case HIRInstruction::kBinOp:
+      return IsDoubleBinOp(instr);
+    default:
+      return false;
+  }
+}
+
+
+void LGen::NumberDoubleBarriers(HIRBlock* block) {
+  int pos = 0;
+  int barrier = -1;
+
+  HIRInstructionList::Item* head = block->instructions()->head();
+  for (; head != NULL; head = head->next(), pos++) {
+    HIRInstruction* instr = head->value();
+
+    instr->block_pos = pos;
+    instr->double_barrier_pos = barrier;
+    if (!PreservesDoubles(instr)) barrier = pos;
+  }
+}
+
+
+int LGen::AllocateDouble() {
+  for (int i = 0; i < kLIRDoubleRegisterCount; i++) {
+    if ((live_doubles_ & (1 << i)) == 0) {
+      live_doubles_ |= 1 << i;
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+
+void LGen::ReleaseDouble(int index) {
+  assert(live_doubles_ & (1 << index));
+  live_doubles_ &= ~(1 << index);
+}
+
 #define LGEN_VISIT_SWITCH(V) \
     case HIRInstruction::k##V: Visit##V(instr); break;
 
@@ -160,6 +352,10 @@ void LGen::VisitGoto(HIRInstruction* instr) {
   HIRBlock* succ = instr->block()->SuccAt(0);
   int parent_index = succ->PredAt(0) != instr->block();
 
+  // Phi moves are parallel, but are emitted one after another: inputs that
+  // are phis of the same block and are overwritten by preceding moves
+  // (i.e. `a = b; b = a` in loops) should be copied before all moves.
+  ZoneList<LInstruction*> copies;
   HIRPhiList::Item* head = succ->phis()->head();
   for (; head != NULL; head = head->next()) {
     HIRPhi* phi = head->value();
@@ -167,23 +363,18 @@ void LGen::VisitGoto(HIRInstruction* instr) {
     // Skip phis that are eliminated by Dead Code Eliminator
     if (!phi->is_live) continue;
 
-    LInstruction* lphi = NULL;
-
     assert(!phi->IsRemoved());
 
     // Initialize LIR representation of phi
     if (phi->lir() == NULL) {
       LInterval* iphi = CreateVirtual();
 
-      lphi = new LPhi();
+      LInstruction* lphi = new LPhi();
       lphi->AddArg(iphi, LUse::kAny)
           ->SetResult(iphi, LUse::kAny);
 
       phi->lir(lphi);
-    } else {
-      lphi = phi->lir();
     }
-    assert(lphi != NULL);
 
     HIRInstruction* input = phi->InputAt(parent_index);
     // Inputs can be not generated yet
@@ -198,9 +389,44 @@ void LGen::VisitGoto(HIRInstruction* instr) {
       input->lir(pinput);
     }
 
-    Add(new LMove())
-        ->SetResult(lphi->result->interval(), LUse::kAny)
-        ->AddArg(input, LUse::kAny);
+    LInstruction* copy = NULL;
+    if (input->Is(HIRInstruction::kPhi) && input->block() == succ) {
+      HIRPhiList::Item* prev = succ->phis()->head();
+      for (; prev != head; prev = prev->next()) {
+        if (prev->value() != input) continue;
+
+        copy = Add(new LMove())
+            ->SetResult(CreateVirtual(), LUse::kAny)
+            ->AddArg(input, LUse::kAny);
+        break;
+      }
+    }
+    copies.Push(copy);
+  }
+
+  head = succ->phis()->head();
+  for (; head != NULL; head = head->next()) {
+    HIRPhi* phi = head->value();
+    if (!phi->is_live) continue;
+
+    LInstruction* lphi = phi->lir();
+    assert(lphi != NULL);
+
+    LInstruction* copy = copies.Shift();
+    LInstruction* move = Add(new LMove())
+        ->SetResult(lphi->result->interval(), LUse::kAny);
+    if (copy != NULL) {
+      move->AddArg(copy, LUse::kAny);
+    } else {
+      move->AddArg(phi->InputAt(parent_index), LUse::kAny);
+    }
+
+    // Try to put phi and its inputs into the same register, so the move
+    // will be eliminated
+    LInterval* iphi = move->result->interval();
+    LInterval* iinput = move->inputs[0]->interval();
+    if (iphi->register_hint == NULL) iphi->register_hint = move->inputs[0];
+    if (iinput->register_hint == NULL) iinput->register_hint = move->result;
   }
 
   Bind(new LGoto());
@@ -230,83 +456,85 @@ void LGen::ComputeLocalLiveSets() {
 
       // Inputs to live_gen
       for (int i = 0; i < instr->input_count(); i++) {
-        LUse* input = instr->inputs[i];
-        NumberKey* key = NumberKey::New(input->interval()->id);
+        int id = instr->inputs[i]->interval()->id;
 
-        if (l->live_kill.Get(key) == NULL) {
-          l->live_gen.Set(key, input);
-        }
+        if (!l->live_kill.Test(id)) l->live_gen.Set(id);
       }
 
       // Scratches to live_kill
       for (int i = 0; i < instr->scratch_count(); i++) {
-        LUse* scratch = instr->scratches[i];
-        l->live_kill.Set(NumberKey::New(scratch->interval()->id), scratch);
+        l->live_kill.Set(instr->scratches[i]->interval()->id);
       }
 
       // Result to live_kill
-      if (instr->result) {
-        LUse* result = instr->result;
-        l->live_kill.Set(NumberKey::New(result->interval()->id), result);
-      }
+      if (instr->result) l->live_kill.Set(instr->result->interval()->id);
     }
+    liveness_size_ += l->live_gen.byte_size() + l->live_kill.byte_size();
   }
 }
 
 
 void LGen::ComputeGlobalLiveSets() {
-  bool change;
-  LUseMap::Item* mitem;
-
-  do {
-    change = false;
-
-    // Traverse blocks in reverse order
-    HIRBlockList::Item* tail = blocks_.tail();
-    for (; tail != NULL; tail = tail->prev()) {
-      HIRBlock* b = tail->value();
-      LBlock* l = b->lir();
-
-      // Every successor's input adds to current's output
-      for (int i = 0; i < b->succ_count(); i++) {
-        mitem = b->SuccAt(i)->lir()->live_in.head();
-        for (; mitem != NULL; mitem = mitem->next_scalar()) {
-          if (l->live_out.Get(mitem->key()) == NULL) {
-            l->live_out.Set(mitem->key(), mitem->value());
-            change = true;
-          }
-        }
-      }
+  int* queued = reinterpret_cast<int*>(Zone::current()->Allocate(
+      sizeof(*queued) * hir_->blocks()->length()));
+  memset(queued, 0, sizeof(*queued) * hir_->blocks()->length());
 
-      // Inputs are live_gen...
-      mitem = l->live_gen.head();
-      for (; mitem != NULL; mitem = mitem->next_scalar()) {
-        if (l->live_in.Get(mitem->key()) == NULL) {
-          l->live_in.Set(mitem->key(), mitem->value());
-          change = true;
-        }
-      }
+  // Blocks are in linear order, enqueue them in reverse order, so successors
+  // are (mostly) visited before predecessors
+  HIRBlockList work_queue;
+  HIRBlockList::Item* tail = blocks_.tail();
+  for (; tail != NULL; tail = tail->prev()) {
+    work_queue.Push(tail->value());
+    queued[tail->value()->id] = 1;
+  }
 
-      // ...and everything in output that isn't killed by current block
-      mitem = l->live_out.head();
-      for (; mitem != NULL; mitem = mitem->next_scalar()) {
-        if (l->live_in.Get(mitem->key()) == NULL &&
-            l->live_kill.Get(mitem->key()) == NULL) {
-          l->live_in.Set(mitem->key(), mitem->value());
-          change = true;
-        }
-      }
+  while (work_queue.length() > 0) {
+    HIRBlock* b = work_queue.Shift();
+    LBlock* l = b->lir();
+    queued[b->id] = 0;
+
+    int in_size = l->live_in.byte_size();
+    int out_size = l->live_out.byte_size();
+
+    // Every successor's input adds to current's output
+    for (int i = 0; i < b->succ_count(); i++) {
+      b->SuccAt(i)->lir()->live_in.Copy(&l->live_out);
+    }
+
+    // Inputs are live_gen and everything in output that isn't killed by
+    // current block
+    bool change = l->live_gen.Copy(&l->live_in);
+    if (l->live_out.CopyExcept(&l->live_in, &l->live_kill)) change = true;
+
+    // Grown sets are allocated again in the zone
+    if (l->live_in.byte_size() != in_size) {
+      liveness_size_ += l->live_in.byte_size();
+    }
+    if (l->live_out.byte_size() != out_size) {
+      liveness_size_ += l->live_out.byte_size();
     }
+    if (is_too_large()) return;
+
+    // Predecessors' outputs should be updated
+    if (!change) continue;
+    for (int i = 0; i < b->pred_count(); i++) {
+      HIRBlock* pred = b->PredAt(i);
+      if (queued[pred->id]) continue;
 
-    // Loop while there're any changes
-  } while (change);
+      work_queue.Push(pred);
+      queued[pred->id] = 1;
+    }
+  }
 }
 
 
 void LGen::BuildIntervals() {
+  // Uses of fixed registers by calls are found in reverse order, inserting
+  // them one-by-one into sorted lists is quadratic, merge them in the end
+  ZoneList<LUse*> call_uses[kLIRRegisterCount];
+
   // Traverse blocks in reverse order
   HIRBlockList::Item* tail = blocks_.tail();
-  LUseMap::Item* mitem;
   for (; tail != NULL; tail = tail->prev()) {
     HIRBlock* b = tail->value();
     LBlock* l = b->lir();
@@ -317,9 +545,9 @@ void LGen::BuildIntervals() {
 
     // Add full block range to intervals that live out of this block
     // (we'll shorten those range later if needed).
-    mitem = l->live_out.head();
-    for (; mitem != NULL; mitem = mitem->next_scalar()) {
-      mitem->value()->interval()->AddRange(l->start_id, l->end_id + 2);
+    LLiveSet* live_out = &l->live_out;
+    for (int id = live_out->Next(0); id != -1; id = live_out->Next(id + 1)) {
+      intervals_.At(id)->AddRange(l->start_id, l->end_id + 2);
     }
 
     // And instructions too
@@ -331,7 +559,8 @@ void LGen::BuildIntervals() {
         for (int i = 0; i < kLIRRegisterCount; i++) {
           if (registers_[i]->Covers(instr->id)) continue;
           registers_[i]->AddRange(instr->id, instr->id + 1);
-          registers_[i]->Use(LUse::kRegister, instr);
+          call_uses[i].Unshift(
+              new LUse(registers_[i], LUse::kRegister, instr));
         }
       }
 
@@ -342,7 +571,7 @@ void LGen::BuildIntervals() {
         // instruction itself
         if (res->ranges()->length() == 0) {
           res->AddRange(instr->id, instr->id + 1);
-        } else if (l->live_in.Get(NumberKey::New(res->id)) == NULL) {
+        } else if (!l->live_in.Test(res->id)) {
           // Shorten first range
           res->ranges()->head()->start(instr->id);
         }
@@ -364,6 +593,30 @@ void LGen::BuildIntervals() {
       }
     }
   }
+
+  for (int i = 0; i < kLIRRegisterCount; i++) {
+    if (call_uses[i].length() == 0) continue;
+
+    LUseList* uses = registers_[i]->uses();
+    int count = uses->length();
+    LUse** fixed = reinterpret_cast<LUse**>(Zone::current()->Allocate(
+        sizeof(*fixed) * count));
+    for (int j = 0; j < count; j++) fixed[j] = uses->Shift();
+
+    // Both are sorted, call's use goes first at the same position
+    // (as it'd be with InsertSorted())
+    ZoneList<LUse*>::Item* call = call_uses[i].head();
+    int j = 0;
+    while (call != NULL || j < count) {
+      if (call != NULL &&
+          (j == count || call->value()->instr()->id <= fixed[j]->instr()->id)) {
+        uses->Push(call->value());
+        call = call->next();
+      } else {
+        uses->Push(fixed[j++]);
+      }
+    }
+  }
 }
 
 
@@ -520,10 +773,11 @@ void LGen::TryAllocateFreeReg(LInterval* current) {
   }
   assert(max >= 0);
 
-  // Prefer register hint if possible
+  // Prefer register hint if it won't cause more splits than the best register
   if (current->register_hint != NULL && current->register_hint->is_register()) {
     int reg = current->register_hint->interval()->index();
-    if (free_pos[reg] - 2 > current->start()) {
+    if (free_pos[reg] - 2 > current->start() &&
+        (free_pos[reg] > current->end() || free_pos[reg] >= max)) {
       max = free_pos[reg];
       max_reg = reg;
     }
@@ -534,7 +788,8 @@ void LGen::TryAllocateFreeReg(LInterval* current) {
 
   if (max <= current->end()) {
     // Split before `max` is needed
-    Split(current, max % 2  == 0 ? (max - 1) : (max - 2));
+    Split(current,
+          FindSplitPos(current, max % 2  == 0 ? (max - 1) : (max - 2)));
   }
 
   // Register is available for whole interval's lifetime
@@ -614,7 +869,7 @@ void LGen::AllocateBlockedReg(LInterval* current) {
     Spill(current);
 
     if (first_use != NULL && first_use->instr()->id - 1 > current->start()) {
-      Split(current, first_use->instr()->id - 1);
+      Split(current, FindSplitPos(current, first_use->instr()->id - 1));
     }
   } else {
     // Intervals using register will be spilled
@@ -623,7 +878,7 @@ void LGen::AllocateBlockedReg(LInterval* current) {
     // If register is blocked somewhere before interval's end
     if (block_pos[use_reg] <= current->end()) {
       // Interval should be splitted
-      Split(current, block_pos[use_reg] - 1);
+      Split(current, FindSplitPos(current, block_pos[use_reg] - 1));
     }
 
     // Split and spill all intersecting intervals
@@ -681,10 +936,10 @@ void LGen::ResolveDataFlow() {
       LBlock* succ = b->hir()->SuccAt(i)->lir();
 
       // Create movements for non-matching parts of intervals
-      LUseMap::Item* mitem = succ->live_in.head();
-      for (; mitem != NULL; mitem = mitem->next_scalar()) {
-        LInterval* parent = mitem->value()->interval();
-        if (parent->split_parent()) parent = parent->split_parent();
+      LLiveSet* live_in = &succ->live_in;
+      for (int id = live_in->Next(0); id != -1; id = live_in->Next(id + 1)) {
+        LInterval* parent = intervals_.At(id);
+        assert(parent->split_parent() == NULL);
 
         // Skip intervals that wasn't split
         if (parent->split_children()->length() == 0) continue;
@@ -704,6 +959,12 @@ void LGen::ResolveDataFlow() {
             }
           }
 
+          // Spill slot is written before join, so it shouldn't be shared
+          // with gap's temporary spill (or anything else live there)
+          if (right->is_stackslot() && right->start() > gap->id) {
+            right->AddRange(gap->id, gap->id + 1);
+          }
+
           gap->Add(left->Use(LUse::kAny, gap), right->Use(LUse::kAny, gap));
         }
       }
@@ -712,7 +973,8 @@ void LGen::ResolveDataFlow() {
       LInstruction* control = b->instructions()->tail()->value();
       assert(control->type() == LInstruction::kGoto ||
              control->type() == LInstruction::kBranch ||
-             control->type() == LInstruction::kBranchNumber);
+             control->type() == LInstruction::kBranchNumber ||
+             control->type() == LInstruction::kBranchSmi);
 
       if (control->type() == LInstruction::kGoto &&
           bhead->next()->value()->lir() == succ) {
@@ -809,6 +1071,9 @@ void LGen::Generate(Masm* masm, SourceMap* map) {
   for (; bhead != NULL; bhead = bhead->next()) {
     LBlock* l = bhead->value()->lir();
 
+    // Back edges jump to the aligned loop header
+    if (bhead->value()->IsLoop()) masm->AlignLoop();
+
     LInstructionList::Item* lhead = l->instructions()->head();
     for (; lhead != NULL; lhead = lhead->next()) {
       LInstruction* instr = lhead->value();
@@ -932,7 +1197,6 @@ void LGen::ResultFromFixed(LInstruction* instr, Register reg) {
 
 
 LInterval* LGen::Split(LInterval* i, int pos) {
-  // TODO(indutny): Find optimal split position here
   assert(!i->IsFixed());
 
   assert(pos > i->start() && pos < i->end());
@@ -978,7 +1242,9 @@ LInterval* LGen::Split(LInterval* i, int pos) {
 
   // If parent ends on block's edge - move will be inserted when resolving
   // data flow
-  if (IsBlockStart(i->end())) return child;
+  if (IsBlockStart(pos) != NULL || IsBlockStart(i->end()) != NULL) {
+    return child;
+  }
 
   // Insert move right before split position, because
   // left side is definitely live here and right side haven't been used yet
@@ -989,12 +1255,61 @@ LInterval* LGen::Split(LInterval* i, int pos) {
 }
 
 
+int LGen::FindBlock(int pos) {
+  // Index of the last block starting at or before `pos`
+  int res = -1;
+  for (int i = 0, j = block_count_ - 1; i <= j; ) {
+    int middle = (i + j) >> 1;
+    if (block_index_[middle]->start_id <= pos) {
+      res = middle;
+      i = middle + 1;
+    } else {
+      j = middle - 1;
+    }
+  }
+
+  return res;
+}
+
+
+int LGen::FindSplitPos(LInterval* i, int pos) {
+  // Moves on block edges are inserted by ResolveDataFlow, so the interval
+  // may be split at any block's start between its start and `pos`.
+  // Pick the latest one with the lowest loop depth, to keep moves out of
+  // loops.
+  int last = FindBlock(pos);
+  if (last == -1) return pos;
+
+  int pos_depth = block_index_[last]->hir()->loop_depth;
+  int best_depth = INT_MAX;
+  int best = pos;
+  for (int k = FindBlock(i->start()) + 1; k <= last; k++) {
+    HIRBlock* b = block_index_[k]->hir();
+
+    // Loop header is entered from outside of the loop, back edge doesn't
+    // need a move if interval is live through the whole loop
+    int depth = b->loop_depth;
+    if (b->IsLoop() && depth > 0) depth--;
+
+    if (depth <= best_depth) {
+      best_depth = depth;
+      best = block_index_[k]->start_id;
+    }
+  }
+
+  // Don't move split out of the block without a reason
+  if (best_depth >= pos_depth) return pos;
+
+  return best;
+}
+
+
 LGap* LGen::GetGap(int pos) {
-  HIRBlockList::Item* bhead = blocks_.head();
   LInstructionList::Item* lhead = NULL;
   LBlock* l = NULL;
-  for (; bhead != NULL; bhead = bhead->next()) {
-    l = bhead->value()->lir();
+  int k = FindBlock(pos);
+  for (k = k == -1 ? 0 : k; k < block_count_; k++) {
+    l = block_index_[k];
 
     // Skip blocks that definitely can't contain gap
     if (l->end_id <= pos) continue;
@@ -1066,34 +1381,61 @@ void LInterval::AddRange(int start, int end) {
 }
 
 
-bool LInterval::Covers(int pos) {
-  for (int i = 0; i < ranges_.length(); i++) {
-    LRange* range = ranges_.At(i);
-    if (range->start() > pos) return false;
-    if (range->end() > pos) return true;
+int LInterval::FindRange(int pos) {
+  // Index of the first range that ends after `pos`
+  int low = 0;
+  int high = ranges_.length();
+  while (low < high) {
+    int mid = (low + high) >> 1;
+    if (ranges_.At(mid)->end() <= pos) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
   }
 
-  return false;
+  return low;
 }
 
 
-LUse* LInterval::UseAt(int pos) {
-  for (int i = 0; i < uses_.length(); i++) {
-    LUse* use = uses_.At(i);
-    if (use->instr()->id == pos) return use;
+int LInterval::FindUse(int pos) {
+  // Index of the first use that is at or after `pos`
+  int low = 0;
+  int high = uses_.length();
+  while (low < high) {
+    int mid = (low + high) >> 1;
+    if (uses_.At(mid)->instr()->id < pos) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
   }
 
-  return NULL;
+  return low;
+}
+
+
+bool LInterval::Covers(int pos) {
+  int i = FindRange(pos);
+  if (i >= ranges_.length()) return false;
+
+  return ranges_.At(i)->start() <= pos;
+}
+
+
+LUse* LInterval::UseAt(int pos) {
+  int i = FindUse(pos);
+  if (i >= uses_.length()) return NULL;
+
+  LUse* use = uses_.At(i);
+  return use->instr()->id == pos ? use : NULL;
 }
 
 
 LUse* LInterval::UseAfter(int pos, LUse::Type use_type) {
-  for (int i = 0; i < uses_.length(); i++) {
+  for (int i = FindUse(pos); i < uses_.length(); i++) {
     LUse* use = uses_.At(i);
-    if (use->instr()->id >= pos &&
-        (use_type == LUse::kAny || use->type() == use_type)) {
-      return use;
-    }
+    if (use_type == LUse::kAny || use->type() == use_type) return use;
   }
 
   return NULL;
@@ -1101,12 +1443,26 @@ LUse* LInterval::UseAfter(int pos, LUse::Type use_type) {
 
 
 int LInterval::FindIntersection(LInterval* with) {
-  for (int i = 0; i < ranges()->length(); i++) {
-    for (int j = 0; j < with->ranges()->length(); j++) {
-      int r = ranges()->At(i)->FindIntersection(with->ranges()->At(j));
-      if (r != -1) return r;
+  // Both range lists are sorted - walk them simultaneously, starting from
+  // the first ranges that could possibly intersect
+  if (ranges()->length() == 0 || with->ranges()->length() == 0) return -1;
+  int i = FindRange(with->start());
+  int j = with->FindRange(start());
+  while (i < ranges()->length() && j < with->ranges()->length()) {
+    LRange* a = ranges()->At(i);
+    LRange* b = with->ranges()->At(j);
+
+    int r = a->FindIntersection(b);
+    if (r != -1) return r;
+
+    // Advance the range that ends first
+    if (a->end() <= b->end()) {
+      i++;
+    } else {
+      j++;
     }
   }
+
   return -1;
 }
 
@@ -1152,7 +1508,11 @@ int LUse::Compare(LUse* a, LUse* b) {
 }
 
 
-LBlock::LBlock(HIRBlock* hir) : start_id(-1),
+LBlock::LBlock(HIRBlock* hir) : live_gen(0),
+                                live_kill(0),
+                                live_in(0),
+                                live_out(0),
+                                start_id(-1),
                                 end_id(-1),
                                 hir_(hir),
                                 label_(new LLabel()) {
@@ -51,7 +51,8 @@ class SourceMap;
 typedef SortableList<LInterval, NopPolicy, ZonePolicy> LIntervalList;
 typedef SortableList<LRange, NopPolicy, ZonePolicy> LRangeList;
 typedef SortableList<LUse, NopPolicy, ZonePolicy> LUseList;
-typedef ZoneMap<NumberKey, LUse, ZoneObject> LUseMap;
+// Sets of interval ids
+typedef BitField<EmptyClass, ZonePolicy> LLiveSet;
 
 class LRange : public ZoneObject {
  public:
@@ -176,6 +177,10 @@ class LInterval : public ZoneObject {
   LUse* register_hint;
 
  private:
+  // Binary search in sorted ranges and uses
+  int FindRange(int pos);
+  int FindUse(int pos);
+
   Type type_;
   LInstruction* definition_;
   int index_;
@@ -195,10 +200,10 @@ class LBlock : public ZoneObject {
 
   inline void PrintHeader(PrintBuffer* p);
 
-  LUseMap live_gen;
-  LUseMap live_kill;
-  LUseMap live_in;
-  LUseMap live_out;
+  LLiveSet live_gen;
+  LLiveSet live_kill;
+  LLiveSet live_in;
+  LLiveSet live_out;
 
   int start_id;
   int end_id;
@@ -221,6 +226,12 @@ class LGen : public ZoneObject {
 
   void Generate(Masm* masm, SourceMap* map);
 
+  // Liveness sets have taken more than kMaxLivenessSize bytes, registers
+  // weren't allocated and function should stay in baseline code
+  inline bool is_too_large() { return liveness_size_ > kMaxLivenessSize; }
+
+  static const int kMaxLivenessSize = 32 * 1024 * 1024;
+
   void FlattenBlocks(HIRBlock* root);
   void GenerateInstructions();
   void ComputeLocalLiveSets();
@@ -247,10 +258,35 @@ class LGen : public ZoneObject {
   inline LInterval* CreateStackSlot(int index);
   inline LInterval* CreateConst();
   inline LBlock* IsBlockStart(int pos);
+  int FindBlock(int pos);
+
+  // Unboxed doubles are passed between adjacent arithmetic instructions
+  // in double registers, and boxed only when escaping.
+  // NOTE: Values flowing into phis (i.e. loop-carried ones) are always boxed
+  bool IsDoubleBinOp(HIRInstruction* instr);
+  bool CanKeepUnboxed(HIRInstruction* instr);
+  bool PreservesDoubles(HIRInstruction* instr);
+  void NumberDoubleBarriers(HIRBlock* block);
+  int AllocateDouble();
+  void ReleaseDouble(int index);
+
+  // Baseline code has seen only smis (or numbers) at this arithmetic site,
+  // fast path is guarded and deoptimizes function on failure
+  bool IsSmiSpeculation(HIRInstruction* instr);
+  bool IsDoubleSpeculation(HIRInstruction* instr);
+
+  // Operands are proven to be SMIs and result can't overflow,
+  // instruction needs neither checks nor stub calls
+  bool IsSmiBinOp(HIRInstruction* instr);
+  bool IsSmiCompare(HIRInstruction* instr);
+
+  // Call's result is returned by the next instruction
+  bool IsTailCall(HIRInstruction* instr);
 
   LInterval* ToFixed(HIRInstruction* instr, Register reg);
   void ResultFromFixed(LInstruction* instr, Register reg);
   LInterval* Split(LInterval* i, int pos);
+  int FindSplitPos(LInterval* i, int pos);
   LGap* GetGap(int pos);
   void Spill(LInterval* interval);
 
@@ -270,11 +306,20 @@ class LGen : public ZoneObject {
   int instr_id_;
   int interval_id_;
   int virtual_index_;
+  int live_doubles_;
+
+  // Bytes allocated for liveness sets
+  int liveness_size_;
 
   LBlock* current_block_;
   HIRInstruction* current_instruction_;
 
   HIRBlockList blocks_;
+
+  // Flattened blocks ordered by their start ids, for binary search
+  LBlock** block_index_;
+  int block_count_;
+
   LInterval* registers_[kLIRRegisterCount];
   LIntervalList intervals_;
 
@@ -31,12 +31,17 @@ namespace internal {
 template <class T, class Policy, class Allocator>
 class SortableList {
  public:
-  explicit SortableList(int size) : map_(NULL), size_(0), grow_(size), len_(0) {
+  explicit SortableList(int size) : space_(NULL),
+                                    map_(NULL),
+                                    size_(0),
+                                    grow_(size),
+                                    len_(0) {
     Grow();
   }
 
   ~SortableList() {
-    delete[] map_;
+    delete[] space_;
+    space_ = NULL;
     map_ = NULL;
   }
 
@@ -49,30 +54,33 @@ class SortableList {
   inline void RemoveAt(int i) {
     if (i < 0 || i >= len_) return;
 
-    // Shift left
+    // Shift the shorter side of the list
     len_--;
-    for (int j = i; j < len_; j++) {
-      map_[j] = map_[j + 1];
+    if (i < len_ - i) {
+      for (int j = i; j > 0; j--) {
+        map_[j] = map_[j - 1];
+      }
+      map_++;
+    } else {
+      for (int j = i; j < len_; j++) {
+        map_[j] = map_[j + 1];
+      }
     }
   }
 
 
   inline void Push(T* item) {
-    if (len_ == size_) Grow();
+    if (map_ + len_ == space_ + size_) Grow();
 
     map_[len_++] = item;
   }
 
 
   inline void Unshift(T* item) {
-    if (len_ == size_) Grow();
+    if (map_ == space_) Grow();
 
-    // Shift right
     len_++;
-    for (int i = len_ - 1; i > 0; i--) {
-      map_[i] = map_[i - 1];
-    }
-    map_[0] = item;
+    *--map_ = item;
   }
 
 
@@ -86,15 +94,8 @@ class SortableList {
   inline T* Shift() {
     if (len_ == 0) return NULL;
 
-    T* res = map_[0];
-
-    // Shift left
     len_--;
-    for (int i = 0; i < len_; i++) {
-      map_[i] = map_[i + 1];
-    }
-
-    return res;
+    return *map_++;
   }
 
 
@@ -113,8 +114,6 @@ class SortableList {
       return;
     }
 
-    if (len_ == size_) Grow();
-
     // Perform binary search for correct position
     int middle_pos = -1;
     int cmp = 0;
@@ -138,13 +137,22 @@ class SortableList {
     } else {
       insert_pos = middle_pos + 1;
     }
-
-    len_++;
-    assert(insert_pos >= 0 && insert_pos < len_);
-
-    for (int i = len_ - 1; i > insert_pos; i--) {
-      map_[i] = map_[i - 1];
+    assert(insert_pos >= 0 && insert_pos <= len_);
+
+    // Shift the shorter side of the list, inserting at either end is cheap
+    if (insert_pos < len_ - insert_pos) {
+      if (map_ == space_) Grow();
+      map_--;
+      for (int i = 0; i < insert_pos; i++) {
+        map_[i] = map_[i + 1];
+      }
+    } else {
+      if (map_ + len_ == space_ + size_) Grow();
+      for (int i = len_; i > insert_pos; i--) {
+        map_[i] = map_[i - 1];
+      }
     }
+    len_++;
     map_[insert_pos] = value;
   }
 
@@ -154,15 +162,18 @@ class SortableList {
 
  protected:
   inline void Grow() {
-    // Allocate new map
-    int new_size = size_ + grow_;
-    T** new_map = new T*[new_size];
+    // Allocate new space, twice as big as the list, and put entries in the
+    // middle of it, leaving room for both Push() and Unshift()
+    int new_size = 2 * len_ + grow_;
+    T** new_space = new T*[new_size];
+    T** new_map = new_space + ((new_size - len_) >> 1);
 
     // Copy old entries
-    if (map_ != NULL) memcpy(new_map, map_, sizeof(*new_map) * size_);
+    if (len_ != 0) memcpy(new_map, map_, sizeof(*new_map) * len_);
 
     // Replace map
-    delete[] map_;
+    delete[] space_;
+    space_ = new_space;
     map_ = new_map;
     size_ = new_size;
   }
@@ -171,6 +182,7 @@ class SortableList {
     return T::Compare(*a, *b);
   }
 
+  T** space_;
   T** map_;
   int size_;
   int grow_;
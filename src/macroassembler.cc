@@ -44,6 +44,7 @@ void Masm::Move(LUse* dst, LUse* src) {
 
 void Masm::Move(LUse* dst, Register src) {
   if (dst->is_register()) {
+    if (dst->ToRegister().is(src)) return;
     mov(dst->ToRegister(), src);
   } else {
     assert(dst->is_stackslot());
@@ -65,7 +66,7 @@ void Masm::Move(LUse* dst, const Operand& src) {
 
 void Masm::Move(LUse* dst, Immediate src) {
   if (dst->is_register()) {
-    mov(dst->ToRegister(), src);
+    Move(dst->ToRegister(), src);
   } else {
     assert(dst->is_stackslot());
     mov(*dst->ToOperand(), src);
@@ -80,6 +81,59 @@ void AbsoluteAddress::Target(Masm* masm, int offset) {
 }
 
 
+void Masm::Defer(SlowPath* path) {
+  path->align_ = align_;
+  slow_paths_.Push(path);
+}
+
+
+void Masm::EmitSlowPaths() {
+  int32_t align = align_;
+
+  // Slow paths may defer other slow paths
+  SlowPath* path;
+  while ((path = slow_paths_.Shift()) != NULL) {
+    align_ = path->align_;
+
+    bind(&path->entry);
+    path->Generate(this);
+    jmp(&path->exit);
+  }
+
+  align_ = align;
+}
+
+
+void Masm::AlignLoop() {
+  // Multi-byte nops
+  static const uint8_t nops[][8] = {
+    { 0x90 },
+    { 0x66, 0x90 },
+    { 0x0F, 0x1F, 0x00 },
+    { 0x0F, 0x1F, 0x40, 0x00 },
+    { 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+    { 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+    { 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
+    { 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }
+  };
+
+  uint32_t padding = RoundUp(offset(), 16) - offset();
+  while (padding > 0) {
+    uint32_t size = padding > 8 ? 8 : padding;
+    for (uint32_t i = 0; i < size; i++) emitb(nops[size - 1][i]);
+    padding -= size;
+  }
+}
+
+
+void Masm::RecordExternal(ExternalReference::Type type) {
+  uint32_t offset = this->offset() - HValue::kPointerSize;
+  char* value = *reinterpret_cast<char**>(buffer() + offset);
+
+  externals_.Push(new ExternalReference(type, offset, value));
+}
+
+
 void AbsoluteAddress::Use(Masm* masm, int offset) {
   assert(r_ == NULL);
   r_ = new RelocationInfo(RelocationInfo::kAbsolute,
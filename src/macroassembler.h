@@ -37,6 +37,34 @@ namespace internal {
 class BaseStub;
 class LUse;
 
+// Process-specific address moved into a register as an immediate (entry of
+// the stub, heap's field, function's profile or type feedback), code with
+// all of them recorded can be saved in the code cache (see CodeCache)
+class ExternalReference : public ZoneObject {
+ public:
+  enum Type {
+    kStub,
+    kHeapAddress,
+    kProfile,
+    kFeedback
+  };
+
+  ExternalReference(Type type, uint32_t offset, char* value)
+      : type_(type), offset_(offset), value_(value) {
+  }
+
+  inline Type type() { return type_; }
+  inline uint32_t offset() { return offset_; }
+  inline char* value() { return value_; }
+
+ private:
+  Type type_;
+  uint32_t offset_;
+  char* value_;
+};
+
+typedef ZoneList<ExternalReference*> ExternalReferenceList;
+
 class Masm : public Assembler {
  public:
   explicit Masm(CodeSpace* space);
@@ -78,11 +106,40 @@ class Masm : public Assembler {
     int32_t index_;
   };
 
+  // Rarely executed code (GC calls, deoptimization), placed out of line
+  // after the function's code, so the hot path falls through not-taken
+  // branches. Hot path jumps to `entry`, slow path returns to `exit`.
+  class SlowPath : public ZoneObject {
+   public:
+    SlowPath() : align_(0) {
+    }
+
+    virtual void Generate(Masm* masm) = 0;
+
+    Label entry;
+    Label exit;
+
+   private:
+    // Stack alignment at the place of the jump to the slow path
+    int32_t align_;
+
+    friend class Masm;
+  };
+
+  void Defer(SlowPath* path);
+
+  // Generates code of the deferred slow paths, called by AlignCode()
+  void EmitSlowPaths();
+
+  // Pads code with nops up to the 16-byte boundary, for the targets of
+  // the backward jumps (i.e. loop headers)
+  void AlignLoop();
+
   // Allocate slots for spills
   void AllocateSpills();
   void FinalizeSpills();
 
-  // Skip some bytes to make code aligned
+  // Emits slow paths and skips some bytes to make code aligned
   void AlignCode();
 
   // Alignment helpers
@@ -101,6 +158,11 @@ class Masm : public Assembler {
   // Allocate heap numbers
   void AllocateNumber(DoubleRegister value, Register result);
 
+  // Load value of unboxed or heap number into double register
+  // Jmp to not_number label if value isn't a number
+  // (not_number may be NULL if value is known to be a number)
+  void UnboxNumber(Register number, DoubleRegister result, Label* not_number);
+
   // Allocate object&map
   void AllocateObjectLiteral(Heap::HeapTag tag,
                              Register tag_reg,
@@ -142,11 +204,29 @@ class Masm : public Assembler {
   void Move(LUse* dst, const Operand& src);
   void Move(LUse* dst, Immediate src);
 
+  // Loads immediate using the shortest encoding, unlike mov() which
+  // always leaves 64bit slot for the relocations and external references
+  void Move(Register dst, Immediate src);
+
   // Sets correct environment and calls function
   void Call(Register addr);
   void Call(const Operand& addr);
   void Call(char* stub);
   void CallFunction(Register fn);
+
+  // Replaces current frame with the one of `fn` call: arguments are moved
+  // into the caller's argument area and function's code is entered with
+  // the caller's return address. Jumps to `fallback` if arguments don't fit
+  // there or function is a binding.
+  void TailCallFunction(Register fn, Label* fallback);
+
+  // Unconditional jump to the absolute address
+  // (used to redirect baseline code to the optimized one)
+  void Jump(char* code);
+
+  // Records address that was just moved into the register
+  void RecordExternal(ExternalReference::Type type);
+  inline ExternalReferenceList* externals() { return &externals_; }
   void ProbeCPU();
 
   enum BinOpUsage {
@@ -184,6 +264,9 @@ class Masm : public Assembler {
   // Temporary operand
   Operand spill_operand_;
 
+  ExternalReferenceList externals_;
+  ZoneList<SlowPath*> slow_paths_;
+
   friend class Align;
 };
 
@@ -33,42 +33,42 @@
 namespace candor {
 namespace internal {
 
-PIC::PIC(CodeSpace* space) : space_(space),
-                             chunk_(NULL),
-                             protos_(NULL),
-                             results_(NULL),
-                             size_(0) {
+PIC::PIC(CodeSpace* space) : space_(space), chunk_(NULL), size_(0) {
+  for (int i = 0; i < kMaxSize; i++) {
+    entries_[i].proto = reinterpret_cast<char*>(Heap::kICZapValue);
+    entries_[i].result = 0;
+  }
 }
 
 
 PIC::~PIC() {
-  delete[] protos_;
-  delete[] results_;
   chunk_ = NULL;
 }
 
 
+void PIC::Release() {
+  for (int i = 0; i < size_; i++) {
+    space_->heap()->Dereference(
+        reinterpret_cast<HValue**>(&entries_[i].proto),
+        reinterpret_cast<HValue*>(entries_[i].proto));
+  }
+
+  // Chunk will be collected, unless PIC's code is still on the stack
+  if (chunk_ != NULL) chunk_->Unref();
+  chunk_ = NULL;
+  size_ = 0;
+}
+
+
 char* PIC::Generate() {
   Zone zone;
   Masm masm(space_);
 
   Generate(&masm);
 
-  if (chunk_ != NULL) chunk_->Unref();
   chunk_ = space_->CreateChunk("__pic__", "", 0);
   space_->Put(chunk_, &masm);
 
-  // At this stage protos_ and results_ should contain offsets,
-  // get real addresses for them and reference protos in heap
-  for (int i = 0; i < size_; i++) {
-    proto_offsets_[i] = reinterpret_cast<char**>(
-        chunk_->addr() + reinterpret_cast<intptr_t>(proto_offsets_[i]));
-
-    space_->heap()->Reference(Heap::kRefWeak,
-                              reinterpret_cast<HValue**>(proto_offsets_[i]),
-                              reinterpret_cast<HValue*>(*proto_offsets_[i]));
-  }
-
   return chunk_->addr();
 }
 
@@ -105,32 +105,19 @@ void PIC::Miss(char* object, intptr_t result, char* ip) {
 
   // Patch call site and remove call to PIC
   if (size_ >= kMaxSize) {
+    CodeSpace::WriteScope scope(space_);
+    space_->Unprotect(reinterpret_cast<char*>(call_ip), sizeof(*call_ip));
     *call_ip = space_->stubs()->GetLookupPropertyStub();
     return;
   }
 
-  // Lazily allocate memory for protos and results
-  if (size_ == 0) {
-    protos_ = new char*[kMaxSize];
-    results_ = new intptr_t[kMaxSize];
-  }
-
-  protos_[size_] = proto;
-  results_[size_] = result;
+  // Append entry, GC will update it if proto moves
+  entries_[size_].proto = proto;
+  entries_[size_].result = result;
   space_->heap()->Reference(Heap::kRefWeak,
-                            reinterpret_cast<HValue**>(&protos_[size_]),
-                            reinterpret_cast<HValue*>(protos_[size_]));
-
-  // Dereference protos in previous version of PIC
-  for (int i = 0; i < size_; i++) {
-    space_->heap()->Dereference(reinterpret_cast<HValue**>(proto_offsets_[i]),
-                                reinterpret_cast<HValue*>(*proto_offsets_[i]));
-  }
-
+                            reinterpret_cast<HValue**>(&entries_[size_].proto),
+                            reinterpret_cast<HValue*>(proto));
   size_++;
-
-  // Generate new PIC and replace previous one
-  *call_ip = Generate();
 }
 
 }  // namespace internal
@@ -44,9 +44,14 @@ class PIC {
   explicit PIC(CodeSpace* space);
   ~PIC();
 
+  // Code is generated once, misses only fill entries of the table it reads
   char* Generate();
   static void Miss(PIC* pic, char* object, intptr_t result, char* ip);
 
+  // Removes heap's references to the protos and releases PIC's code,
+  // should be called once nothing calls it anymore (see CodeSpace::Free)
+  void Release();
+
  protected:
   void Generate(Masm* masm);
 
@@ -54,11 +59,15 @@ class PIC {
 
   static const int kMaxSize = 5;
 
+  // Unused entries hold Heap::kICZapValue, which never matches a proto
+  struct Entry {
+    char* proto;
+    intptr_t result;
+  };
+
   CodeSpace* space_;
   CodeChunk* chunk_;
-  char** protos_;
-  char** proto_offsets_[kMaxSize];
-  intptr_t* results_;
+  Entry entries_[kMaxSize];
   int size_;
 };
 
@@ -26,11 +26,65 @@
 #include "heap.h"  // HContext
 #include "heap-inl.h"
 #include "utils.h"  // List
+#include "visitor.h"  // Visitor
 
 namespace candor {
 namespace internal {
 
-Root::Root(Heap* heap) : heap_(heap) {
+class RootPrefiller : public Visitor<AstNode> {
+ public:
+  explicit RootPrefiller(Root* root) : Visitor<AstNode>(kPreorder),
+                                       root_(root) {
+  }
+
+  AstNode* VisitCall(AstNode* node) {
+    FunctionLiteral* fn = FunctionLiteral::Cast(node);
+
+    Visit(fn->variable());
+
+    AstList::Item* arg = fn->args()->head();
+    for (; arg != NULL; arg = arg->next()) {
+      Visit(arg->value());
+    }
+
+    return NULL;
+  }
+
+  AstNode* VisitObjectLiteral(AstNode* node) {
+    ObjectLiteral* obj = ObjectLiteral::Cast(node);
+
+    AstList::Item* khead = obj->keys()->head();
+    AstList::Item* vhead = obj->values()->head();
+    for (; khead != NULL; khead = khead->next(), vhead = vhead->next()) {
+      Visit(khead->value());
+      Visit(vhead->value());
+    }
+
+    return NULL;
+  }
+
+  AstNode* VisitLiteral(AstNode* node) {
+    root_->Put(node);
+    return NULL;
+  }
+
+  AstNode* VisitNumber(AstNode* node) { return VisitLiteral(node); }
+  AstNode* VisitTrue(AstNode* node) { return VisitLiteral(node); }
+  AstNode* VisitFalse(AstNode* node) { return VisitLiteral(node); }
+  AstNode* VisitString(AstNode* node) { return VisitLiteral(node); }
+  AstNode* VisitProperty(AstNode* node) { return VisitLiteral(node); }
+
+ private:
+  Root* root_;
+};
+
+
+Root::Root(Heap* heap) : heap_(heap),
+                         context_(NULL),
+                         context_slots_(0),
+                         loaded_(true),
+                         prefilling_(false),
+                         literals_(NULL) {
   // Create a `global` object
   values()->Push(HObject::NewEmpty(heap));
 
@@ -50,7 +104,45 @@ Root::Root(Heap* heap) : heap_(heap) {
 }
 
 
+Root::Root(Heap* heap, HContext* context) : heap_(heap),
+                                           context_(context),
+                                           context_slots_(context->slots()),
+                                           loaded_(false),
+                                           prefilling_(false),
+                                           literals_(NULL) {
+}
+
+
+void Root::Load() {
+  if (loaded_) return;
+  loaded_ = true;
+
+  for (int i = 0; i < context_slots_; i++) {
+    char* value = *context_->GetSlotAddress(i);
+
+    ScopeSlot* slot = new ScopeSlot(ScopeSlot::kContext, -2);
+    slot->index(values()->length());
+    values()->Push(value);
+    map_.Set(NumberKey::New(value), slot);
+  }
+}
+
+
+char* Root::Get(int index) {
+  if (index < context_slots_) return *context_->GetSlotAddress(index);
+
+  HValueList::Item* head = values()->head();
+  for (int i = 0; head != NULL; head = head->next(), i++) {
+    if (i == index) return head->value();
+  }
+
+  return NULL;
+}
+
+
 ScopeSlot* Root::GetSlot(char* value) {
+  Load();
+
   ScopeSlot* slot = map_.Get(NumberKey::New(value));
 
   if (slot != NULL) return slot;
@@ -65,6 +157,11 @@ ScopeSlot* Root::GetSlot(char* value) {
 
 ScopeSlot* Root::Put(AstNode* node) {
   ScopeSlot* slot = NULL;
+
+  if (literals_ != NULL) {
+    slot = literals_->Get(NumberKey::New(node));
+    if (slot != NULL) return slot;
+  }
   char* value = HNil::New();
 
   switch (node->type()) {
@@ -93,7 +190,15 @@ ScopeSlot* Root::Put(AstNode* node) {
   if (slot != NULL) return slot;
 
   assert(value != NULL);
-  return GetSlot(value);
+  slot = GetSlot(value);
+
+  // Only slots of the allocated root context are valid for later compilations
+  if (prefilling_ && literals_ != NULL &&
+      (context_ == NULL || slot->index() < context_slots_)) {
+    literals_->Set(NumberKey::New(node), slot);
+  }
+
+  return slot;
 }
 
 
@@ -130,6 +235,15 @@ char* Root::StringToValue(AstNode* node) {
 }
 
 
+void Root::Prefill(AstNode* ast) {
+  RootPrefiller p(this);
+
+  prefilling_ = true;
+  p.Visit(ast);
+  prefilling_ = false;
+}
+
+
 HContext* Root::Allocate() {
   return HValue::As<HContext>(HContext::New(heap(), values()));
 }
@@ -38,23 +38,50 @@ class HContext;
 class Root {
  public:
   typedef ZoneList<char*> HValueList;
+  typedef ZoneMap<NumberKey, ScopeSlot, ZoneObject> SlotMap;
 
   explicit Root(Heap* heap);
 
+  // Continue filling already allocated root context, its values are read
+  // only if some literal isn't in literals() (see below)
+  Root(Heap* heap, HContext* context);
+
   ScopeSlot* Put(AstNode* node);
+
+  // Put literals of all functions in the AST, so that functions that are
+  // compiled later won't need to extend allocated root context
+  void Prefill(AstNode* ast);
   HContext* Allocate();
 
+  // Value in the root slot
+  char* Get(int index);
+
+  // New constants were added to the allocated root context
+  inline bool is_extended() {
+    return context_ != NULL && values_.length() > context_slots_;
+  }
+
   inline Heap* heap() { return heap_; }
   inline HValueList* values() { return &values_; }
 
+  // Slots of the literals put by Prefill() are remembered in the map (kept by
+  // CodeChunk), Put() returns them without creating literals' values again
+  inline void literals(SlotMap* literals) { literals_ = literals; }
+
  private:
+  void Load();
   char* NumberToValue(AstNode* node, ScopeSlot** slot);
   char* StringToValue(AstNode* node);
   ScopeSlot* GetSlot(char* value);
 
   Heap* heap_;
+  HContext* context_;
+  int context_slots_;
+  bool loaded_;
+  bool prefilling_;
   HValueList values_;
   ZoneMap<NumberKey, ScopeSlot, ZoneObject> map_;
+  SlotMap* literals_;
 };
 
 }  // namespace internal
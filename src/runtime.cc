@@ -26,12 +26,15 @@
 #include <inttypes.h>  // printf formats for big integers
 #include <stdint.h>  // uint32_t
 #include <assert.h>  // assert
-#include <string.h>  // strncmp
+#include <string.h>  // memcpy
 #include <stdio.h>  // snprintf
+#include <stdlib.h>  // abort
 #include <sys/types.h>  // size_t
 
 #include "heap.h"  // Heap
 #include "heap-inl.h"
+#include "string-ops.h"  // StringOps
+#include "code-space.h"  // CodeSpace
 #include "utils.h"  // ComputeHash, etc
 
 namespace candor {
@@ -83,6 +86,35 @@ void RuntimeCollectGarbage(Heap* heap, char* stack_top) {
 }
 
 
+void RuntimeTierUp(Heap* heap, CodeProfile* profile, char* root) {
+  if (heap->code_space()->Optimize(profile, root) == NULL) profile->Disable();
+}
+
+
+void RuntimeCompileLazy(Heap* heap, CodeProfile* profile, char* root) {
+  if (heap->code_space()->CompileLazy(profile, root)) return;
+
+  // Trampoline can't continue without function's code
+  fprintf(stderr, "Lazy compilation failed: root context can't be extended\n");
+  abort();
+}
+
+
+char* RuntimeOSR(Heap* heap, CodeProfile* profile, intptr_t loop, char* root) {
+  char* code = heap->code_space()->CompileOSR(profile,
+                                              HNumber::Untag(loop),
+                                              root);
+  if (code == NULL) profile->Disable();
+
+  return code;
+}
+
+
+void RuntimeDeoptimize(Heap* heap, CodeProfile* profile, intptr_t version) {
+  heap->code_space()->Deoptimize(profile, HNumber::Untag(version));
+}
+
+
 intptr_t RuntimeGetHash(Heap* heap, char* value) {
   Heap::HeapTag tag = HValue::GetTag(value);
 
@@ -139,6 +171,7 @@ intptr_t RuntimeLookupProperty(Heap* heap,
   char* keyptr = NULL;
   int64_t numkey = 0;
   uint32_t hash = 0;
+  bool by_pointer = is_array;
 
   if (is_array) {
     numkey = HNumber::IntegralValue(RuntimeToNumber(heap, key));
@@ -156,6 +189,16 @@ intptr_t RuntimeLookupProperty(Heap* heap,
     assert(HValue::GetTag(obj) == Heap::kTagObject);
     keyptr = key;
     hash = RuntimeGetHash(heap, key);
+
+    // String keys are interned, compare them by pointer
+    if (heap != NULL && HValue::GetTag(key) == Heap::kTagString) {
+      char* interned = insert ? heap->string_table()->Intern(key) :
+                                heap->string_table()->Find(key);
+
+      // Not interned key can't be in the object
+      if (interned != NULL) keyptr = interned;
+      by_pointer = true;
+    }
   }
 
   if (is_array && HArray::IsDense(obj)) {
@@ -184,8 +227,8 @@ intptr_t RuntimeLookupProperty(Heap* heap,
     do {
       key_slot = *reinterpret_cast<char**>(space + index);
       if (key_slot == HNil::New() ||
-          (is_array && key_slot == keyptr) ||
-          RuntimeStrictCompare(heap, key_slot, key) == 0) {
+          key_slot == keyptr ||
+          (!by_pointer && RuntimeStrictCompare(heap, key_slot, key) == 0)) {
         needs_grow = false;
         break;
       }
@@ -381,6 +424,12 @@ intptr_t RuntimeStrictCompare(Heap* heap, char* lhs, char* rhs) {
 
   switch (tag) {
     case Heap::kTagString:
+      // Strings with different (already computed) hashes can't be equal
+      if (HString::Length(lhs) != HString::Length(rhs)) return -1;
+      if (HString::HasHash(lhs) && HString::HasHash(rhs) &&
+          HString::CachedHash(lhs) != HString::CachedHash(rhs)) {
+        return -1;
+      }
       return RuntimeStringCompare(heap, lhs, rhs);
     case Heap::kTagFunction:
     case Heap::kTagObject:
@@ -406,9 +455,9 @@ intptr_t RuntimeStringCompare(Heap* heap, char* lhs, char* rhs) {
 
   return lhs_length < rhs_length ? -1 :
          lhs_length > rhs_length ? 1 :
-         strncmp(HString::Value(heap, lhs),
-                 HString::Value(heap, rhs),
-                 lhs_length);
+         StringOps::Compare(HString::Value(heap, lhs),
+                            HString::Value(heap, rhs),
+                            lhs_length);
 }
 
 
@@ -781,8 +830,9 @@ char* RuntimeStackTrace(Heap* heap, char** frame, char* ip) {
   char* off_sym  = HString::New(heap, Heap::kTenureNew, "offset", 6);
 
   uint32_t index = 0;
+  bool skip = false;
   while ((info = heap->source_map()->Get(ip)) != NULL) {
-    if (ip != NULL) {
+    if (ip != NULL && !skip) {
       char** slot;
 
       // Create object with info
@@ -817,6 +867,11 @@ char* RuntimeStackTrace(Heap* heap, char** frame, char* ip) {
     // Traverse stack
     if (frame == NULL) break;
 
+    // Baseline frame that has entered optimized code in the loop belongs to
+    // the same function, don't put it into the trace
+    skip = static_cast<uint32_t>(reinterpret_cast<intptr_t>(*(frame + 2))) ==
+           Heap::kOSRFrameTag;
+
     // Get return address and previous frame
     ip = *(frame + 1);
     frame = reinterpret_cast<char**>(*frame);
@@ -34,6 +34,9 @@
 namespace candor {
 namespace internal {
 
+// Forward declarations
+class CodeProfile;
+
 // Wrapper for heap()->new_space()->Allocate()
 typedef char* (*RuntimeAllocateCallback)(Heap* heap,
                                          uint32_t bytes);
@@ -42,6 +45,33 @@ char* RuntimeAllocate(Heap* heap, uint32_t bytes);
 typedef void (*RuntimeCollectGarbageCallback)(Heap* heap, char* stack_top);
 void RuntimeCollectGarbage(Heap* heap, char* stack_top);
 
+// Recompiles function with the optimizing compiler
+typedef void (*RuntimeTierUpCallback)(Heap* heap,
+                                      CodeProfile* profile,
+                                      char* root);
+void RuntimeTierUp(Heap* heap, CodeProfile* profile, char* root);
+
+// Compiles function that is called for the first time
+typedef void (*RuntimeCompileLazyCallback)(Heap* heap,
+                                           CodeProfile* profile,
+                                           char* root);
+void RuntimeCompileLazy(Heap* heap, CodeProfile* profile, char* root);
+
+// Compiles function's code entered in the hot loop of the running baseline
+// code (on-stack replacement), returns NULL if it can't be compiled
+typedef char* (*RuntimeOSRCallback)(Heap* heap,
+                                    CodeProfile* profile,
+                                    intptr_t loop,
+                                    char* root);
+char* RuntimeOSR(Heap* heap, CodeProfile* profile, intptr_t loop, char* root);
+
+// Returns function to the baseline code after failed speculation in its
+// optimized code with (tagged) `version`
+typedef void (*RuntimeDeoptimizeCallback)(Heap* heap,
+                                          CodeProfile* profile,
+                                          intptr_t version);
+void RuntimeDeoptimize(Heap* heap, CodeProfile* profile, intptr_t version);
+
 typedef intptr_t (*RuntimeGetHashCallback)(Heap* heap, char* value);
 intptr_t RuntimeGetHash(Heap* heap, char* value);
 
@@ -61,5 +61,17 @@ SourceInfo* SourceMap::Get(char* addr) {
   return SourceMapBase::Find(NumberKey::New(addr_o));
 }
 
+
+void SourceMap::Remove(char* start, char* end) {
+  intptr_t start_o = reinterpret_cast<intptr_t>(start);
+  intptr_t end_o = reinterpret_cast<intptr_t>(end);
+
+  SourceMapBase::Item* item;
+  while ((item = FindFloor(NumberKey::New(end_o - 1))) != NULL &&
+         item->key->value() >= start_o) {
+    SourceMapBase::Remove(item->key);
+  }
+}
+
 }  // namespace internal
 }  // namespace candor
@@ -50,6 +50,9 @@ class SourceMap : SourceMapBase {
               char* addr);
   SourceInfo* Get(char* addr);
 
+  // Removes entries of the code in [start, end) range, that is being freed
+  void Remove(char* start, char* end);
+
   inline SourceQueue* queue() { return &queue_; }
 
  private:
@@ -97,6 +97,48 @@ class SplayTree {
     return NULL;
   }
 
+  // Returns item with the greatest key that is less than or equal to the
+  // given one, or NULL if there is no such item
+  inline Item* FindFloor(Key* key) {
+    Item* place = BinarySearch(key, false);
+    if (place == NULL || Key::Compare(place->key, key) > 0) return NULL;
+
+    Splay(place);
+    return place;
+  }
+
+  inline bool Remove(Key* key) {
+    Item* place = BinarySearch(key, false);
+    if (place == NULL || Key::Compare(place->key, key) != 0) return false;
+
+    Splay(place);
+    assert(place == root_);
+
+    Item* left = place->left;
+    Item* right = place->right;
+    if (left == NULL) {
+      root_ = right;
+      if (right != NULL) right->parent = NULL;
+    } else {
+      // Greatest item of the left subtree becomes a new root
+      left->parent = NULL;
+      root_ = left;
+
+      Item* max = left;
+      while (max->right != NULL) max = max->right;
+      Splay(max);
+      assert(max->right == NULL);
+
+      max->right = right;
+      if (right != NULL) right->parent = max;
+    }
+
+    Policy::Delete(place->value);
+    delete place;
+
+    return true;
+  }
+
  private:
   inline Item* BinarySearch(Key* key, bool insert) {
     // Fast case - empty tree
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "string-ops.h"
+
+#include <stdint.h>  // uint32_t
+#include <stdlib.h>  // NULL
+#include <string.h>  // memcmp
+
+#include "cpu.h"  // CPU
+
+#if CANDOR_ARCH_x64
+#include <emmintrin.h>  // SSE2
+#if defined(__GNUC__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#include <immintrin.h>  // AVX2
+#define CANDOR_AVX2_TARGET __attribute__((target("avx2")))
+#endif  // __GNUC__ >= 4.9
+#endif  // CANDOR_ARCH_x64
+
+namespace candor {
+namespace internal {
+
+StringOps::IndexOfCallback StringOps::index_of_ = NULL;
+
+
+static int64_t ScalarIndexOf(const char* haystack,
+                             uint32_t haystack_length,
+                             const char* needle,
+                             uint32_t needle_length) {
+  if (needle_length == 0) return 0;
+  if (needle_length > haystack_length) return -1;
+
+  uint32_t end = haystack_length - needle_length;
+  for (uint32_t i = 0; i <= end; i++) {
+    if (haystack[i] == needle[0] &&
+        memcmp(haystack + i, needle, needle_length) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+
+#if CANDOR_ARCH_x64
+
+static int64_t SSE2IndexOf(const char* haystack,
+                           uint32_t haystack_length,
+                           const char* needle,
+                           uint32_t needle_length) {
+  if (needle_length < 2 || needle_length > haystack_length) {
+    return ScalarIndexOf(haystack, haystack_length, needle, needle_length);
+  }
+
+  // Match first and last needle bytes at 16 positions at once and compare
+  // the rest only for candidates
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+  uint32_t end = haystack_length - needle_length + 1;
+
+  uint32_t i = 0;
+  for (; i + 16 <= end; i += 16) {
+    const char* pos = haystack + i;
+    __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    __m128i l = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(pos + needle_length - 1));
+    uint32_t mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(f, first), _mm_cmpeq_epi8(l, last)));
+
+    while (mask != 0) {
+      uint32_t bit = __builtin_ctz(mask);
+      if (memcmp(pos + bit + 1, needle + 1, needle_length - 2) == 0) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  int64_t r = ScalarIndexOf(haystack + i,
+                            haystack_length - i,
+                            needle,
+                            needle_length);
+  return r == -1 ? -1 : i + r;
+}
+
+
+#ifdef CANDOR_AVX2_TARGET
+
+CANDOR_AVX2_TARGET
+static int64_t AVX2IndexOf(const char* haystack,
+                           uint32_t haystack_length,
+                           const char* needle,
+                           uint32_t needle_length) {
+  if (needle_length < 2 || needle_length > haystack_length) {
+    return ScalarIndexOf(haystack, haystack_length, needle, needle_length);
+  }
+
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+  uint32_t end = haystack_length - needle_length + 1;
+
+  uint32_t i = 0;
+  for (; i + 32 <= end; i += 32) {
+    const char* pos = haystack + i;
+    __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+    __m256i l = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(pos + needle_length - 1));
+    uint32_t mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(f, first),
+                         _mm256_cmpeq_epi8(l, last)));
+
+    while (mask != 0) {
+      uint32_t bit = __builtin_ctz(mask);
+      if (memcmp(pos + bit + 1, needle + 1, needle_length - 2) == 0) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  int64_t r = SSE2IndexOf(haystack + i,
+                          haystack_length - i,
+                          needle,
+                          needle_length);
+  return r == -1 ? -1 : i + r;
+}
+
+#endif  // CANDOR_AVX2_TARGET
+
+#endif  // CANDOR_ARCH_x64
+
+
+void StringOps::Init() {
+#if CANDOR_ARCH_x64
+  // SSE2 is a part of x64
+  index_of_ = SSE2IndexOf;
+
+#ifdef CANDOR_AVX2_TARGET
+  if (CPU::HasAVX2()) {
+    index_of_ = AVX2IndexOf;
+  }
+#endif  // CANDOR_AVX2_TARGET
+#else
+  InitScalar();
+#endif  // CANDOR_ARCH_x64
+}
+
+
+void StringOps::InitScalar() {
+  index_of_ = ScalarIndexOf;
+}
+
+}  // namespace internal
+}  // namespace candor
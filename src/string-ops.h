@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2012, Fedor Indutny.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SRC_STRING_OPS_H_
+#define _SRC_STRING_OPS_H_
+
+#include <stdint.h>  // uint32_t
+#include <stdlib.h>  // NULL
+#include <string.h>  // memcmp
+
+namespace candor {
+namespace internal {
+
+// Byte string primitives used by runtime, vectorized when CPU allows it
+class StringOps {
+ public:
+  typedef int64_t (*IndexOfCallback)(const char* haystack,
+                                     uint32_t haystack_length,
+                                     const char* needle,
+                                     uint32_t needle_length);
+
+  // NOTE: libc's memcmp is already vectorized and dispatched at runtime,
+  // unlike strncmp it doesn't stop at '\0'
+  static inline int Compare(const char* lhs,
+                            const char* rhs,
+                            uint32_t length) {
+    return memcmp(lhs, rhs, length);
+  }
+
+  // Returns offset of the first needle occurence or -1
+  static inline int64_t IndexOf(const char* haystack,
+                                uint32_t haystack_length,
+                                const char* needle,
+                                uint32_t needle_length) {
+    if (index_of_ == NULL) Init();
+    return index_of_(haystack, haystack_length, needle, needle_length);
+  }
+
+  // Select implementation using CPU features
+  static void Init();
+
+  // Force scalar implementation (for tests and benchmarks)
+  static void InitScalar();
+
+ protected:
+  static IndexOfCallback index_of_;
+};
+
+}  // namespace internal
+}  // namespace candor
+
+#endif  // _SRC_STRING_OPS_H_
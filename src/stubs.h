@@ -42,7 +42,10 @@ namespace internal {
     V(AllocateFunction)\
     V(CallBinding)\
     V(CollectGarbage)\
-    V(Throw)\
+    V(TierUp)\
+    V(CompileLazy)\
+    V(Deoptimize)\
+    V(OSR)\
     V(Typeof)\
     V(Sizeof)\
     V(Keysof)\
@@ -151,7 +154,7 @@ BINARY_STUBS_LIST(BINARY_STUB_CLASS_DECL)
         V##Stub stub(space());\
         stub.Generate();\
         CodeChunk* chunk = space()->CreateChunk("__" #V "__stub__", "", 0); \
-        space()->Put(chunk, stub.masm()); \
+        space()->PutStub(chunk, stub.masm()); \
         stub_##V##_ = chunk->addr(); \
       }\
       return stub_##V##_;\
@@ -159,6 +162,11 @@ BINARY_STUBS_LIST(BINARY_STUB_CLASS_DECL)
 
 #define BINARY_STUB_LAZY_ALLOCATOR(V) STUB_LAZY_ALLOCATOR(Binary##V)
 
+#define STUB_GET_CASE(V) case BaseStub::k##V: return Get##V##Stub();
+#define BINARY_STUB_GET_CASE(V) STUB_GET_CASE(Binary##V)
+#define STUB_TYPE_OF(V) if (addr == stub_##V##_) return BaseStub::k##V;
+#define BINARY_STUB_TYPE_OF(V) STUB_TYPE_OF(Binary##V)
+
 #define STUB_PROPERTY(V) char* stub_##V##_;
 #define STUB_PROPERTY_INIT(V) stub_##V##_ = NULL;
 #define BINARY_STUB_PROPERTY(V) char* stub_Binary##V##_;
@@ -175,6 +183,23 @@ class Stubs {
 
   STUBS_LIST(STUB_LAZY_ALLOCATOR)
   BINARY_STUBS_LIST(BINARY_STUB_LAZY_ALLOCATOR)
+
+  // Lookups for the code cache, that stores types of called stubs instead
+  // of their addresses
+  char* Get(BaseStub::StubType type) {
+    switch (type) {
+      STUBS_LIST(STUB_GET_CASE)
+      BINARY_STUBS_LIST(BINARY_STUB_GET_CASE)
+      default: return NULL;
+    }
+  }
+
+  BaseStub::StubType TypeOf(char* addr) {
+    STUBS_LIST(STUB_TYPE_OF)
+    BINARY_STUBS_LIST(BINARY_STUB_TYPE_OF)
+    return BaseStub::kNone;
+  }
+
  protected:
   CodeSpace* space_;
 
@@ -184,6 +209,10 @@ class Stubs {
 
 #undef BINARY_STUB_LAZY_ALLOCATOR
 #undef STUB_LAZY_ALLOCATOR
+#undef BINARY_STUB_TYPE_OF
+#undef STUB_TYPE_OF
+#undef BINARY_STUB_GET_CASE
+#undef STUB_GET_CASE
 #undef BINARY_STUB_PROPERTY_INIT
 #undef BINARY_STUB_PROPERTY
 #undef STUB_PROPERTY_INIT
@@ -92,6 +92,18 @@ inline uint32_t PowerOfTwo(uint32_t value) {
 }
 
 
+template <class T>
+inline T Min(T a, T b) {
+  return a < b ? a : b;
+}
+
+
+template <class T>
+inline T Max(T a, T b) {
+  return a > b ? a : b;
+}
+
+
 class EmptyClass { };
 
 template <class T, class ItemParent>
@@ -364,7 +376,26 @@ class StringKey : public Base {
 };
 
 
-template <class Key, class Value, class ItemParent, class Policy>
+// Allocation policy for BitField's and GenericHashMap's storage
+// (see also ZonePolicy)
+class HeapPolicy {
+ public:
+  static inline void* Allocate(size_t size) {
+    void* res = malloc(size);
+    if (res == NULL) abort();
+    return res;
+  }
+
+  static inline void Free(void* ptr) {
+    free(ptr);
+  }
+};
+
+template <class Key,
+          class Value,
+          class ItemParent,
+          class Policy,
+          class Allocator = HeapPolicy>
 class GenericHashMap {
  public:
   typedef void (*EnumerateCallback)(void* map, Value* value);
@@ -399,8 +430,13 @@ class GenericHashMap {
     friend class GenericHashMap;
   };
 
-  GenericHashMap() : head_(NULL), current_(NULL) {
-    memset(&map_, 0, sizeof(map_));
+  GenericHashMap() : map_(NULL),
+                     size_(0),
+                     mask_(0),
+                     count_(0),
+                     head_(NULL),
+                     current_(NULL) {
+    Rehash(kInitialSize);
   }
 
   ~GenericHashMap() {
@@ -415,6 +451,9 @@ class GenericHashMap {
       delete prev;
       Policy::Delete(value);
     }
+
+    Allocator::Free(map_);
+    map_ = NULL;
   }
 
   inline void Set(Key* key, Value* value) {
@@ -454,6 +493,9 @@ class GenericHashMap {
       next->prev_scalar_ = current_;
     }
     current_ = next;
+
+    // Keep chains short
+    if (++count_ > size_) Rehash(size_ << 1);
   }
 
   inline Value* Get(Key* key) {
@@ -500,6 +542,7 @@ class GenericHashMap {
         // Remove any allocated data
         Policy::Delete(i->value());
         delete i;
+        count_--;
 
         return;
       }
@@ -519,9 +562,29 @@ class GenericHashMap {
   inline Item* head() { return head_; }
 
  private:
-  static const uint32_t size_ = 32;
-  static const uint32_t mask_ = 31;
-  Item* map_[size_];
+  inline void Rehash(uint32_t size) {
+    Allocator::Free(map_);
+    map_ = reinterpret_cast<Item**>(Allocator::Allocate(sizeof(*map_) * size));
+    memset(map_, 0, sizeof(*map_) * size);
+    size_ = size;
+    mask_ = size - 1;
+
+    // Put items back in the order of insertion (first one is found first)
+    for (Item* i = current_; i != NULL; i = i->prev_scalar()) {
+      Item** bucket = &map_[Key::Hash(i->key_) & mask_];
+      i->prev_ = NULL;
+      i->next_ = *bucket;
+      if (*bucket != NULL) (*bucket)->prev_ = i;
+      *bucket = i;
+    }
+  }
+
+  static const uint32_t kInitialSize = 32;
+
+  Item** map_;
+  uint32_t size_;
+  uint32_t mask_;
+  uint32_t count_;
   Item* head_;
   Item* current_;
 };
@@ -535,8 +598,14 @@ class HashMap : public GenericHashMap<Key,
  public:
 };
 
+class ZonePolicy;
+
 template <class Key, class Value, class ItemParent>
-class ZoneMap : public GenericHashMap<Key, Value, ItemParent, NopPolicy> {
+class ZoneMap : public GenericHashMap<Key,
+                                      Value,
+                                      ItemParent,
+                                      NopPolicy,
+                                      ZonePolicy> {
  public:
 };
 
@@ -569,16 +638,16 @@ class NumberKey {
   }
 };
 
-template <class Base>
+template <class Base, class Allocator = HeapPolicy>
 class BitField : public Base {
  public:
   explicit BitField(int size) : size_(size / 32) {
-    space_ = new uint32_t[size_];
+    space_ = NewSpace(size_);
     memset(space_, 0, sizeof(*space_) * size_);
   }
 
   ~BitField() {
-    delete[] space_;
+    Allocator::Free(space_);
     space_ = NULL;
   }
 
@@ -589,11 +658,7 @@ class BitField : public Base {
     Grow((key / 32) + 1);
 
     int index = key / 32;
-    int pos = key % 32;
-    uint32_t mask = 1;
-    while (pos-- > 0) {
-      mask <<= 1;
-    }
+    uint32_t mask = static_cast<uint32_t>(1) << (key % 32);
 
     assert(size_ > index);
     space_[index] |= mask;
@@ -604,13 +669,13 @@ class BitField : public Base {
 
     // Create new space
     int new_size = RoundUp(size, 16);
-    uint32_t* new_space = new uint32_t[new_size];
+    uint32_t* new_space = NewSpace(new_size);
 
     // Copy old data in
     memcpy(new_space, space_, size_ * sizeof(*new_space));
     memset(new_space + size_, 0, sizeof(*new_space) * (new_size - size_));
 
-    delete[] space_;
+    Allocator::Free(space_);
     space_ = new_space;
     size_ = new_size;
   }
@@ -619,17 +684,43 @@ class BitField : public Base {
     if ((key / 32) >= size_) return false;
 
     int index = key / 32;
-    int pos = key % 32;
-    uint32_t mask = 1;
-    while (pos-- > 0) {
-      mask <<= 1;
-    }
+    uint32_t mask = static_cast<uint32_t>(1) << (key % 32);
 
     assert(index < size_);
     return (space_[index] & mask) != 0;
   }
 
-  inline bool Copy(BitField<Base>* to) {
+  // Returns first set key that is greater or equal to `key`, or -1
+  inline int Next(int key) {
+    assert(key >= 0);
+    int index = key / 32;
+    if (index >= size_) return -1;
+
+    // Skip bits before `key` in the first word
+    uint32_t word = space_[index] & (~static_cast<uint32_t>(0) << (key % 32));
+    while (word == 0) {
+      if (++index >= size_) return -1;
+      word = space_[index];
+    }
+
+    int pos = 0;
+    while ((word & 1) == 0) {
+      word >>= 1;
+      pos++;
+    }
+
+    return index * 32 + pos;
+  }
+
+  inline bool IsEmpty() {
+    return Next(0) == -1;
+  }
+
+  inline int byte_size() {
+    return size_ * sizeof(*space_);
+  }
+
+  inline bool Copy(BitField<Base, Allocator>* to) {
     bool change = false;
     to->Grow(size_);
     assert(to->size_ >= size_);
@@ -651,7 +742,34 @@ class BitField : public Base {
     return change;
   }
 
+  // Same as Copy(), but keys that are set in `except` are not copied
+  inline bool CopyExcept(BitField<Base, Allocator>* to,
+                         BitField<Base, Allocator>* except) {
+    bool change = false;
+    to->Grow(size_);
+    assert(to->size_ >= size_);
+
+    for (int i = 0; i < size_; i++) {
+      uint32_t word = space_[i];
+      if (i < except->size_) word &= ~except->space_[i];
+
+      if ((to->space_[i] & word) != word) {
+        to->space_[i] |= word;
+        change = true;
+      }
+    }
+
+    return change;
+  }
+
  protected:
+  static inline uint32_t* NewSpace(int size) {
+    // Avoid zero-sized allocations, and keep zone allocations aligned
+    int words = RoundUp(size == 0 ? 1 : size, 2);
+    return reinterpret_cast<uint32_t*>(
+        Allocator::Allocate(sizeof(uint32_t) * words));
+  }
+
   int size_;
   uint32_t* space_;
 };
@@ -89,13 +89,7 @@ inline void Assembler::emit_modrm(Register dst) {
 
 inline void Assembler::emit_modrm(const Operand &dst) {
   if (dst.scale() == Operand::one) {
-    if (dst.byte_disp()) {
-      emitb(0x40 | dst.base().low());
-      emitb(dst.disp());
-    } else {
-      emitb(0x80 | dst.base().low());
-      emitl(dst.disp());
-    }
+    emit_modrm(dst, 0);
   } else {
     // TODO(indutny): Support scales
   }
@@ -109,13 +103,7 @@ inline void Assembler::emit_modrm(Register dst, Register src) {
 
 inline void Assembler::emit_modrm(Register dst, const Operand& src) {
   if (src.scale() == Operand::one) {
-    if (src.byte_disp()) {
-      emitb(0x40 | dst.low() << 3 | src.base().low());
-      emitb(src.disp());
-    } else {
-      emitb(0x80 | dst.low() << 3 | src.base().low());
-      emitl(src.disp());
-    }
+    emit_modrm(src, dst.low());
   } else {
   }
 }
@@ -129,9 +117,16 @@ inline void Assembler::emit_modrm(Register dst, uint32_t op) {
 inline void Assembler::emit_modrm(const Operand& dst, uint32_t op) {
   if (dst.byte_disp()) {
     emitb(0x40 | op << 3 | dst.base().low());
-    emitb(dst.disp());
   } else {
     emitb(0x80 | op << 3 | dst.base().low());
+  }
+
+  // rsp and r12 can't be encoded as a base without SIB byte
+  if (dst.base().low() == 4) emitb(0x24);
+
+  if (dst.byte_disp()) {
+    emitb(dst.disp());
+  } else {
     emitl(dst.disp());
   }
 }
@@ -153,24 +148,12 @@ inline void Assembler::emit_modrm(DoubleRegister dst, DoubleRegister src) {
 
 
 inline void Assembler::emit_modrm(DoubleRegister dst, const Operand& src) {
-  if (src.byte_disp()) {
-    emitb(0x40 | dst.low() << 3 | src.base().low());
-    emitb(src.disp());
-  } else {
-    emitb(0x80 | dst.low() << 3 | src.base().low());
-    emitl(src.disp());
-  }
+  emit_modrm(src, dst.low());
 }
 
 
 inline void Assembler::emit_modrm(const Operand& dst, DoubleRegister src) {
-  if (dst.byte_disp()) {
-    emitb(0x40 | dst.base().low() | src.low() << 3);
-    emitb(dst.disp());
-  } else {
-    emitb(0x80 | dst.base().low() | src.low() << 3);
-    emitl(dst.disp());
-  }
+  emit_modrm(dst, src.low());
 }
 
 
@@ -111,6 +111,13 @@ void Assembler::cpuid() {
 }
 
 
+void Assembler::xgetbv() {
+  emitb(0x0F);
+  emitb(0x01);
+  emitb(0xD0);
+}
+
+
 void Assembler::push(Register src) {
   emit_rex_if_high(src);
   emitb(0x50 | src.low());
@@ -173,6 +180,12 @@ void Assembler::cmpq(Register dst, const Operand& src) {
 
 
 void Assembler::cmpq(Register dst, const Immediate src) {
+  // Same flags, shorter encoding
+  if (src.is8()) {
+    cmpqb(dst, src);
+    return;
+  }
+
   emit_rexw(rax, dst);
   emitb(0x81);
   emit_modrm(dst, 7);
@@ -189,6 +202,14 @@ void Assembler::cmpqb(Register dst, const Immediate src) {
 
 
 void Assembler::cmpq(const Operand& dst, const Immediate src) {
+  if (src.is8()) {
+    emit_rexw(rax, dst);
+    emitb(0x83);
+    emit_modrm(dst, 7);
+    emitb(src.value());
+    return;
+  }
+
   emit_rexw(rax, dst);
   emitb(0x81);
   emit_modrm(dst, 7);
@@ -227,6 +248,14 @@ void Assembler::testb(Register dst, const Immediate src) {
 }
 
 
+void Assembler::testb(const Operand& dst, const Immediate src) {
+  emit_rexw(rax, dst);
+  emitb(0xF6);
+  emit_modrm(dst, 0);
+  emitb(src.value());
+}
+
+
 void Assembler::testl(Register dst, const Immediate src) {
   emit_rexw(rax, dst);
   emitb(0xF7);
@@ -266,6 +295,13 @@ void Assembler::jmp(Condition cond, Label* label) {
 }
 
 
+void Assembler::jmp(Register dst) {
+  emit_rexw(rax, dst);
+  emitb(0xFF);
+  emit_modrm(dst, 0x04);
+}
+
+
 void Assembler::mov(Register dst, Register src) {
   emit_rexw(dst, src);
   emitb(0x8B);
@@ -319,9 +355,9 @@ void Assembler::movl(const Operand& dst, const Immediate src) {
 
 
 void Assembler::movl(Register dst, const Immediate src) {
-  emit_rexw(dst);
-  emitb(0xC7);
-  emit_modrm(dst, 0);
+  // Upper half of the register is zeroed
+  emit_rex_if_high(dst);
+  emitb(0xB8 | dst.low());
   emitl(src.value());
 }
 
@@ -430,6 +466,14 @@ void Assembler::imulq(Register src) {
 }
 
 
+void Assembler::imulq(Register dst, Register src) {
+  emit_rexw(dst, src);
+  emitb(0x0F);
+  emitb(0xAF);
+  emit_modrm(dst, src);
+}
+
+
 void Assembler::idivq(Register src) {
   emit_rexw(rax, src);
   emitb(0xF7);
@@ -459,6 +503,14 @@ void Assembler::orqb(Register dst, const Immediate src) {
 }
 
 
+void Assembler::orb(const Operand& dst, const Immediate src) {
+  emit_rexw(rax, dst);
+  emitb(0x80);
+  emit_modrm(dst, 0x01);
+  emitb(src.value());
+}
+
+
 void Assembler::xorq(Register dst, Register src) {
   emit_rexw(dst, src);
   emitb(0x33);
@@ -486,6 +538,13 @@ void Assembler::dec(Register dst) {
 }
 
 
+void Assembler::dec(const Operand& dst) {
+  emit_rexw(rax, dst);
+  emitb(0xFF);
+  emit_modrm(dst, 0x01);
+}
+
+
 void Assembler::shl(Register dst, const Immediate src) {
   emit_rexw(rax, dst);
   emitb(0xC1);
@@ -613,6 +672,14 @@ void Assembler::movd(const Operand& dst, DoubleRegister src) {
 }
 
 
+void Assembler::movqd(DoubleRegister dst, DoubleRegister src) {
+  emitb(0xF2);
+  emitb(0x0F);
+  emitb(0x10);
+  emit_modrm(dst, src);
+}
+
+
 void Assembler::addqd(DoubleRegister dst, DoubleRegister src) {
   emitb(0xF2);
   emitb(0x0F);
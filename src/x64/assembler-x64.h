@@ -192,6 +192,17 @@ const DoubleRegister xmm15 = { 15 };
 
 const DoubleRegister fscratch = xmm11;
 
+static inline DoubleRegister DoubleRegisterByIndex(int index) {
+  // xmm1, xmm2 are used by stubs
+  switch (index) {
+    case 0: return xmm3;
+    case 1: return xmm4;
+    case 2: return xmm5;
+    case 3: return xmm6;
+    default: UNEXPECTED return xmm3;
+  }
+}
+
 class Immediate : public ZoneObject {
  public:
   explicit Immediate(uint64_t value) : value_(value) {
@@ -199,6 +210,10 @@ class Immediate : public ZoneObject {
 
   inline uint64_t value() const { return value_; }
   inline bool is64() const { return value_ > 0xffffffff; }
+  inline bool is8() const {
+    return static_cast<int64_t>(value_) >= -128 &&
+           static_cast<int64_t>(value_) <= 127;
+  }
 
  private:
   uint64_t value_;
@@ -229,7 +244,7 @@ class Operand : public ZoneObject {
   inline Scale scale() const { return scale_; }
   inline int32_t disp() const { return disp_; }
 
-  inline bool byte_disp() const { return disp() > -128 && disp() < 128; }
+  inline bool byte_disp() const { return disp() >= -128 && disp() <= 127; }
 
  private:
   Register base_;
@@ -323,6 +338,7 @@ class Assembler {
   // Instructions
   void nop();
   void cpuid();
+  void xgetbv();
 
   void push(Register src);
   void push(const Operand& src);
@@ -334,6 +350,7 @@ class Assembler {
   void bind(Label* label);
   void jmp(Label* label);
   void jmp(Condition cond, Label* label);
+  void jmp(Register dst);
 
   void cmpq(Register dst, Register src);
   void cmpq(Register dst, const Operand& src);
@@ -345,6 +362,7 @@ class Assembler {
   void cmpb(const Operand& dst, const Immediate src);
 
   void testb(Register dst, const Immediate src);
+  void testb(const Operand& dst, const Immediate src);
   void testl(Register dst, const Immediate src);
 
   void mov(Register dst, Register src);
@@ -370,16 +388,19 @@ class Assembler {
   void subq(Register dst, const Immediate src);
   void subqb(Register dst, const Immediate src);
   void imulq(Register src);
+  void imulq(Register dst, Register src);
   void idivq(Register src);
 
   void andq(Register dst, Register src);
   void orq(Register dst, Register src);
   void orqb(Register dst, const Immediate src);
+  void orb(const Operand& dst, const Immediate src);
   void xorq(Register dst, Register src);
   void xorl(Register dst, Register src);
 
   void inc(Register dst);
   void dec(Register dst);
+  void dec(const Operand& dst);
   void shl(Register dst, const Immediate src);
   void shr(Register dst, const Immediate src);
   void shll(Register dst, const Immediate src);
@@ -399,6 +420,7 @@ class Assembler {
   void movd(DoubleRegister dst, const Operand& src);
   void movd(Register dst, DoubleRegister src);
   void movd(const Operand& dst, DoubleRegister src);
+  void movqd(DoubleRegister dst, DoubleRegister src);
   void addqd(DoubleRegister dst, DoubleRegister src);
   void subqd(DoubleRegister dst, DoubleRegister src);
   void mulqd(DoubleRegister dst, DoubleRegister src);
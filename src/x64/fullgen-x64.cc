@@ -28,6 +28,7 @@
 #include "heap-inl.h"
 #include "macroassembler.h"
 #include "stubs.h"
+#include "code-space.h"  // CodeProfile
 
 namespace candor {
 namespace internal {
@@ -173,7 +174,7 @@ void FStoreProperty::Generate(Masm* masm) {
   // rax <- object
   // rbx <- propery
   // rcx <- value
-  __ mov(rcx, Immediate(1));
+  __ Move(rcx, Immediate(1));
   __ Call(masm->stubs()->GetLookupPropertyStub());
 
   // Make rax look like unboxed number to GC
@@ -202,7 +203,7 @@ void FLoadProperty::Generate(Masm* masm) {
 
   // rax <- object
   // rbx <- propery
-  __ mov(rcx, Immediate(0));
+  __ Move(rcx, Immediate(0));
   __ Call(masm->stubs()->GetLookupPropertyStub());
 
   __ IsNil(rax, NULL, &done);
@@ -327,6 +328,42 @@ void FNot::Generate(Masm* masm) {
 #define BINARY_SUB_ENUM(V)\
     case BinOp::k##V: stub = masm->stubs()->GetBinary##V##Stub(); break;
 
+// Remembers kinds of binop's operands in rax and rbx
+static void RecordFeedback(Masm* masm, TypeFeedback* feedback) {
+  Register regs[2] = { rax, rbx };
+  Operand kinds(scratch, TypeFeedback::kKindsOffset);
+  Label not_smi, any, done;
+
+  __ mov(scratch, rax);
+  __ orq(scratch, rbx);
+  __ IsUnboxed(scratch, &not_smi, NULL);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(feedback)));
+  __ RecordExternal(ExternalReference::kFeedback);
+  __ orb(kinds, Immediate(TypeFeedback::kSmi));
+  __ jmp(&done);
+
+  __ bind(&not_smi);
+  for (int i = 0; i < 2; i++) {
+    Label next;
+    __ IsUnboxed(regs[i], NULL, &next);
+    __ IsNil(regs[i], NULL, &any);
+    __ IsHeapObject(Heap::kTagNumber, regs[i], &any, NULL);
+    __ bind(&next);
+  }
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(feedback)));
+  __ RecordExternal(ExternalReference::kFeedback);
+  __ orb(kinds, Immediate(TypeFeedback::kNumber));
+  __ jmp(&done);
+
+  __ bind(&any);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(feedback)));
+  __ RecordExternal(ExternalReference::kFeedback);
+  __ orb(kinds, Immediate(TypeFeedback::kAny));
+
+  __ bind(&done);
+}
+
+
 void FBinOp::Generate(Masm* masm) {
   char* stub = NULL;
 
@@ -341,6 +378,7 @@ void FBinOp::Generate(Masm* masm) {
   // rbx <- rhs
   __ mov(rax, *inputs[0]->ToOperand());
   __ mov(rbx, *inputs[1]->ToOperand());
+  if (feedback_ != NULL) RecordFeedback(masm, feedback_);
   __ Call(stub);
   // result -> rax
   __ mov(*result->ToOperand(), rax);
@@ -406,10 +444,13 @@ void FStoreArg::Generate(Masm* masm) {
 
 
 void FStoreVarArg::Generate(Masm* masm) {
+  // rax <- value
+  // rdx <- offset
   __ mov(rax, *inputs[0]->ToOperand());
+  __ mov(rbx, *inputs[1]->ToOperand());
   __ mov(rdx, rsp);
-  __ shl(rax, Immediate(2));
-  __ addq(rdx, *inputs[1]->ToOperand());
+  __ shl(rbx, Immediate(2));
+  __ addq(rdx, rbx);
   __ Call(masm->stubs()->GetStoreVarArgStub());
 }
 
@@ -489,6 +530,12 @@ void FCall::Generate(Masm* masm) {
   __ IsNil(rbx, NULL, &not_function);
   __ IsHeapObject(Heap::kTagFunction, rbx, &not_function, NULL);
 
+  if (tail) {
+    Label call;
+    __ TailCallFunction(rbx, &call);
+    __ bind(&call);
+  }
+
   Masm::Spill ctx(masm, context_reg), root(masm, root_reg);
   Masm::Spill fn_s(masm, rbx);
 
@@ -498,7 +545,7 @@ void FCall::Generate(Masm* masm) {
   __ CallFunction(scratch);
 
   // Reset all registers to nil
-  __ mov(scratch, Immediate(Heap::kTagNil));
+  __ Move(scratch, Immediate(Heap::kTagNil));
   __ mov(rbx, scratch);
   __ mov(rcx, scratch);
   __ mov(rdx, scratch);
@@ -516,7 +563,7 @@ void FCall::Generate(Masm* masm) {
   __ jmp(&done);
   __ bind(&not_function);
 
-  __ mov(rax, Immediate(Heap::kTagNil));
+  __ Move(rax, Immediate(Heap::kTagNil));
 
   __ bind(&done);
   __ mov(*result->ToOperand(), rax);
@@ -544,5 +591,69 @@ void FGetStackTrace::Generate(Masm* masm) {
   __ mov(*result->ToOperand(), rax);
 }
 
+
+void FProfile::Generate(Masm* masm) {
+  Label entry, done;
+  Operand counter(scratch, CodeProfile::kCounterOffset);
+
+  // NOTE: CodeSpace::Optimize() replaces these two instructions in prologue
+  // with a jump to the optimized code
+  __ bind(&entry);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(profile_)));
+  __ RecordExternal(ExternalReference::kProfile);
+  __ dec(counter);
+
+  // Loops are only counting
+  if (!entry_) {
+    if (osr_loop_ == -1) return;
+
+    __ jmp(kGe, &done);
+
+    // Loop is hot, try entering optimized code at its head
+    __ push(Immediate(HNumber::Tag(osr_loop_)));
+    __ push(scratch);
+    __ Call(masm->stubs()->GetOSRStub());
+    __ cmpq(rax, Immediate(0));
+    __ jmp(kEq, &done);
+
+    // Optimized code runs the rest of the function using this frame's
+    // variables, return its result (the mark lets stack trace skip this frame)
+    __ push(Immediate(Heap::kOSRFrameTag));
+    __ push(Immediate(Heap::kOSRFrameTag));
+    __ Call(rax);
+    __ mov(rsp, rbp);
+    __ pop(rbp);
+    __ ret(0);
+
+    __ bind(&done);
+    return;
+  }
+
+  __ jmp(kGe, &done);
+
+  // Function is hot, try optimizing it and start again
+  // (either baseline or patched code will be executed)
+  __ push(scratch);
+  __ Call(masm->stubs()->GetTierUpStub());
+  __ jmp(&entry);
+
+  __ bind(&done);
+}
+
+void FCompileLazy::Generate(Masm* masm) {
+  Label entry;
+
+  // NOTE: CodeSpace::CompileLazy() replaces these instructions with a jump
+  // to the compiled code
+  __ bind(&entry);
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(profile_)));
+  __ RecordExternal(ExternalReference::kProfile);
+  __ push(scratch);
+  __ Call(masm->stubs()->GetCompileLazyStub());
+
+  // Function's code is in place now
+  __ jmp(&entry);
+}
+
 }  // namespace internal
 }  // namespace candor
@@ -41,7 +41,7 @@ void LGen::VisitNil(HIRInstruction* instr) {
 
 void LGen::VisitEntry(HIRInstruction* instr) {
   HIREntry* entry = HIREntry::Cast(instr);
-  Bind(new LEntry(entry->label(), entry->context_slots()));
+  Bind(new LEntry(entry->label(), entry->context_slots(), entry->osr()));
 }
 
 
@@ -96,14 +96,73 @@ void LGen::VisitNot(HIRInstruction* instr) {
 
 
 void LGen::VisitBinOp(HIRInstruction* instr) {
+  // Comparison is generated by the branch (see VisitIf)
+  if (IsSmiCompare(instr)) return;
+
+  if (IsSmiBinOp(instr)) {
+    Bind(new LBinOpSmi())
+        ->AddScratch(CreateVirtual())
+        ->AddArg(instr->left(), LUse::kRegister)
+        ->AddArg(instr->right(), LUse::kRegister)
+        ->SetResult(CreateVirtual(), LUse::kRegister);
+    return;
+  }
+
+  bool is_double = IsDoubleBinOp(instr);
+  if (is_double || IsDoubleSpeculation(instr)) {
+    LBinOpDouble* op = new LBinOpDouble();
+    if (!is_double) op->deopt_profile = hir_->profile();
+
+    HIRInstruction* args[2] = { instr->left(), instr->right() };
+    LInterval* fixed[2] = { NULL, NULL };
+    Register regs[2] = { rax, rbx };
+    bool has_call = false;
+
+    for (int i = 0; i < 2; i++) {
+      LInstruction* arg = args[i]->lir();
+
+      if (arg != NULL &&
+          arg->type() == LInstruction::kBinOpDouble &&
+          LBinOpDouble::Cast(arg)->IsUnboxed()) {
+        // Take unboxed value from double register
+        op->input_doubles[i] = LBinOpDouble::Cast(arg)->result_double;
+        ReleaseDouble(op->input_doubles[i]);
+      } else {
+        fixed[i] = ToFixed(args[i], regs[i]);
+        has_call = true;
+      }
+    }
+
+    op->live_doubles = live_doubles_;
+    if (CanKeepUnboxed(instr)) op->result_double = AllocateDouble();
+
+    Bind(op);
+    for (int i = 0; i < 2; i++) {
+      if (fixed[i] != NULL) op->AddArg(fixed[i], LUse::kRegister);
+    }
+
+    // Boxing and stub calls are the only calls here
+    if (!op->IsUnboxed()) {
+      op->MarkHasCall();
+      ResultFromFixed(op, rax);
+    } else if (has_call) {
+      op->MarkHasCall();
+    }
+    return;
+  }
+
   LInstruction* op;
   LInterval* lhs = ToFixed(instr->left(), rax);
   LInterval* rhs = ToFixed(instr->right(), rbx);
   HIRBinOp* hir = HIRBinOp::Cast(instr);
+  bool is_number = instr->right()->IsNumber() && instr->left()->IsNumber() &&
+      BinOp::is_math(hir->binop_type()) && hir->binop_type() != BinOp::kDiv;
 
-  if (instr->right()->IsNumber() && instr->left()->IsNumber() &&
-      BinOp::is_math(hir->binop_type()) && hir->binop_type() != BinOp::kDiv) {
-    op = Bind(new LBinOpNumber())
+  if (is_number || IsSmiSpeculation(instr)) {
+    LBinOpNumber* number = new LBinOpNumber();
+    if (!is_number) number->deopt_profile = hir_->profile();
+
+    op = Bind(number)
         ->MarkHasCall()
         ->AddScratch(CreateVirtual())
         ->AddArg(lhs, LUse::kRegister)
@@ -159,6 +218,13 @@ void LGen::VisitClone(HIRInstruction* instr) {
 }
 
 
+void LGen::VisitLoadOsr(HIRInstruction* instr) {
+  Bind(new LLoadOsr())
+      ->SetSlot(HIRLoadOsr::Cast(instr)->osr_slot())
+      ->SetResult(CreateVirtual(), LUse::kRegister);
+}
+
+
 void LGen::VisitLoadContext(HIRInstruction* instr) {
   Bind(new LLoadContext())
       ->SetSlot(HIRLoadContext::Cast(instr)->context_slot())
@@ -279,7 +345,7 @@ void LGen::VisitStoreVarArg(HIRInstruction* instr) {
 void LGen::VisitCall(HIRInstruction* instr) {
   LInterval* lhs = ToFixed(instr->left(), rbx);
   LInterval* rhs = ToFixed(instr->right(), rax);
-  LInstruction* op = Bind(new LCall())
+  LInstruction* op = Bind(new LCall(IsTailCall(instr)))
       ->MarkHasCall()
       ->AddArg(lhs, LUse::kRegister)
       ->AddArg(rhs, LUse::kRegister);
@@ -289,6 +355,13 @@ void LGen::VisitCall(HIRInstruction* instr) {
 
 
 void LGen::VisitIf(HIRInstruction* instr) {
+  if (IsSmiCompare(instr->left())) {
+    Bind(new LBranchSmi())
+        ->AddArg(instr->left()->left(), LUse::kRegister)
+        ->AddArg(instr->left()->right(), LUse::kRegister);
+    return;
+  }
+
   if (instr->left()->IsNumber()) {
     Bind(new LBranchNumber())
         ->AddArg(instr->left(), LUse::kRegister);
@@ -63,6 +63,16 @@ void LEntry::Generate(Masm* masm) {
 
   // Save argc
   Operand argc(rbp, -HValue::kPointerSize * 2);
+
+  // Baseline frame below has already initialized arguments and context
+  if (osr_) {
+    Operand baseline_argc(scratch, -HValue::kPointerSize * 2);
+    __ mov(scratch, Operand(rbp, 0));
+    __ mov(scratch, baseline_argc);
+    __ mov(argc, scratch);
+    return;
+  }
+
   __ mov(argc, rax);
 
   // Allocate context slots
@@ -180,13 +190,34 @@ void LBranchNumber::Generate(Masm* masm) {
 }
 
 
+void LBranchSmi::Generate(Masm* masm) {
+  // Tagging preserves order of SMIs
+  __ cmpq(inputs[0]->ToRegister(), inputs[1]->ToRegister());
+
+  // Jmp to `right` block if comparison is false
+  Condition cond;
+  switch (HIRBinOp::Cast(hir()->left())->binop_type()) {
+    case BinOp::kLt: cond = kGe; break;
+    case BinOp::kGt: cond = kLe; break;
+    case BinOp::kLe: cond = kGt; break;
+    case BinOp::kGe: cond = kLt; break;
+    case BinOp::kEq:
+    case BinOp::kStrictEq: cond = kNe; break;
+    case BinOp::kNe:
+    case BinOp::kStrictNe: cond = kEq; break;
+    default: UNEXPECTED
+  }
+  __ jmp(cond, TargetAt(1)->label);
+}
+
+
 void LLoadProperty::Generate(Masm* masm) {
   Label done;
   Masm::Spill rax_s(masm, rax);
 
   // rax <- object
   // rbx <- propery
-  __ mov(rcx, Immediate(0));
+  __ Move(rcx, Immediate(0));
   if (HasMonomorphicProperty()) {
     __ Call(masm->space()->CreatePIC());
   } else {
@@ -214,7 +245,7 @@ void LStoreProperty::Generate(Masm* masm) {
   // rax <- object
   // rbx <- propery
   // rcx <- value
-  __ mov(rcx, Immediate(1));
+  __ Move(rcx, Immediate(1));
   if (HasMonomorphicProperty()) {
     __ Call(masm->space()->CreatePIC());
   } else {
@@ -288,6 +319,32 @@ void LBinOp::Generate(Masm* masm) {
 }
 
 
+// Returns function to the baseline code once speculation has failed,
+// current frame continues on the generic path (see CodeSpace::Deoptimize)
+static void GenerateDeopt(Masm* masm, CodeProfile* profile) {
+  // Version of the code being generated and profile
+  __ push(Immediate(HNumber::Tag(profile->version())));
+  __ mov(scratch, Immediate(reinterpret_cast<intptr_t>(profile)));
+  __ push(scratch);
+  __ Call(masm->stubs()->GetDeoptimizeStub());
+}
+
+
+// Failed speculation is rare, deoptimization code is placed out of line
+class DeoptSlowPath : public Masm::SlowPath {
+ public:
+  explicit DeoptSlowPath(CodeProfile* profile) : profile_(profile) {
+  }
+
+  void Generate(Masm* masm) {
+    GenerateDeopt(masm, profile_);
+  }
+
+ private:
+  CodeProfile* profile_;
+};
+
+
 void LBinOpNumber::Generate(Masm* masm) {
   BinOp::BinOpType type = HIRBinOp::Cast(hir())->binop_type();
 
@@ -296,8 +353,16 @@ void LBinOpNumber::Generate(Masm* masm) {
   Register scratch = scratches[0]->ToRegister();
   Label stub_call, done;
 
-  __ IsUnboxed(left, &stub_call, NULL);
-  __ IsUnboxed(right, &stub_call, NULL);
+  // Non-SMI inputs invalidate speculation
+  DeoptSlowPath* deopt = NULL;
+  Label* not_smi = &stub_call;
+  if (deopt_profile != NULL) {
+    deopt = new DeoptSlowPath(deopt_profile);
+    not_smi = &deopt->entry;
+  }
+
+  __ IsUnboxed(left, not_smi, NULL);
+  __ IsUnboxed(right, not_smi, NULL);
 
   // Save left side in case of overflow
   __ mov(scratch, left);
@@ -322,6 +387,13 @@ void LBinOpNumber::Generate(Masm* masm) {
   // Restore left side
   __ mov(left, scratch);
 
+  // Overflow doesn't invalidate speculation, deoptimized code continues
+  // with the stub call too
+  if (deopt != NULL) {
+    __ Defer(deopt);
+    __ bind(&deopt->exit);
+  }
+
   __ bind(&stub_call);
 
   char* stub = NULL;
@@ -339,6 +411,136 @@ void LBinOpNumber::Generate(Masm* masm) {
   __ bind(&done);
 }
 
+
+
+void LBinOpSmi::Generate(Masm* masm) {
+  Register scratch = scratches[0]->ToRegister();
+
+  // Result may share register with any of inputs
+  __ mov(scratch, inputs[0]->ToRegister());
+  switch (HIRBinOp::Cast(hir())->binop_type()) {
+    case BinOp::kAdd:
+      __ addq(scratch, inputs[1]->ToRegister());
+      break;
+    case BinOp::kSub:
+      __ subq(scratch, inputs[1]->ToRegister());
+      break;
+    case BinOp::kMul:
+      __ Untag(scratch);
+      __ imulq(scratch, inputs[1]->ToRegister());
+      break;
+    default:
+      UNEXPECTED
+  }
+  __ mov(result->ToRegister(), scratch);
+}
+
+
+// Preserve unboxed values across calls
+static void SaveDoubles(Masm* masm, int mask) {
+  int count = 0;
+  for (int i = 0; i < kLIRDoubleRegisterCount; i++) {
+    if ((mask & (1 << i)) == 0) continue;
+
+    __ movd(scratch, DoubleRegisterByIndex(i));
+    __ push(scratch);
+    count++;
+  }
+
+  // Keep stack aligned
+  if (count % 2 != 0) __ push(scratch);
+}
+
+
+static void RestoreDoubles(Masm* masm, int mask) {
+  int count = 0;
+  for (int i = 0; i < kLIRDoubleRegisterCount; i++) {
+    if (mask & (1 << i)) count++;
+  }
+  if (count % 2 != 0) __ pop(scratch);
+
+  for (int i = kLIRDoubleRegisterCount - 1; i >= 0; i--) {
+    if ((mask & (1 << i)) == 0) continue;
+
+    __ pop(scratch);
+    __ movd(DoubleRegisterByIndex(i), scratch);
+  }
+}
+
+
+void LBinOpDouble::Generate(Masm* masm) {
+  BinOp::BinOpType type = HIRBinOp::Cast(hir())->binop_type();
+
+  Register regs[2] = { rax, rbx };
+  DoubleRegister values[2] = { xmm1, xmm2 };
+  bool has_boxed = false;
+  Label stub_call, done;
+
+  // lhs -> xmm1, rhs -> xmm2
+  for (int i = 0; i < 2; i++) {
+    if (input_doubles[i] == -1) {
+      __ UnboxNumber(regs[i], values[i], &stub_call);
+      has_boxed = true;
+    } else {
+      __ movqd(values[i], DoubleRegisterByIndex(input_doubles[i]));
+    }
+  }
+
+  switch (type) {
+    case BinOp::kAdd: __ addqd(xmm1, xmm2); break;
+    case BinOp::kSub: __ subqd(xmm1, xmm2); break;
+    case BinOp::kMul: __ mulqd(xmm1, xmm2); break;
+    case BinOp::kDiv: __ divqd(xmm1, xmm2); break;
+    default: UNEXPECTED
+  }
+
+  if (IsUnboxed()) {
+    // Keep result in register for the next instruction
+    __ movqd(DoubleRegisterByIndex(result_double), xmm1);
+  } else {
+    // Value escapes - box it
+    SaveDoubles(masm, live_doubles);
+    __ AllocateNumber(xmm1, rax);
+    RestoreDoubles(masm, live_doubles);
+  }
+
+  if (!has_boxed) return;
+
+  __ jmp(&done);
+  __ bind(&stub_call);
+
+  SaveDoubles(masm, live_doubles);
+
+  if (deopt_profile != NULL) GenerateDeopt(masm, deopt_profile);
+
+  // Box unboxed inputs
+  for (int i = 0; i < 2; i++) {
+    if (input_doubles[i] == -1) continue;
+    __ AllocateNumber(DoubleRegisterByIndex(input_doubles[i]), regs[i]);
+  }
+
+  char* stub = NULL;
+  switch (type) {
+    BINARY_SUB_TYPES(BINARY_SUB_ENUM)
+    default: UNEXPECTED
+  }
+  assert(stub != NULL);
+
+  // rax <- lhs
+  // rbx <- rhs
+  __ Call(stub);
+  // result -> rax
+
+  // Result of (-), (*), (/) or (+) on numbers is always a number
+  if (IsUnboxed()) {
+    __ UnboxNumber(rax, DoubleRegisterByIndex(result_double), NULL);
+  }
+
+  RestoreDoubles(masm, live_doubles);
+
+  __ bind(&done);
+}
+
 #undef BINARY_SUB_ENUM
 #undef BINARY_SUB_TYPES
 
@@ -378,6 +580,12 @@ void LCall::Generate(Masm* masm) {
   __ IsNil(rbx, NULL, &not_function);
   __ IsHeapObject(Heap::kTagFunction, rbx, &not_function, NULL);
 
+  if (tail_) {
+    Label call;
+    __ TailCallFunction(rbx, &call);
+    __ bind(&call);
+  }
+
   Masm::Spill ctx(masm, context_reg), root(masm, root_reg);
   Masm::Spill fn_s(masm, rbx);
 
@@ -387,7 +595,7 @@ void LCall::Generate(Masm* masm) {
   __ CallFunction(scratch);
 
   // Reset all registers to nil
-  __ mov(scratch, Immediate(Heap::kTagNil));
+  __ Move(scratch, Immediate(Heap::kTagNil));
   __ mov(rbx, scratch);
   __ mov(rcx, scratch);
   __ mov(rdx, scratch);
@@ -405,7 +613,7 @@ void LCall::Generate(Masm* masm) {
   __ jmp(&done);
   __ bind(&not_function);
 
-  __ mov(rax, Immediate(Heap::kTagNil));
+  __ Move(rax, Immediate(Heap::kTagNil));
 
   __ bind(&done);
 
@@ -484,6 +692,17 @@ void LAlignStack::Generate(Masm* masm) {
 }
 
 
+void LLoadOsr::Generate(Masm* masm) {
+  // Baseline frame is the caller's one (see FOperand::ToOperand())
+  Operand frame(rbp, 0);
+  Operand value(result->ToRegister(),
+                -HValue::kPointerSize * (slot()->index() + 3));
+
+  __ mov(result->ToRegister(), frame);
+  __ mov(result->ToRegister(), value);
+}
+
+
 void LLoadContext::Generate(Masm* masm) {
   int depth = slot()->depth();
 
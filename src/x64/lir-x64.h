@@ -31,6 +31,9 @@ namespace internal {
 
 const int kLIRRegisterCount = 10;
 
+// xmm3-xmm6, holding unboxed doubles
+const int kLIRDoubleRegisterCount = 4;
+
 }  // namespace internal
 }  // namespace candor
 
@@ -80,6 +80,8 @@ void Masm::Popad(Register preserve) {
 
 
 void Masm::AlignCode() {
+  EmitSlowPaths();
+
   offset_ = RoundUp(offset_, 16);
   Grow();
 }
@@ -176,6 +178,15 @@ void Masm::FinalizeSpills() {
 }
 
 
+void Masm::Move(Register dst, Immediate src) {
+  if (src.is64()) {
+    mov(dst, src);
+  } else {
+    movl(dst, src);
+  }
+}
+
+
 void Masm::Allocate(Heap::HeapTag tag,
                     Register size_reg,
                     uint32_t size,
@@ -187,7 +198,7 @@ void Masm::Allocate(Heap::HeapTag tag,
 
   // Add tag size
   if (size_reg.is(reg_nil)) {
-    mov(rax, Immediate(HNumber::Tag(size + HValue::kPointerSize)));
+    Move(rax, Immediate(HNumber::Tag(size + HValue::kPointerSize)));
   } else {
     mov(rax, size_reg);
     Untag(rax);
@@ -195,7 +206,7 @@ void Masm::Allocate(Heap::HeapTag tag,
     TagNumber(rax);
   }
   push(rax);
-  mov(rax, Immediate(HNumber::Tag(tag)));
+  Move(rax, Immediate(HNumber::Tag(tag)));
   push(rax);
 
   Call(stubs()->GetAllocateStub());
@@ -246,6 +257,32 @@ void Masm::AllocateNumber(DoubleRegister value, Register result) {
 }
 
 
+void Masm::UnboxNumber(Register number,
+                       DoubleRegister result,
+                       Label* not_number) {
+  Label heap_number, done;
+
+  IsUnboxed(number, &heap_number, NULL);
+
+  mov(scratch, number);
+  Untag(scratch);
+  xorqd(result, result);
+  cvtsi2sd(result, scratch);
+  jmp(&done);
+
+  bind(&heap_number);
+  if (not_number != NULL) {
+    IsNil(number, NULL, not_number);
+    IsHeapObject(Heap::kTagNumber, number, not_number, NULL);
+  }
+
+  Operand qvalue(number, HNumber::kValueOffset);
+  movd(result, qvalue);
+
+  bind(&done);
+}
+
+
 void Masm::AllocateObjectLiteral(Heap::HeapTag tag,
                                  Register tag_reg,
                                  Register size,
@@ -382,8 +419,10 @@ void Masm::EnterFramePrologue() {
 
   pushb(Immediate(Heap::kTagNil));
   mov(scratch, last_frame);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   mov(scratch, last_stack);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   push(Immediate(Heap::kEnterFrameTag));
 }
@@ -400,10 +439,12 @@ void Masm::ExitFramePrologue() {
   Operand scratch_op(scratch, 0);
 
   mov(scratch, last_frame);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   mov(scratch_op, rbp);
 
   mov(scratch, last_stack);
+  RecordExternal(ExternalReference::kHeapAddress);
   push(scratch_op);
   mov(scratch_op, rsp);
   xorq(scratch, scratch);
@@ -421,6 +462,7 @@ void Masm::ExitFrameEpilogue() {
   // NOTE: we can safely use rbx here, look at stubs-x64.cc
   mov(rbx, scratch);
   mov(scratch, last_stack);
+  RecordExternal(ExternalReference::kHeapAddress);
   mov(scratch_op, rbx);
 
   pop(scratch);
@@ -428,6 +470,7 @@ void Masm::ExitFrameEpilogue() {
   // Restore previous last_frame
   mov(rbx, scratch);
   mov(scratch, last_frame);
+  RecordExternal(ExternalReference::kHeapAddress);
   mov(scratch_op, rbx);
 }
 
@@ -542,20 +585,28 @@ void Masm::StringHash(Register str, Register result) {
 }
 
 
+class CollectGarbageSlowPath : public Masm::SlowPath {
+ public:
+  void Generate(Masm* masm) {
+    masm->Call(masm->stubs()->GetCollectGarbageStub());
+  }
+};
+
+
 void Masm::CheckGC() {
   Immediate gc_flag(reinterpret_cast<intptr_t>(heap()->needs_gc_addr()));
   Operand scratch_op(scratch, 0);
 
-  Label done;
+  CollectGarbageSlowPath* gc = new CollectGarbageSlowPath();
 
   // Check needs_gc flag
   mov(scratch, gc_flag);
+  RecordExternal(ExternalReference::kHeapAddress);
   cmpb(scratch_op, Immediate(0));
-  jmp(kEq, &done);
-
-  Call(stubs()->GetCollectGarbageStub());
+  jmp(kNe, &gc->entry);
+  Defer(gc);
 
-  bind(&done);
+  bind(&gc->exit);
 }
 
 
@@ -624,11 +675,18 @@ void Masm::Call(const Operand& addr) {
 
 void Masm::Call(char* stub) {
   mov(scratch, Immediate(reinterpret_cast<intptr_t>(stub)));
+  RecordExternal(ExternalReference::kStub);
 
   Call(scratch);
 }
 
 
+void Masm::Jump(char* code) {
+  mov(scratch, Immediate(reinterpret_cast<intptr_t>(code)));
+  jmp(scratch);
+}
+
+
 void Masm::CallFunction(Register fn) {
   Operand context_slot(fn, HFunction::kParentOffset);
   Operand code_slot(fn, HFunction::kCodeOffset);
@@ -655,6 +713,62 @@ void Masm::CallFunction(Register fn) {
 }
 
 
+void Masm::TailCallFunction(Register fn, Label* fallback) {
+  Operand context_slot(fn, HFunction::kParentOffset);
+  Operand code_slot(fn, HFunction::kCodeOffset);
+  Operand root_slot(fn, HFunction::kRootOffset);
+  Operand argc(rbp, -HValue::kPointerSize * 2);
+
+  // Bindings are called by stub
+  cmpq(context_slot, Immediate(Heap::kBindingContextTag));
+  jmp(kEq, fallback);
+
+  // rcx <- aligned new argc, rdx <- aligned current argc
+  Label even_argc, even_current, loop, copy;
+  mov(rcx, rax);
+  testb(rcx, Immediate(HNumber::Tag(1)));
+  jmp(kEq, &even_argc);
+  addqb(rcx, Immediate(HNumber::Tag(1)));
+  bind(&even_argc);
+
+  mov(rdx, argc);
+  testb(rdx, Immediate(HNumber::Tag(1)));
+  jmp(kEq, &even_current);
+  addqb(rdx, Immediate(HNumber::Tag(1)));
+  bind(&even_current);
+
+  cmpq(rcx, rdx);
+  jmp(kGt, fallback);
+
+  // Copy arguments, starting from the last one
+  Operand from(rdx, 0);
+  Operand to(rdx, HValue::kPointerSize * 2);
+  shl(rcx, Immediate(2));
+  jmp(&loop);
+
+  bind(&copy);
+  subqb(rcx, Immediate(HValue::kPointerSize));
+  mov(rdx, rsp);
+  addq(rdx, rcx);
+  mov(scratch, from);
+  mov(rdx, rbp);
+  addq(rdx, rcx);
+  mov(to, scratch);
+
+  bind(&loop);
+  cmpqb(rcx, Immediate(0));
+  jmp(kNe, &copy);
+
+  // Leave frame and enter function
+  mov(rsp, rbp);
+  pop(rbp);
+  mov(context_reg, context_slot);
+  mov(root_reg, root_slot);
+  mov(scratch, code_slot);
+  jmp(scratch);
+}
+
+
 void Masm::ProbeCPU() {
   push(rbp);
   mov(rbp, rsp);
@@ -663,9 +777,45 @@ void Masm::ProbeCPU() {
   push(rcx);
   push(rdx);
 
+  Label no_leaf7, no_ymm, done;
+
+  // r8 <- feature flags (ecx)
   mov(rax, Immediate(0x01));
   cpuid();
-  mov(rax, rcx);
+  mov(r8, rcx);
+
+  // r9 <- max leaf
+  xorq(rax, rax);
+  cpuid();
+  mov(r9, rax);
+
+  // r10 <- extended feature flags (ebx)
+  xorq(r10, r10);
+  cmpq(r9, Immediate(0x07));
+  jmp(kLt, &no_leaf7);
+  mov(rax, Immediate(0x07));
+  xorq(rcx, rcx);
+  cpuid();
+  mov(r10, rbx);
+  bind(&no_leaf7);
+
+  // AVX2 is usable only if OS saves YMM state (OSXSAVE and XCR0 bits 1-2)
+  testl(r8, Immediate(1 << 27));
+  jmp(kEq, &no_ymm);
+  xorq(rcx, rcx);
+  xgetbv();
+  mov(rcx, Immediate(0x06));
+  andq(rax, rcx);
+  cmpq(rax, rcx);
+  jmp(kEq, &done);
+  bind(&no_ymm);
+  xorq(r10, r10);
+  bind(&done);
+
+  // rax <- ebx(7) << 32 | ecx(1)
+  mov(rax, r10);
+  shl(rax, Immediate(32));
+  orq(rax, r8);
 
   pop(rdx);
   pop(rcx);
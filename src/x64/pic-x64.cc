@@ -21,6 +21,9 @@
  */
 
 #include "pic.h"
+
+#include <stddef.h>  // offsetof
+
 #include "code-space.h"  // CodeSpace
 #include "stubs.h"  // Stubs
 #include "macroassembler.h"  // Masm
@@ -46,27 +49,26 @@ void PIC::Generate(Masm* masm) {
   __ mov(rax_s, rax);
   __ mov(rbx_s, rbx);
 
-  if (size_ != 0) {
-    // Fast-case non-object
-    __ IsNil(rax, NULL, &miss);
-    __ IsUnboxed(rax, NULL, &miss);
-    __ IsHeapObject(Heap::kTagObject, rax, &miss, NULL);
+  // Fast-case non-object
+  __ IsNil(rax, NULL, &miss);
+  __ IsUnboxed(rax, NULL, &miss);
+  __ IsHeapObject(Heap::kTagObject, rax, &miss, NULL);
 
-    // Load proto
-    __ mov(rdx, proto_op);
-    __ cmpq(rdx, Immediate(Heap::kICDisabledValue));
-    __ jmp(kEq, &miss);
-  }
+  // Load proto
+  __ mov(rdx, proto_op);
+  __ cmpq(rdx, Immediate(Heap::kICDisabledValue));
+  __ jmp(kEq, &miss);
 
-  for (int i = size_ - 1; i >= 0; i--) {
+  // Compare it with every entry of the table, Miss() fills them in order
+  __ mov(rbx, Immediate(reinterpret_cast<intptr_t>(entries_)));
+  for (int i = 0; i < kMaxSize; i++) {
     Label local_miss;
+    Operand proto(rbx, i * sizeof(Entry) + offsetof(Entry, proto));
+    Operand result(rbx, i * sizeof(Entry) + offsetof(Entry, result));
 
-    __ mov(rbx, Immediate(reinterpret_cast<intptr_t>(protos_[i])));
-    proto_offsets_[i] = reinterpret_cast<char**>(static_cast<intptr_t>(
-          masm->offset() - 8));
-    __ cmpq(rdx, rbx);
+    __ cmpq(rdx, proto);
     __ jmp(kNe, &local_miss);
-    __ mov(rax, Immediate(results_[i]));
+    __ mov(rax, result);
     __ xorq(rbx, rbx);
     __ mov(rsp, rbp);
     __ pop(rbp);
@@ -77,10 +79,8 @@ void PIC::Generate(Masm* masm) {
   // Cache failed - call runtime
   __ bind(&miss);
 
-  if (size_ != 0) {
-    __ mov(rbx, rbx_s);
-    __ mov(rax, rax_s);
-  }
+  __ mov(rbx, rbx_s);
+  __ mov(rax, rax_s);
   __ Call(space_->stubs()->GetLookupPropertyStub());
 
   // Miss(this, object, result, ip)
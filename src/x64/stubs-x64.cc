@@ -360,6 +360,114 @@ void CollectGarbageStub::Generate() {
 }
 
 
+void TierUpStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeTierUpCallback tier_up = &RuntimeTierUp;
+  Operand profile(rbp, 16);
+
+  // Function's arguments should be preserved
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeTierUp(heap, profile, root)
+    __ mov(rdx, root_reg);
+    __ mov(rsi, profile);
+    __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(rax, Immediate(*reinterpret_cast<intptr_t*>(&tier_up)));
+    __ Call(rax);
+  }
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(1);
+}
+
+
+void CompileLazyStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeCompileLazyCallback compile = &RuntimeCompileLazy;
+  Operand profile(rbp, 16);
+
+  // Function's arguments should be preserved
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeCompileLazy(heap, profile, root)
+    __ mov(rdx, root_reg);
+    __ mov(rsi, profile);
+    __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(rax, Immediate(*reinterpret_cast<intptr_t*>(&compile)));
+    __ Call(rax);
+  }
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(1);
+}
+
+
+void DeoptimizeStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeDeoptimizeCallback deopt = &RuntimeDeoptimize;
+  Operand profile(rbp, 16);
+  Operand version(rbp, 24);
+
+  // Operands of the failed instruction should be preserved
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeDeoptimize(heap, profile, version)
+    __ mov(rdx, version);
+    __ mov(rsi, profile);
+    __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(rax, Immediate(*reinterpret_cast<intptr_t*>(&deopt)));
+    __ Call(rax);
+  }
+
+  __ Popad(reg_nil);
+
+  GenerateEpilogue(2);
+}
+
+
+void OSRStub::Generate() {
+  GeneratePrologue();
+
+  RuntimeOSRCallback osr = &RuntimeOSR;
+  Operand profile(rbp, 16);
+  Operand loop(rbp, 24);
+
+  // Baseline code keeps values on stack, but root and context are needed
+  __ Pushad();
+
+  {
+    Masm::Align a(masm());
+
+    // RuntimeOSR(heap, profile, loop, root)
+    __ mov(rcx, root_reg);
+    __ mov(rdx, loop);
+    __ mov(rsi, profile);
+    __ mov(rdi, Immediate(reinterpret_cast<intptr_t>(masm()->heap())));
+    __ mov(rax, Immediate(*reinterpret_cast<intptr_t*>(&osr)));
+    __ Call(rax);
+  }
+
+  // Optimized code's address or NULL
+  __ Popad(rax);
+
+  GenerateEpilogue(2);
+}
+
+
 void TypeofStub::Generate() {
   GeneratePrologue();
 
@@ -501,6 +609,11 @@ void LookupPropertyStub::Generate() {
     // invalidate IC if key wasn't the same
     __ IsNil(scratch, &same_key, NULL);
 
+    // Only interned strings may be used as keys, let runtime intern it
+    Operand interned(rbx, HString::kInternedOffset);
+    __ testb(interned, Immediate(HString::kInternedBit));
+    __ jmp(kEq, &cleanup);
+
     __ mov(qproto, Immediate(Heap::kICDisabledValue));
     __ bind(&same_key);
 
@@ -29,7 +29,7 @@
 namespace candor {
 namespace internal {
 
-Zone* Zone::current_ = NULL;
+__thread Zone* Zone::current_ = NULL;
 
 void* Zone::Allocate(size_t size) {
   // If current block has enough size - allocate chunk in it
@@ -71,9 +71,7 @@ class Zone {
   };
 
   Zone() {
-    // TODO(indutny): this should use thread id
-    parent_ = current_;
-    current_ = this;
+    Enter();
 
     page_size_ = GetPageSize();
 
@@ -81,12 +79,24 @@ class Zone {
   }
 
   ~Zone() {
+    Leave();
+  }
+
+  // Zones are current per-thread, a zone that was filled on the compiler
+  // thread may be left there and entered again on the isolate's thread
+  // (see CompileTask)
+  inline void Enter() {
+    parent_ = current_;
+    current_ = this;
+  }
+
+  inline void Leave() {
     current_ = parent_;
   }
 
   void* Allocate(size_t size);
 
-  static Zone* current_;
+  static __thread Zone* current_;
   static inline Zone* current() { return current_; }
 
   Zone* parent_;
@@ -99,6 +109,9 @@ class Zone {
 class ZonePolicy {
  public:
   static void* Allocate(size_t size);
+
+  // Zone is freed at once
+  static inline void Free(void* ptr) {}
 };
 
 // Base class for objects that will be bound to some zone
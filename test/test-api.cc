@@ -1,4 +1,5 @@
 #include "test.h"
+#include <dirent.h>
 
 static Value* Callback(uint32_t argc, Value* argv[]) {
   ASSERT(argc == 3);
@@ -352,6 +353,166 @@ TEST_START(api)
     ASSERT(wrapper_destroyed == 1);
   }
 
+  // StringBuilder
+  {
+    Isolate i;
+    const char* code = "return (s) {\n__$gc()\nreturn s + '!'\n}";
+
+    Function* f = Function::New("api", code, strlen(code));
+    Handle<Function> fn(f->Call(0, NULL)->As<Function>());
+
+    StringBuilder builder(2);
+    for (int j = 0; j < 100; j++) {
+      builder.Append("ab");
+      if (j % 10 == 0) {
+        Value* argv[1] = { String::New("x", 1) };
+        fn->Call(1, argv);
+      }
+    }
+    builder.Append(Number::NewIntegral(3));
+    ASSERT(builder.Length() == 201);
+
+    Value* argv[1] = { builder.ToString() };
+    String* str = fn->Call(1, argv)->As<String>();
+    ASSERT(str->Length() == 202);
+    ASSERT(strncmp(str->Value(), "abab", 4) == 0);
+    ASSERT(strncmp(str->Value() + 198, "ab3!", 4) == 0);
+
+    ASSERT(builder.Length() == 0);
+    ASSERT(builder.ToString()->Length() == 0);
+  }
+
+  // Sliced strings
+  {
+    Isolate i;
+    const char* code = "return (o, s) {\n__$gc()\n__$gc()\nreturn o[s]\n}";
+
+    Function* f = Function::New("api", code, strlen(code));
+    Handle<Function> fn(f->Call(0, NULL)->As<Function>());
+
+    char buf[1024];
+    for (int j = 0; j < 1024; j++) buf[j] = 'a' + j % 26;
+
+    Handle<String> big(String::New(buf, sizeof(buf)));
+    Handle<String> half(big->Slice(100, 612));
+    Handle<String> small(big->Slice(26, 56));
+    Handle<String> nested(half->Slice(4, 104));
+    big.Unwrap();
+
+    Handle<Object> obj(Object::New());
+    obj->Set(String::New(buf + 26, 30), Number::NewIntegral(1));
+
+    Value* argv[2] = { *obj, *small };
+    ASSERT(fn->Call(2, argv)->As<Number>()->Value() == 1);
+
+    ASSERT(half->Length() == 512);
+    ASSERT(strncmp(half->Value(), buf + 100, 512) == 0);
+    ASSERT(small->Length() == 30);
+    ASSERT(strncmp(small->Value(), buf + 26, 30) == 0);
+    ASSERT(nested->Length() == 100);
+    ASSERT(strncmp(nested->Value(), buf + 104, 100) == 0);
+    ASSERT(half->Slice(600, 700)->Length() == 0);
+    ASSERT(half->IndexOf(*nested) == 4);
+    ASSERT(half->IndexOf(String::New("!", 1)) == -1);
+  }
+
+  // Background compilation
+  {
+    Isolate i;
+    CompileJob* jobs[8];
+    char code[64];
+    for (int j = 0; j < 8; j++) {
+      snprintf(code, sizeof(code), "f(x) { return x * %d }\nreturn f(3)", j);
+      jobs[j] = Function::NewAsync("api", code);
+    }
+    CompileJob* bad = Function::NewAsync("api", "return (");
+
+    // Finish in the reverse order
+    for (int j = 7; j >= 0; j--) {
+      Function* f = jobs[j]->Finish();
+      ASSERT(!i.HasError());
+      ASSERT(f->Call(0, NULL)->As<Number>()->Value() == 3 * j);
+    }
+
+    ASSERT(bad->Finish() == NULL);
+    ASSERT(i.HasError());
+  }
+
+  // Compile stats
+  {
+    Isolate i;
+    Isolate::ResetCompileStats();
+    Isolate::EnableCompileStats();
+
+    const char* code = "f(x) { if (x > 1) { return x - 1 }\nreturn x + 1 }\n"
+                       "return f(2) + f(0)";
+    Function* f = Function::New("api", code, strlen(code));
+    ASSERT(f->Call(0, NULL)->As<Number>()->Value() == 2);
+
+    Isolate::DisableCompileStats();
+
+    Object* stats = i.GetCompileStats();
+    ASSERT(stats->Get("parse")->As<Number>()->Value() >= 0);
+    ASSERT(stats->Get("register_allocation")->Is<Number>());
+    ASSERT(stats->Get("baseline_functions")->As<Number>()->Value() >= 1);
+    ASSERT(stats->Get("optimized_functions")->As<Number>()->Value() >= 1);
+    ASSERT(stats->Get("hir_blocks")->As<Number>()->Value() > 1);
+    ASSERT(stats->Get("lir_instructions")->As<Number>()->Value() > 0);
+    ASSERT(stats->Get("code_bytes")->As<Number>()->Value() > 0);
+
+    // Nothing is counted while disabled
+    int64_t bytes = stats->Get("code_bytes")->As<Number>()->IntegralValue();
+    Function::New("api", "return 1", 8)->Call(0, NULL);
+    stats = i.GetCompileStats();
+    ASSERT(stats->Get("code_bytes")->As<Number>()->IntegralValue() == bytes);
+  }
+
+  // Code cache
+  {
+    char dir[] = "/tmp/candor-cache-XXXXXX";
+    ASSERT(mkdtemp(dir) != NULL);
+
+    const char* code = "o = { a: 1.5, b: 'str' }\n"
+                       "inc(x) { return x + o.a }\n"
+                       "i = 0\n"
+                       "sum = 0\n"
+                       "while (i < 10000) {\n"
+                       "  sum = inc(sum)\n"
+                       "  i++\n"
+                       "}\n"
+                       "return sum + sizeof o.b";
+
+    Isolate::EnableCodeCache(dir);
+    Isolate::ResetCompileStats();
+    Isolate::EnableCompileStats();
+    for (int run = 0; run < 2; run++) {
+      Isolate i;
+      Function* f = Function::New("api", code, strlen(code));
+      ASSERT(f->Call(0, NULL)->As<Number>()->Value() == 15003);
+
+      // Second isolate loads code saved by the first one
+      Object* stats = i.GetCompileStats();
+      ASSERT(stats->Get("code_cache_hits")->As<Number>()->Value() == run);
+    }
+    Isolate::DisableCompileStats();
+    Isolate::DisableCodeCache();
+
+    DIR* d = opendir(dir);
+    ASSERT(d != NULL);
+    int files = 0;
+    for (struct dirent* ent = readdir(d); ent != NULL; ent = readdir(d)) {
+      if (ent->d_name[0] == '.') continue;
+
+      char path[sizeof(dir) + sizeof(ent->d_name)];
+      snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+      ASSERT(unlink(path) == 0);
+      files++;
+    }
+    closedir(d);
+    rmdir(dir);
+    ASSERT(files == 1);
+  }
+
   // Regressions
   {
     Isolate i;
@@ -0,0 +1,116 @@
+#include <test.h>
+#include <compile-stats.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+// Synthetic straight-line function with branches, loops, property accesses
+// and calls, `size` characters long
+static char* GenerateFunction(int size) {
+  static const int kVars = 16;
+
+  char* source = new char[size + 1024];
+  int len = 0;
+  uint32_t seed = size;
+
+  len += sprintf(source + len,
+                 "g = (x) { return x + 1 }\nf = (n) {\n  o = {}\n");
+  for (int i = 0; i < kVars; i++) {
+    len += sprintf(source + len, "  v%d = %d\n", i, i);
+  }
+
+  for (int loop = 0; len < size; ) {
+    seed = seed * 1103515245 + 12345;
+    int x = (seed >> 8) % kVars;
+    int y = (seed >> 12) % kVars;
+    int z = (seed >> 16) % kVars;
+    int k = (seed >> 20) % 97 + 1;
+
+    switch ((seed >> 24) % 6) {
+     case 0:
+      len += sprintf(source + len, "  v%d = v%d + v%d * %d\n", x, y, z, k % 8);
+      break;
+     case 1:
+      len += sprintf(source + len,
+                     "  if (v%d > %d) { v%d = v%d - 1 } "
+                     "else { v%d = v%d + 1 }\n",
+                     x, k, y, y, z, z);
+      break;
+     case 2:
+      len += sprintf(source + len, "  o.p%d = v%d\n", x, y);
+      break;
+     case 3:
+      len += sprintf(source + len, "  v%d = o.p%d\n", x, y);
+      break;
+     case 4:
+      len += sprintf(source + len,
+                     "  c%d = 0\n"
+                     "  while (c%d < 3) { v%d = v%d + c%d\n c%d++ }\n",
+                     loop, loop, x, x, loop, loop);
+      loop++;
+      break;
+     default:
+      len += sprintf(source + len, "  v%d = g(v%d)\n", x, y);
+      break;
+    }
+  }
+  len += sprintf(source + len, "  return v0\n}\nreturn f(1)\n");
+
+  return source;
+}
+
+
+static double RunFunction(const char* source, int threshold) {
+  CodeSpace::tier_up_threshold(threshold);
+
+  Isolate i;
+  Function* f = Function::New("compile", source, strlen(source));
+  if (i.HasError()) {
+    i.PrintError();
+    abort();
+  }
+
+  Value* result = f->Call(0, NULL);
+  ASSERT(result->Is<Number>());
+
+  return result->As<Number>()->Value();
+}
+
+
+static void BenchCompile(const char* name, int size) {
+  char* source = GenerateFunction(size);
+  double baseline;
+  double optimized;
+
+  fprintf(stdout, "%s:\n", name);
+  {
+    BENCH_START(baseline, 0)
+    baseline = RunFunction(source, 0x7fffffff);
+    BENCH_END(baseline, 0)
+  }
+  {
+    // Functions above HIRGen::kMaxOptimizableSize stay in baseline code
+    CompileStats::Reset();
+    CompileStats::Enable();
+    BENCH_START(optimized, 0)
+    optimized = RunFunction(source, 0);
+    BENCH_END(optimized, 0)
+    CompileStats::Disable();
+  }
+  ASSERT(baseline == optimized);
+
+  // Liveness sets take memory quadratic in function's size
+  int64_t liveness = CompileStats::CounterValue(CompileStats::kLivenessBytes);
+  fprintf(stdout, "liveness : %.1fMB\n", liveness / (1024.0 * 1024.0));
+
+  delete[] source;
+}
+
+
+TEST_START(compile)
+  BenchCompile("10k", 10000);
+  BenchCompile("100k", 100000);
+  BenchCompile("1m", 1000000);
+
+  CodeSpace::tier_up_threshold(0);
+TEST_END(compile)
@@ -71,6 +71,64 @@ TEST_START(functional)
     ASSERT(result->Is<Object>());
   })
 
+  // Loop-carried values rotated through phis
+  FUN_TEST("a = 1\nb = 2\nc = 3\nd = 4\ne = 5\nf = 6\ng = 7\nh = 8\n"
+           "s = 0\ni = 0\n"
+           "while (i < 10) {\n"
+           "  j = 0\n"
+           "  while (j < 5) {\n"
+           "    s = s + a * j + b - c + d\n"
+           "    j++\n"
+           "  }\n"
+           "  t = a\na = b\nb = c\nc = d\nd = e\ne = f\nf = g\ng = h\nh = t\n"
+           "  i++\n"
+           "}\n"
+           "return s * 100 + a * 10 + h", {
+    ASSERT(result->As<Number>()->Value() == 60532);
+  })
+
+  // Loop counters with known ranges
+  FUN_TEST("a = 0\ni = 0\n"
+           "while (i < 10) {\n  a = a + i * 3\n  i++\n}\n"
+           "i = 10\n"
+           "while (i >= 0) {\n  a = a + i\n  i = i - 2\n}\n"
+           "i = 5\n"
+           "while (--i) {\n  a = a + i\n}\n"
+           "i = 5\n"
+           "while (i--) {\n  a = a + i\n}\n"
+           "i = 0\n"
+           "while (++i <= 7) {\n  a = a + i - 1\n}\n"
+           "i = 0\n"
+           "while (i < 100000) {\n  a = a + i * 100000\n  i = i + 25000\n}\n"
+           "b = 3\n"
+           "h() {\n"
+           "  s = 0\n"
+           "  i = 0\n"
+           "  while (i < 4) {\n    s = s + b\n    i++\n  }\n"
+           "  k() {\n  }\n"
+           "  return s\n"
+           "}\n"
+           "return a + h()", {
+    ASSERT(result->As<Number>()->Value() == 15000000218.0);
+  })
+
+  // Objects that don't escape
+  FUN_TEST("a = 0\ni = 0\n"
+           "while (i < 4) {\n"
+           "  p = { x: i, \"y\": 2, x: i + 1 }\n"
+           "  q = [p.x, p[\"y\"]]\n"
+           "  q[0] = q[0] * 10\n"
+           "  a = a + q[0] + q[1]\n"
+           "  i++\n"
+           "}\n"
+           "return a", {
+    ASSERT(result->As<Number>()->Value() == 108);
+  })
+
+  FUN_TEST("p = { x: 1 }\nq = [p, 2]\nr = p.y\nreturn q[0]", {
+    ASSERT(result->Is<Object>());
+  })
+
   // Functions
   FUN_TEST("a() {}\nreturn a", {
     ASSERT(result->Is<Function>());
@@ -84,6 +142,29 @@ TEST_START(functional)
     ASSERT(result->As<Number>()->Value() == 1);
   })
 
+  // Tail calls reuse the frame
+  FUN_TEST("count(n, acc) {\n"
+           "  if (n == 0) return acc\n"
+           "  return count(n - 1, acc + 1)\n"
+           "}\n"
+           "return count(1000000, 0)", {
+    ASSERT(result->As<Number>()->Value() == 1000000);
+  })
+
+  // Constant folding
+  FUN_TEST("a = 3 * 4 + 2\nb = nil\n"
+           "if (a > 20) b = 7\n"
+           "if (typeof a != \"number\") return 1\n"
+           "i = 0\n"
+           "while (i < 3) {\n"
+           "  if (!(a == 14)) i = 100\n"
+           "  i++\n"
+           "}\n"
+           "if (b != nil) return 2\n"
+           "return a + i", {
+    ASSERT(result->As<Number>()->Value() == 17);
+  })
+
   // Regression
   FUN_TEST("a() { return 1 }\nreturn a({})", {
     ASSERT(result->As<Number>()->Value() == 1);
@@ -145,6 +226,24 @@ TEST_START(functional)
     ASSERT(result->As<Number>()->Value() == 4);
   });
 
+  // Inlining
+  FUN_TEST("b = 2\n"
+           "a(x, y) {\n"
+           "  if (x > 3) return x * b\n"
+           "  z = y\n"
+           "  while (x < 3) { x++ }\n"
+           "  return x + z\n"
+           "}\n"
+           "c(x) {\n"
+           "  if (x) { t = 1 }\n"
+           "  return t\n"
+           "}\n"
+           "d(x, y) { return typeof y }\n"
+           "return a(5, 1) + a(1, 4) + c(1) + sizeof typeof c(nil) +\n"
+           "       sizeof d(1)", {
+    ASSERT(result->As<Number>()->Value() == 24);
+  })
+
   // Prefix
   FUN_TEST("return typeof nil", {
     String* str = result->As<String>();
@@ -280,4 +379,74 @@ TEST_START(functional)
   FUN_TEST("global.a = 1\nreturn global.a", {
     ASSERT(result->As<Number>()->Value() == 1);
   })
+
+  // Tiered compilation: hot functions are switched from baseline to
+  // optimized code while running
+  CodeSpace::tier_up_threshold(10);
+
+  FUN_TEST("fib = (n) {\n"
+           "  if (n < 2) return n\n"
+           "  return fib(n - 1) + fib(n - 2)\n"
+           "}\n"
+           "return fib(20)", {
+    ASSERT(result->As<Number>()->Value() == 6765);
+  })
+
+  FUN_TEST("counter = (i) {\n"
+           "  step = () { return 'a' }\n"
+           "  while (i--) { acc = acc + step()\n }\n"
+           "  return sizeof acc\n"
+           "}\n"
+           "acc = ''\n"
+           "i = 0\n"
+           "while (i < 30) { counter(i)\n i++ }\n"
+           "return sizeof acc", {
+    ASSERT(result->As<Number>()->Value() == 435);
+  })
+
+  // Lazy compilation: literals of inner functions should be in root context
+  FUN_TEST("a = 1\n"
+           "unused = () { return 'never called' }\n"
+           "f = () { return 'lazy' + a }\n"
+           "g = () {\n"
+           "  h = () { return { key: 'value' }.key }\n"
+           "  return h()\n"
+           "}\n"
+           "return f() + g()", {
+    String* str = result->As<String>();
+    ASSERT(str->Length() == 10);
+    ASSERT(strncmp(str->Value(), "lazy1value", str->Length()) == 0);
+  })
+
+  // Speculation on operand kinds seen by baseline code, optimized function
+  // goes back to baseline code once it sees other kinds
+  FUN_TEST("sum = (a, b) { return a + b }\n"
+           "i = 0\n"
+           "r = 0\n"
+           "while (i < 30) { r = sum(r, 1)\n i++ }\n"
+           "r = sum(r, 0.5)\n"
+           "s = sum('a', 'b')\n"
+           "i = 0\n"
+           "while (i < 30) { r = sum(r, 0.5)\n i++ }\n"
+           "return r + sizeof s", {
+    ASSERT(result->As<Number>()->Value() == 47.5);
+  })
+
+  // On-stack replacement: hot loops continue in optimized code
+  FUN_TEST("f = (x) { return x * 2 }\n"
+           "g = (n) {\n"
+           "  i = 0\n"
+           "  r = 0\n"
+           "  while (i < n) { r = r + i\n i++ }\n"
+           "  return r\n"
+           "}\n"
+           "s = 'a'\n"
+           "i = 0\n"
+           "acc = 0\n"
+           "while (i < 100) { acc = acc + f(i)\n i++ }\n"
+           "return acc + g(100) + sizeof s", {
+    ASSERT(result->As<Number>()->Value() == 14851);
+  })
+
+  CodeSpace::tier_up_threshold(0);
 TEST_END(functional)
@@ -1,5 +1,15 @@
 #include "test.h"
 
+// Runs the old space GC on the next __$gc() call
+class OldSpaceIsolate : public Isolate {
+ public:
+  void NeedsOldSpaceGC() { heap->needs_gc(Heap::kGCOldSpace); }
+};
+
+static int64_t CodeSpaceStat(Isolate* isolate, const char* name) {
+  return isolate->GetCodeSpaceStats()->Get(name)->As<Number>()->IntegralValue();
+}
+
 TEST_START(gc)
   FUN_TEST("x=1.0\n"
            "__$gc()\n__$gc()\n__$gc()\n"
@@ -36,6 +46,19 @@ TEST_START(gc)
     ASSERT(result->As<Number>()->Value() == 1);
   })
 
+  // Interned keys
+  FUN_TEST("a = {}\ni = 0\n"
+           "while (i < 1000) {\n"
+           "  a[\"k\" + i] = i\n"
+           "  i++\n"
+           "}\n"
+           "__$gc()\n"
+           "b = { k999: 1 }\n"
+           "__$gc()\n"
+           "return a[\"k\" + 999] + a.k500 + b[\"k9\" + \"99\"]", {
+    ASSERT(result->As<Number>()->Value() == 1500);
+  })
+
   // Stress test
   FUN_TEST("a = 0\ny = 30\nz=1.0\n"
            "while(--y) {\n"
@@ -48,4 +71,58 @@ TEST_START(gc)
            "return a.x.y", {
     ASSERT(result->Is<Object>());
   })
+
+  // Code of unreachable functions is freed and its memory is reused
+  {
+    OldSpaceIsolate i;
+    const char* gc = "__$gc()\nreturn 1";
+    Function::New("gc", gc, strlen(gc))->Call(0, NULL);
+
+    int64_t chunks = CodeSpaceStat(&i, "chunks");
+    int64_t used = CodeSpaceStat(&i, "used");
+
+    Handle<Function> live;
+    for (int n = 0; n < 200; n++) {
+      char code[256];
+      snprintf(code,
+               sizeof(code),
+               "a = { x: %d }\n"
+               "f(b) { return b.x + 1 }\n"
+               "i = 0\n"
+               "while (i < 100) { f(a)\ni++ }\n"
+               "return f",
+               n);
+      Function* f = Function::New("gc", code, strlen(code));
+      Value* result = f->Call(0, NULL);
+      if (n == 0) live.Wrap(result->As<Function>());
+    }
+    ASSERT(CodeSpaceStat(&i, "chunks") >= chunks + 200);
+
+    i.NeedsOldSpaceGC();
+    Function::New("gc", gc, strlen(gc))->Call(0, NULL);
+    ASSERT(CodeSpaceStat(&i, "chunks") < chunks + 50);
+    ASSERT(CodeSpaceStat(&i, "used") < used + 16 * 1024);
+
+    // Function referenced by the handle is still callable
+    Object* obj = Object::New();
+    obj->Set("x", Number::NewIntegral(41));
+    Value* argv[] = { obj };
+    ASSERT(live->Call(1, argv)->As<Number>()->Value() == 42);
+  }
+
+  // Old space GC keeps code of weakly referenced new space functions
+  {
+    OldSpaceIsolate i;
+    const char* code = "return (a) { return a + 1 }";
+    Function* f = Function::New("gc", code, strlen(code));
+    Handle<Function> weak(f->Call(0, NULL));
+    weak.Unref();
+
+    i.NeedsOldSpaceGC();
+    const char* gc = "__$gc()\nreturn 1";
+    Function::New("gc", gc, strlen(gc))->Call(0, NULL);
+
+    Value* argv[] = { Number::NewIntegral(41) };
+    ASSERT(weak->Call(1, argv)->As<Number>()->Value() == 42);
+  }
 TEST_END(gc)
@@ -13,7 +13,9 @@
     V(hir) \
     V(lir) \
     V(splaytree) \
-    V(list)
+    V(list) \
+    V(strings) \
+    V(compile)
 
 #define TEST_DECLARE(name)\
     int __test_runner_##name();
@@ -94,6 +94,31 @@ TEST_START(numbers)
     ASSERT(result->As<Number>()->Value() == 5.5);
   })
 
+  // Unboxed doubles
+  FUN_TEST("a = 1.5\nb = 2\nreturn a * 2.0 + b * 0.5 - 1.0 / 4.0", {
+    ASSERT(result->As<Number>()->Value() == 3.75);
+  })
+
+  FUN_TEST("a = \"3\"\nb = 1.5\nreturn a * 0.5 + b * 0.5", {
+    ASSERT(result->As<Number>()->Value() == 2.25);
+  })
+
+  FUN_TEST("f = (x, y) {\n"
+           "  return x * 0.5 + y * 0.25\n"
+           "}\n"
+           "return f(2, 4) + f(\"4\", 8) + f({}, nil)", {
+    ASSERT(result->As<Number>()->Value() == 6);
+  })
+
+  FUN_TEST("s = 0.0\ni = 0\n"
+           "while (i < 1000) {\n"
+           "  s = s + (i * 0.5 + i * 0.25) * 2.0\n"
+           "  i++\n"
+           "}\n"
+           "return s", {
+    ASSERT(result->As<Number>()->Value() == 749250);
+  })
+
   // XXX: This big numbers should be converted to doubles by utils.h
 #if CANDOR_ARCH_x64
   // Conversion on overflow
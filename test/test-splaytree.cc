@@ -48,4 +48,33 @@ TEST_START(splaytree)
       ASSERT(tree.Find(NumberKey::New(i))->value() == (i - 1));
     }
   }
+
+  {
+    SplayTree<NumberKey, NumberKey, NopPolicy, EmptyClass> tree;
+
+    for (int i = 0; i < kKeyCount; i++) {
+      tree.Insert(NumberKey::New(i), NumberKey::New(i));
+    }
+
+    // Remove every third key in pseudo-random order
+    srandom(13589);
+    for (int i = 0; i < kKeyCount; i++) {
+      int key = (random() % (kKeyCount / 3)) * 3;
+      tree.Remove(NumberKey::New(key));
+    }
+    for (int i = 0; i < kKeyCount; i += 3) tree.Remove(NumberKey::New(i));
+    ASSERT(!tree.Remove(NumberKey::New(3)));
+
+    for (int i = 0; i < kKeyCount; i++) {
+      SplayTree<NumberKey, NumberKey, NopPolicy, EmptyClass>::Item* item;
+      item = tree.FindFloor(NumberKey::New(i));
+      if (i == 0) {
+        ASSERT(item == NULL);
+      } else if (i % 3 == 0) {
+        ASSERT(item->value->value() == i - 1);
+      } else {
+        ASSERT(item->value->value() == i);
+      }
+    }
+  }
 TEST_END(splaytree)
@@ -0,0 +1,188 @@
+#include <test.h>
+#include <string-ops.h>
+#include <utils.h>
+#include <string.h>
+#include <stdlib.h>
+
+static const int kMaxLength = 300;
+
+static void CheckStringOps() {
+  char lhs[kMaxLength], rhs[kMaxLength];
+  for (int i = 0; i < kMaxLength; i++) lhs[i] = rhs[i] = 'a' + i % 26;
+
+  for (int len = 0; len < kMaxLength; len++) {
+    ASSERT(StringOps::Compare(lhs, rhs, len) == 0);
+
+    // Difference at every position (including '\0' bytes)
+    for (int i = 0; i < len; i++) {
+      char c = rhs[i];
+      rhs[i] = 0;
+      ASSERT(StringOps::Compare(lhs, rhs, len) > 0);
+      ASSERT(StringOps::Compare(rhs, lhs, len) < 0);
+      rhs[i] = c;
+    }
+  }
+
+  // Needle at every position
+  char haystack[kMaxLength];
+  memset(haystack, 'x', sizeof(haystack));
+  for (int nlen = 1; nlen < 40; nlen += 3) {
+    char needle[40];
+    for (int i = 0; i < nlen; i++) needle[i] = 'a' + i;
+
+    ASSERT(StringOps::IndexOf(haystack, kMaxLength, needle, nlen) == -1);
+    for (int pos = 0; pos + nlen <= kMaxLength; pos++) {
+      memcpy(haystack + pos, needle, nlen);
+      ASSERT(StringOps::IndexOf(haystack, kMaxLength, needle, nlen) == pos);
+      ASSERT(StringOps::IndexOf(haystack, pos + nlen - 1, needle, nlen) == -1);
+      memset(haystack + pos, 'x', nlen);
+    }
+  }
+  ASSERT(StringOps::IndexOf(haystack, 10, "", 0) == 0);
+  ASSERT(StringOps::IndexOf("ab", 2, "abc", 3) == -1);
+}
+
+
+static void BenchStringOps(const char* kind) {
+  static const int kLongLength = 4096;
+  static const int kShortIterations = 200000;
+  static const int kLongIterations = 20000;
+
+  char* lhs = new char[kLongLength];
+  for (int i = 0; i < kLongLength; i++) lhs[i] = 'a' + i % 26;
+
+  int r = 0;
+
+  fprintf(stdout, "%s:\n", kind);
+  {
+    BENCH_START(index_of_64b, kShortIterations)
+    for (int i = 0; i < kShortIterations; i++) {
+      r += StringOps::IndexOf(lhs + (i & 7), 64, "zyx", 3);
+    }
+    BENCH_END(index_of_64b, kShortIterations)
+  }
+  {
+    lhs[kLongLength - 8] = '!';
+    BENCH_START(index_of_4kb, kLongIterations)
+    for (int i = 0; i < kLongIterations; i++) {
+      r += StringOps::IndexOf(lhs, kLongLength, lhs + kLongLength - 12, 8);
+    }
+    BENCH_END(index_of_4kb, kLongIterations)
+  }
+  ASSERT(r == kLongIterations * (kLongLength - 12) - kShortIterations);
+
+  delete[] lhs;
+}
+
+
+// Hand-written comparison, the kind of loop StringOps::Compare is
+// measured against
+static int LoopCompare(const char* lhs, const char* rhs, uint32_t length) {
+  for (uint32_t i = 0; i < length; i++) {
+    if (lhs[i] != rhs[i]) return lhs[i] < rhs[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+
+static void BenchCompareAndHash() {
+  static const int kShortLength = 16;
+  static const int kLongLength = 4096;
+  static const int kShortIterations = 2000000;
+  static const int kLongIterations = 50000;
+
+  // Two copies of the same bytes, so equality has to scan them all, and
+  // ordering is decided by the last byte
+  char* lhs = new char[kLongLength + 8];
+  char* rhs = new char[kLongLength + 8];
+  for (int i = 0; i < kLongLength + 8; i++) lhs[i] = rhs[i] = 'a' + i % 26;
+  rhs[kLongLength - 1] = 'z' + 1;
+
+  int r = 0;
+  uint32_t h = 0;
+
+  fprintf(stdout, "compare and hash:\n");
+
+  // Short keys (property names)
+  {
+    BENCH_START(equal_16b, kShortIterations)
+    for (int i = 0; i < kShortIterations; i++) {
+      r += StringOps::Compare(lhs + (i & 7), rhs + (i & 7), kShortLength);
+    }
+    BENCH_END(equal_16b, kShortIterations)
+  }
+  {
+    BENCH_START(equal_16b_strncmp, kShortIterations)
+    for (int i = 0; i < kShortIterations; i++) {
+      r += strncmp(lhs + (i & 7), rhs + (i & 7), kShortLength);
+    }
+    BENCH_END(equal_16b_strncmp, kShortIterations)
+  }
+  {
+    BENCH_START(equal_16b_loop, kShortIterations)
+    for (int i = 0; i < kShortIterations; i++) {
+      r += LoopCompare(lhs + (i & 7), rhs + (i & 7), kShortLength);
+    }
+    BENCH_END(equal_16b_loop, kShortIterations)
+  }
+  {
+    BENCH_START(hash_16b, kShortIterations)
+    for (int i = 0; i < kShortIterations; i++) {
+      h += ComputeHash(lhs + (i & 7), kShortLength);
+    }
+    BENCH_END(hash_16b, kShortIterations)
+  }
+  ASSERT(r == 0);
+
+  // Long strings, differing only in the last byte
+  {
+    BENCH_START(order_4kb, kLongIterations)
+    for (int i = 0; i < kLongIterations; i++) {
+      r += StringOps::Compare(lhs + (i & 7), rhs + (i & 7), kLongLength) < 0;
+    }
+    BENCH_END(order_4kb, kLongIterations)
+  }
+  {
+    BENCH_START(order_4kb_strncmp, kLongIterations)
+    for (int i = 0; i < kLongIterations; i++) {
+      r += strncmp(lhs + (i & 7), rhs + (i & 7), kLongLength) < 0;
+    }
+    BENCH_END(order_4kb_strncmp, kLongIterations)
+  }
+  {
+    BENCH_START(order_4kb_loop, kLongIterations)
+    for (int i = 0; i < kLongIterations; i++) {
+      r += LoopCompare(lhs + (i & 7), rhs + (i & 7), kLongLength) < 0;
+    }
+    BENCH_END(order_4kb_loop, kLongIterations)
+  }
+  {
+    BENCH_START(hash_4kb, kLongIterations)
+    for (int i = 0; i < kLongIterations; i++) {
+      h += ComputeHash(lhs + (i & 7), kLongLength);
+    }
+    BENCH_END(hash_4kb, kLongIterations)
+  }
+  ASSERT(r == 3 * kLongIterations);
+
+  // Use hashes, so they aren't optimized out
+  ASSERT(h != 0);
+
+  delete[] lhs;
+  delete[] rhs;
+}
+
+
+TEST_START(strings)
+  // Scalar implementation
+  StringOps::InitScalar();
+  CheckStringOps();
+  BenchStringOps("scalar");
+
+  // Vectorized implementation
+  StringOps::Init();
+  CheckStringOps();
+  BenchStringOps("vector");
+
+  BenchCompareAndHash();
+TEST_END(strings)
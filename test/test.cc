@@ -11,6 +11,10 @@
     } else \
 
 int main(int argc, char** argv) {
+  // Optimize functions right away, so that the tests will cover HIR/LIR
+  // (functional scripts are covering baseline code and tiering)
+  CodeSpace::tier_up_threshold(0);
+
   if (argc == 1) {
     TESTS_ENUM(TEST_RUN)
     return 0;
@@ -41,6 +41,8 @@
       'test-lir.cc',
       'test-splaytree.cc',
       'test-list.cc',
+      'test-strings.cc',
+      'test-compile.cc',
     ]
   }]
 }
@@ -4,6 +4,7 @@
 #include <candor.h>
 #include <heap.h>
 #include <heap-inl.h>
+#include <code-space.h>
 #include <zone.h>
 
 #include <stdio.h>